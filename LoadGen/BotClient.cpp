@@ -0,0 +1,1170 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#include "BotClient.h"
+#include "BotSockets.h"
+#include "BotWorker.h"
+#include "LoadStats.h"
+#include "ReplayLog.h"
+#include "EncryptedPacket.h"
+#include "SequencedPacket.h"
+#include "MessageTypes.h"
+#include "Config.h"
+#include "Log.h"
+#include "Timer.h"
+#include "Util.h"
+#include <Sockets/Utility.h>
+
+// what the 7.5668 client reports, the servers only warn about anything else
+static const uint32 MATRIX_VERSION = (7 << 16) | 8665;
+
+enum
+{
+	AS_GetPublicKeyRequest = 0x06,
+	AS_GetPublicKeyReply = 0x07,
+	AS_AuthRequest = 0x08,
+	AS_AuthChallenge = 0x09,
+	AS_AuthChallengeResponse = 0x0A,
+	AS_AuthReply = 0x0B,
+
+	CERT_ConnectRequest = 0x01,
+	CERT_Challenge = 0x02,
+	CERT_ChallengeResponse = 0x03,
+	CERT_ConnectReply = 0x04,
+	MS_ConnectRequest = 0x06,
+	MS_ConnectChallenge = 0x07,
+	MS_ConnectChallengeResponse = 0x08,
+	MS_ConnectReply = 0x09,
+	MS_LoadCharacterRequest = 0x0F,
+	MS_LoadCharacterReply = 0x10
+};
+
+static bool ResolveHost( const string &host, ipaddr_t &address )
+{
+	if (Utility::u2ip(host,address) == false)
+	{
+		CRITICAL_LOG(format("Could not resolve %1%") % host);
+		return false;
+	}
+	return true;
+}
+
+bool BotSettings::Load()
+{
+	string authHost = sConfig.GetStringDefault("LoadGen.AuthHost","127.0.0.1");
+	string marginHost = sConfig.GetStringDefault("LoadGen.MarginHost",authHost.c_str());
+	string worldHost = sConfig.GetStringDefault("LoadGen.WorldHost",marginHost.c_str());
+	if (!ResolveHost(authHost,authAddress) || !ResolveHost(marginHost,marginAddress) || !ResolveHost(worldHost,worldAddress))
+		return false;
+
+	authPort = port_t(sConfig.GetIntDefault("LoadGen.AuthPort",11000));
+	marginPort = port_t(sConfig.GetIntDefault("LoadGen.MarginPort",10000));
+	worldPort = port_t(sConfig.GetIntDefault("LoadGen.WorldPort",10000));
+
+	accountPrefix = sConfig.GetStringDefault("LoadGen.AccountPrefix","bot");
+	password = sConfig.GetStringDefault("LoadGen.Password","loadtest");
+
+	stepTimeoutMS = sConfig.GetIntDefault("LoadGen.StepTimeout",30) * 1000;
+	sessionMS = sConfig.GetIntDefault("LoadGen.SessionSeconds",120) * 1000;
+	moveIntervalMS = sConfig.GetIntDefault("LoadGen.MoveIntervalMS",250);
+	moveSpeed = sConfig.GetFloatDefault("LoadGen.MoveSpeed",300.0f);
+	chatIntervalMS = sConfig.GetIntDefault("LoadGen.ChatIntervalSeconds",15) * 1000;
+	pingIntervalMS = sConfig.GetIntDefault("LoadGen.PingIntervalMS",1000);
+	repeat = sConfig.GetBoolDefault("LoadGen.Repeat",false);
+	repeatDelayMS = sConfig.GetIntDefault("LoadGen.RepeatDelaySeconds",5) * 1000;
+
+	//one waypoint per line, "x y z" relative to the spawn point
+	path.clear();
+	string pathFile = sConfig.GetStringDefault("LoadGen.PathFile","");
+	if (pathFile.length() > 0)
+	{
+		ifstream pathStream(pathFile.c_str());
+		if (!pathStream.is_open())
+		{
+			CRITICAL_LOG(format("Could not open path file %1%") % pathFile);
+			return false;
+		}
+
+		string line;
+		while (getline(pathStream,line))
+		{
+			if (line.length() < 1 || line[0] == '#')
+				continue;
+
+			stringstream lineParser(line);
+			Waypoint point;
+			lineParser >> point.x >> point.y >> point.z;
+			if (!lineParser.fail())
+				path.push_back(point);
+		}
+	}
+	if (path.empty())
+	{
+		//walk a square around the spawn point
+		const float side = 500.0f;
+		const Waypoint square[4] = { {side,0,0}, {side,0,side}, {0,0,side}, {0,0,0} };
+		path.assign(square,square+4);
+	}
+
+	replay.reset();
+	string replayFile = sConfig.GetStringDefault("LoadGen.ReplayFile","");
+	if (replayFile.length() > 0)
+	{
+		replay.reset(new ReplayLog);
+		if (!replay->Load(replayFile))
+			return false;
+	}
+	replaySpeed = sConfig.GetFloatDefault("LoadGen.ReplaySpeed",1.0f);
+	if (replaySpeed <= 0)
+		replaySpeed = 1.0f;
+
+	return true;
+}
+
+BotClient::BotClient( BotWorker &worker, uint32 botIndex, uint32 startMS ) :
+	m_worker(worker), m_settings(worker.GetSettings()), m_botIndex(botIndex), m_startMS(startMS)
+{
+	m_username = m_settings.AccountName(botIndex);
+	m_tcp = NULL;
+	m_udp = NULL;
+	Reset();
+}
+
+BotClient::~BotClient()
+{
+	CloseSockets();
+}
+
+void BotClient::Reset()
+{
+	CloseSockets();
+
+	m_state = STATE_WAITING;
+	m_stateSinceMS = getMSTime();
+	m_loginStartMS = m_stepStartMS = 0;
+
+	m_authEngine.Invalidate();
+	m_tfEngine.Invalidate();
+	m_authTime = 0;
+	m_serverModulus.clear();
+	m_ticket.clear();
+	memset(&m_signedData,0,sizeof(m_signedData));
+	m_privateExponent.clear();
+	m_charId = 0;
+	m_handle.clear();
+	m_sessionId = 0;
+
+	m_pendingCommands.clear();
+	m_commandsSent = 0;
+	m_pendingState.clear();
+	m_pendingTrailingState.clear();
+	m_clientSeq = 1;
+	m_serverSeq = 0;
+	m_serverSeqValid = false;
+	m_serverSeqBits = 0;
+	m_ackPending = false;
+	m_lastUdpSendMS = m_lastPingMS = 0;
+
+	m_viewId = 0;
+	memset(m_spawnPos,0,sizeof(m_spawnPos));
+	memset(m_pos,0,sizeof(m_pos));
+	m_nextWaypoint = 0;
+	m_lastMoveMS = m_lastChatMS = 0;
+	m_chatCount = 0;
+	m_spawnRequestMS = m_inWorldSinceMS = 0;
+	m_jackoutConfirmedMS = 0;
+	m_replayNext = 0;
+}
+
+void BotClient::CloseSockets()
+{
+	if (m_tcp != NULL)
+	{
+		m_tcp->ReleaseOwner();
+		m_tcp->SetCloseAndDelete(true);
+		m_tcp = NULL;
+	}
+	if (m_udp != NULL)
+	{
+		m_udp->ReleaseOwner();
+		m_udp->SetCloseAndDelete(true);
+		m_udp = NULL;
+	}
+}
+
+const char * BotClient::StateName( BotState state )
+{
+	switch (state)
+	{
+	case STATE_WAITING: return "waiting";
+	case STATE_AUTH_CONNECT: return "auth connect";
+	case STATE_AUTH_PUBLIC_KEY: return "AS_GetPublicKeyReply";
+	case STATE_AUTH_CHALLENGE: return "AS_AuthChallenge";
+	case STATE_AUTH_REPLY: return "AS_AuthReply";
+	case STATE_MARGIN_CONNECT: return "margin connect";
+	case STATE_MARGIN_CERT_CHALLENGE: return "CERT_Challenge";
+	case STATE_MARGIN_CERT_REPLY: return "CERT_ConnectReply";
+	case STATE_MARGIN_CHALLENGE: return "MS_ConnectChallenge";
+	case STATE_MARGIN_SESSION: return "MS_ConnectReply";
+	case STATE_MARGIN_CHARACTER: return "MS_LoadCharacterReply";
+	case STATE_WORLD_CONNECT: return "world heartbeats";
+	case STATE_WORLD_SPAWN: return "spawn";
+	case STATE_IN_WORLD: return "in world";
+	case STATE_JACKOUT: return "jackout";
+	case STATE_FINISHED: return "finished";
+	case STATE_FAILED: return "failed";
+	}
+	return "unknown";
+}
+
+void BotClient::SetState( BotState newState )
+{
+	m_state = newState;
+	m_stateSinceMS = getMSTime();
+}
+
+void BotClient::Fail( const string &reason )
+{
+	WARNING_LOG(format("%1%: %2% (waiting for %3%)") % m_username % reason % StateName(m_state));
+	sLoadStats.Count(LoadStats::FAILED);
+	CloseSockets();
+	SetState(STATE_FAILED);
+}
+
+void BotClient::Finish()
+{
+	DEBUG_LOG(format("%1%: jacked out") % m_username);
+	sLoadStats.Count(LoadStats::JACKED_OUT);
+	CloseSockets();
+	SetState(STATE_FINISHED);
+}
+
+bool BotClient::IsDone() const
+{
+	if (m_state != STATE_FINISHED && m_state != STATE_FAILED)
+		return false;
+
+	return m_settings.repeat == false;
+}
+
+bool BotClient::InWorld() const
+{
+	return m_state == STATE_IN_WORLD || m_state == STATE_JACKOUT;
+}
+
+bool BotClient::IsConnecting() const
+{
+	return m_state > STATE_WAITING && m_state < STATE_IN_WORLD;
+}
+
+void BotClient::Tick( uint32 currMS )
+{
+	switch (m_state)
+	{
+	case STATE_WAITING:
+		if (int32(currMS - m_startMS) >= 0)
+			StartAuth();
+		return;
+	case STATE_FINISHED:
+	case STATE_FAILED:
+		if (m_settings.repeat && currMS - m_stateSinceMS >= m_settings.repeatDelayMS)
+		{
+			Reset();
+			StartAuth();
+		}
+		return;
+	case STATE_IN_WORLD:
+	case STATE_JACKOUT:
+		WorldActivity(currMS);
+		return;
+	default:
+		break;
+	}
+
+	if (currMS - m_stateSinceMS >= m_settings.stepTimeoutMS)
+	{
+		Fail("timed out");
+		return;
+	}
+
+	if (m_state == STATE_WORLD_CONNECT)
+	{
+		//the server ignores repeats while it's loading the character, so keep at it until it answers
+		if (currMS - m_lastUdpSendMS >= 500)
+			SendInitialUdpPacket();
+	}
+	else if (m_state == STATE_WORLD_SPAWN)
+	{
+		SendWorldPacket(currMS);
+	}
+}
+
+void BotClient::OnTcpConnected( BotTcpSocket *sock )
+{
+	if (m_state == STATE_AUTH_CONNECT)
+	{
+		ByteBuffer request;
+		request << uint8(AS_GetPublicKeyRequest)
+			<< uint32(MATRIX_VERSION)
+			<< uint32(0); //anything but 4 gets us the server's public key
+
+		m_tcp->Send(request);
+		SetState(STATE_AUTH_PUBLIC_KEY);
+	}
+	else if (m_state == STATE_MARGIN_CONNECT)
+	{
+		//the signed ticket from auth, 36 01 signature signedData
+		ByteBuffer request;
+		request << uint8(CERT_ConnectRequest)
+			<< uint16(3);
+		request.append(&m_ticket[0],m_ticket.size());
+
+		m_tcp->Send(request);
+		SetState(STATE_MARGIN_CERT_CHALLENGE);
+	}
+}
+
+void BotClient::OnTcpClosed( BotTcpSocket *sock, const char *why )
+{
+	//the auth connection is expected to go away once we have our reply
+	if (sock != m_tcp)
+		return;
+
+	m_tcp->ReleaseOwner();
+	m_tcp = NULL;
+	//once the server has our jackout finished it drops the session, margin connection included
+	if (m_state == STATE_JACKOUT && m_jackoutConfirmedMS != 0)
+		Finish();
+	else if (m_state != STATE_FINISHED && m_state != STATE_FAILED)
+		Fail(string("tcp ") + why);
+}
+
+void BotClient::OnTcpFrame( BotTcpSocket *sock, const byte *buf, size_t len )
+{
+	if (sock != m_tcp || len < 1)
+		return;
+
+	ByteBuffer packet(buf,len);
+	try
+	{
+		if (m_state >= STATE_AUTH_PUBLIC_KEY && m_state <= STATE_AUTH_REPLY)
+			HandleAuthFrame(packet);
+		else if (m_state >= STATE_MARGIN_CERT_CHALLENGE)
+			HandleMarginFrame(packet);
+	}
+	catch (ByteBuffer::out_of_range)
+	{
+		Fail((format("truncated packet %1%") % Bin2Hex(packet,0)).str());
+	}
+	catch (std::exception &e)
+	{
+		Fail((format("bad packet (%1%)") % e.what()).str());
+	}
+	catch (InvalidCRCException)
+	{
+		Fail("margin packet failed crc");
+	}
+}
+
+void BotClient::StartAuth()
+{
+	sLoadStats.Count(LoadStats::BOTS_STARTED);
+
+	m_tcp = new BotTcpSocket(m_worker.GetHandler(),this);
+	m_tcp->SetDeleteByHandler();
+	SetState(STATE_AUTH_CONNECT);
+	m_loginStartMS = m_stepStartMS = getMSTime();
+
+	if (m_tcp->Open(m_settings.authAddress,m_settings.authPort) == false)
+	{
+		delete m_tcp;
+		m_tcp = NULL;
+		Fail("couldn't open auth connection");
+		return;
+	}
+	m_worker.GetHandler().Add(m_tcp);
+}
+
+void BotClient::HandleAuthFrame( ByteBuffer &packet )
+{
+	uint8 opcode;
+	packet >> opcode;
+
+	if (m_state == STATE_AUTH_PUBLIC_KEY && opcode == AS_GetPublicKeyReply)
+		SendAuthRequest(packet);
+	else if (m_state == STATE_AUTH_CHALLENGE && opcode == AS_AuthChallenge)
+		SendAuthChallengeResponse(packet);
+	else if (m_state == STATE_AUTH_REPLY && opcode == AS_AuthReply)
+		HandleAuthReply(packet);
+	else
+		Fail((format("unexpected auth packet %1%") % Bin2Hex(packet,0)).str());
+}
+
+void BotClient::SendAuthRequest( ByteBuffer &keyReply )
+{
+	uint32 zero, rsaMethod;
+	keyReply >> zero >> m_authTime >> rsaMethod;
+	keyReply.rpos(keyReply.rpos()+5); //12 00 11 94 00
+
+	uint16 modulusLen;
+	keyReply >> modulusLen;
+	if (keyReply.remaining() < modulusLen)
+		throw ByteBuffer::out_of_range();
+	m_serverModulus.resize(modulusLen);
+	keyReply.read((byte*)&m_serverModulus[0],modulusLen);
+
+	CryptoPP::RandomNumberGenerator &rng = m_worker.GetRNG();
+	rng.GenerateBlock(m_authKey,sizeof(m_authKey));
+	m_authEngine.Initialize(m_authKey,sizeof(m_authKey));
+
+	//the blob is 00, rsa method, someShort, our twofish key, the time they told us and the username
+	ByteBuffer blob;
+	blob << uint8(0)
+		<< uint32(4)
+		<< uint16(0);
+	blob.append(m_authKey,sizeof(m_authKey));
+	blob << uint32(m_authTime);
+	blob.writeString(m_username);
+
+	CryptoPP::Integer modulus;
+	modulus.Decode((const byte*)m_serverModulus.data(),m_serverModulus.size());
+	CryptoPP::RSA::PublicKey serverKey;
+	serverKey.Initialize(modulus,CryptoPP::Integer(17));
+	CryptoPP::RSAES_OAEP_SHA_Encryptor rsaEncryptor(serverKey);
+
+	string encryptedBlob;
+	CryptoPP::StringSource(string(blob.contents(),blob.size()),true,
+		new CryptoPP::PK_EncryptorFilter(rng,rsaEncryptor,new CryptoPP::StringSink(encryptedBlob)));
+
+	//rsaType, unknown, 31 unknown chars, blob length, then the blob
+	ByteBuffer request;
+	request << uint8(AS_AuthRequest)
+		<< uint32(4)
+		<< uint32(0);
+	byte unknownChars[31];
+	memset(unknownChars,0,sizeof(unknownChars));
+	request.append(unknownChars,sizeof(unknownChars));
+	request << uint16(encryptedBlob.size());
+	request.append(encryptedBlob);
+
+	m_tcp->Send(request);
+	SetState(STATE_AUTH_CHALLENGE);
+}
+
+void BotClient::SendAuthChallengeResponse( ByteBuffer &challenge )
+{
+	if (challenge.remaining() < sizeof(m_authChallenge))
+		throw ByteBuffer::out_of_range();
+	challenge.read(m_authChallenge,sizeof(m_authChallenge));
+
+	//decrypt with a zero IV and md5 it, that proves we have the key
+	m_authEngine.SetDecryptionIV();
+	ByteBuffer decryptedChallenge = m_authEngine.Decrypt(m_authChallenge,sizeof(m_authChallenge),false);
+
+	byte processedChallenge[16];
+	CryptoPP::Weak::MD5 md5Transformer;
+	md5Transformer.Update((const byte*)decryptedChallenge.contents(),decryptedChallenge.size());
+	md5Transformer.Final(processedChallenge);
+
+	ByteBuffer plainText;
+	plainText << uint8(0);
+	plainText.append(processedChallenge,sizeof(processedChallenge));
+	plainText << uint16(23) << uint16(0) << uint16(0);
+	plainText.writeString(m_settings.password);
+	plainText.writeString(string());
+
+	//pad it out to whole twofish blocks, the padding length counts as part of it
+	size_t paddingLen = TwofishCryptMethod::BLOCKSIZE - (plainText.size() + sizeof(uint16)) % TwofishCryptMethod::BLOCKSIZE;
+	plainText << uint16(paddingLen);
+	vector<byte> padding(paddingLen);
+	plainText.append(&padding[0],padding.size());
+
+	m_authEngine.SetEncryptionIV();
+	ByteBuffer cipherText = m_authEngine.Encrypt((const byte*)plainText.contents(),plainText.size(),false);
+
+	ByteBuffer response;
+	response << uint8(AS_AuthChallengeResponse)
+		<< uint16(0)
+		<< uint16(cipherText.size());
+	response.append(cipherText);
+
+	m_tcp->Send(response);
+	SetState(STATE_AUTH_REPLY);
+}
+
+void BotClient::HandleAuthReply( ByteBuffer &reply )
+{
+	reply.rpos(11);
+	uint16 offsetAuthData, offsetEncryptedData;
+	reply >> offsetAuthData >> offsetEncryptedData;
+
+	//characters start right after the 33 byte header
+	const size_t headerSize = 33;
+	const size_t characterDataSize = 14;
+	reply.rpos(headerSize);
+	uint16 numCharacters;
+	reply >> numCharacters;
+	if (numCharacters < 1)
+	{
+		Fail("account has no characters, create one with the accounts command output");
+		return;
+	}
+
+	//just play the first one
+	size_t characterPos = reply.rpos();
+	uint8 unknown;
+	uint16 handleOffset;
+	if (characterPos + numCharacters*characterDataSize > reply.size())
+		throw ByteBuffer::out_of_range();
+	reply >> unknown >> handleOffset >> m_charId;
+	reply.rpos(characterPos + handleOffset);
+	m_handle = reply.readString();
+
+	//36 01, signature and the signed data get passed on to margin untouched
+	const size_t ticketSize = sizeof(uint16) + 128 + sizeof(signedDataStruct);
+	reply.rpos(offsetAuthData);
+	if (reply.remaining() < ticketSize)
+		throw ByteBuffer::out_of_range();
+	m_ticket.resize(ticketSize);
+	reply.read(&m_ticket[0],m_ticket.size());
+	memcpy(&m_signedData,&m_ticket[ticketSize-sizeof(signedDataStruct)],sizeof(m_signedData));
+
+	//our private exponent, encrypted with the auth key and the challenge as IV
+	reply.rpos(offsetEncryptedData);
+	uint16 encryptedLen;
+	reply >> encryptedLen;
+	if (reply.remaining() < encryptedLen || encryptedLen == 0)
+		throw ByteBuffer::out_of_range();
+	vector<byte> encryptedExponent(encryptedLen);
+	reply.read(&encryptedExponent[0],encryptedExponent.size());
+
+	m_authEngine.SetDecryptionIV(m_authChallenge,sizeof(m_authChallenge));
+	ByteBuffer exponent = m_authEngine.Decrypt(&encryptedExponent[0],encryptedExponent.size(),false);
+	m_privateExponent = string(exponent.contents(),exponent.size());
+
+	uint32 currMS = getMSTime();
+	sLoadStats.Count(LoadStats::AUTH_COMPLETED);
+	sLoadStats.AddSample(LoadStats::LATENCY_AUTH,currMS - m_stepStartMS);
+
+	//done with auth
+	CloseSockets();
+	StartMargin();
+}
+
+void BotClient::StartMargin()
+{
+	m_tcp = new BotTcpSocket(m_worker.GetHandler(),this);
+	m_tcp->SetDeleteByHandler();
+	SetState(STATE_MARGIN_CONNECT);
+	m_stepStartMS = getMSTime();
+
+	if (m_tcp->Open(m_settings.marginAddress,m_settings.marginPort) == false)
+	{
+		delete m_tcp;
+		m_tcp = NULL;
+		Fail("couldn't open margin connection");
+		return;
+	}
+	m_worker.GetHandler().Add(m_tcp);
+}
+
+void BotClient::SendMarginEncrypted( const ByteBuffer &plainText )
+{
+	TwofishEncryptedPacket packet(plainText);
+	m_tcp->Send(packet.toCipherText(m_tfEngine));
+}
+
+void BotClient::HandleMarginFrame( ByteBuffer &packet )
+{
+	if (m_state == STATE_MARGIN_CERT_CHALLENGE)
+	{
+		HandleCertChallenge(packet);
+		return;
+	}
+
+	TwofishEncryptedPacket plainText(packet,m_tfEngine);
+	uint8 opcode;
+	plainText >> opcode;
+
+	if (m_state == STATE_MARGIN_CERT_REPLY && opcode == CERT_ConnectReply)
+	{
+		m_worker.GetRNG().GenerateBlock(m_weirdBytes,sizeof(m_weirdBytes));
+
+		ByteBuffer request;
+		request << uint8(MS_ConnectRequest)
+			<< uint32(MATRIX_VERSION)
+			<< uint32(MATRIX_VERSION);
+		byte unknownBytes[9];
+		memset(unknownBytes,0,sizeof(unknownBytes));
+		request.append(unknownBytes,sizeof(unknownBytes));
+		request.append(m_weirdBytes,sizeof(m_weirdBytes));
+		request << uint8(0);
+
+		SendMarginEncrypted(request);
+		SetState(STATE_MARGIN_CHALLENGE);
+	}
+	else if (m_state == STATE_MARGIN_CHALLENGE && opcode == MS_ConnectChallenge)
+	{
+		//md5 of the game files, the server takes anything
+		ByteBuffer response;
+		response << uint8(MS_ConnectChallengeResponse);
+		response.append(m_weirdBytes,sizeof(m_weirdBytes));
+
+		SendMarginEncrypted(response);
+		SetState(STATE_MARGIN_SESSION);
+	}
+	else if (m_state == STATE_MARGIN_SESSION && opcode == MS_ConnectReply)
+	{
+		uint32 unknown1, unknown2;
+		plainText >> unknown1 >> unknown2 >> m_sessionId;
+
+		//charId, 32 zeroes, the weird bytes 9 times, then where the soe string is and the string
+		ByteBuffer request;
+		request << uint8(MS_LoadCharacterRequest)
+			<< uint64(m_charId);
+		byte zeroes[32];
+		memset(zeroes,0,sizeof(zeroes));
+		request.append(zeroes,sizeof(zeroes));
+		for (int i=0;i<9;i++)
+			request.append(m_weirdBytes,sizeof(m_weirdBytes));
+		request << uint16(request.size() + sizeof(uint16));
+		request.writeString(m_handle);
+
+		SendMarginEncrypted(request);
+		SetState(STATE_MARGIN_CHARACTER);
+	}
+	else if (m_state == STATE_MARGIN_CHARACTER && opcode == MS_LoadCharacterReply)
+	{
+		uint32 currMS = getMSTime();
+		sLoadStats.Count(LoadStats::MARGIN_COMPLETED);
+		sLoadStats.AddSample(LoadStats::LATENCY_MARGIN,currMS - m_stepStartMS);
+
+		//the margin connection stays up for as long as we're in the world
+		StartWorld();
+	}
+}
+
+void BotClient::HandleCertChallenge( ByteBuffer &packet )
+{
+	uint8 opcode;
+	uint16 three, blobLen;
+	packet >> opcode >> three >> blobLen;
+	if (opcode != CERT_Challenge)
+	{
+		Fail((format("unexpected margin packet %1%") % Bin2Hex(packet,0)).str());
+		return;
+	}
+	if (packet.remaining() < blobLen)
+		throw ByteBuffer::out_of_range();
+	string encryptedBlob(&packet.contents()[packet.rpos()],blobLen);
+
+	//our own RSA key from the auth reply decrypts it
+	CryptoPP::Integer modulus, privateExponent;
+	modulus.Decode(m_signedData.modulus,sizeof(m_signedData.modulus));
+	privateExponent.Decode((const byte*)m_privateExponent.data(),m_privateExponent.size());
+
+	string decrypted;
+	try
+	{
+		CryptoPP::InvertibleRSAFunction userKey;
+		userKey.Initialize(modulus,CryptoPP::Integer(uint32(swap16(m_signedData.publicExponent))),privateExponent);
+		CryptoPP::RSAES_OAEP_SHA_Decryptor rsaDecryptor(userKey);
+		CryptoPP::StringSource(encryptedBlob,true,
+			new CryptoPP::PK_DecryptorFilter(m_worker.GetRNG(),rsaDecryptor,new CryptoPP::StringSink(decrypted)));
+	}
+	catch (CryptoPP::Exception &e)
+	{
+		Fail((format("couldn't decrypt CERT_Challenge (%1%)") % e.what()).str());
+		return;
+	}
+
+	//00, twofish key, challenge
+	const size_t keySize = 16, challengeSize = 16;
+	if (decrypted.size() != 1 + keySize + challengeSize)
+	{
+		Fail((format("CERT_Challenge decrypted to %1% bytes") % decrypted.size()).str());
+		return;
+	}
+	m_tfEngine.Initialize((const byte*)&decrypted[1],keySize);
+
+	ByteBuffer response;
+	response << uint8(CERT_ChallengeResponse);
+	response.append((const byte*)&decrypted[1+keySize],challengeSize);
+
+	SendMarginEncrypted(response);
+	SetState(STATE_MARGIN_CERT_REPLY);
+}
+
+void BotClient::StartWorld()
+{
+	m_udp = new BotUdpSocket(m_worker.GetHandler(),this);
+	m_udp->SetDeleteByHandler();
+	SetState(STATE_WORLD_CONNECT);
+	m_stepStartMS = getMSTime();
+
+	if (m_udp->Open(m_settings.worldAddress,m_settings.worldPort) == false)
+	{
+		delete m_udp;
+		m_udp = NULL;
+		Fail("couldn't open world socket");
+		return;
+	}
+	m_worker.GetHandler().Add(m_udp);
+	SendInitialUdpPacket();
+}
+
+void BotClient::SendInitialUdpPacket()
+{
+	//00, the character id at 0x0B, and the session id encrypted with the margin key at the end
+	ByteBuffer packet;
+	byte zeroes[43];
+	memset(zeroes,0,sizeof(zeroes));
+	packet.append(zeroes,sizeof(zeroes));
+	packet.put(0x0B,(const byte*)&m_charId,sizeof(m_charId));
+
+	ByteBuffer sessionBlock;
+	sessionBlock << uint32(m_sessionId);
+	sessionBlock.append(zeroes,TwofishCryptMethod::BLOCKSIZE-sizeof(uint32));
+	m_tfEngine.SetEncryptionIV();
+	ByteBuffer encryptedSession = m_tfEngine.Encrypt((const byte*)sessionBlock.contents(),sessionBlock.size(),false);
+	packet.put(packet.size()-encryptedSession.size(),(const byte*)encryptedSession.contents(),encryptedSession.size());
+
+	m_udp->Send(packet);
+	m_lastUdpSendMS = getMSTime();
+}
+
+void BotClient::OnUdpData( const char *buf, size_t len )
+{
+	if (len < 1 || m_udp == NULL)
+		return;
+
+	uint32 currMS = getMSTime();
+	if (buf[0] == 0x01)
+	{
+		HandleWorldEncrypted(&buf[1],len-1);
+		return;
+	}
+
+	const byte pingHeader[8] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x04, 0x08};
+	if (len == sizeof(pingHeader)+sizeof(uint32) && memcmp(buf,pingHeader,sizeof(pingHeader)) == 0)
+	{
+		uint32 sentMS;
+		memcpy(&sentMS,&buf[sizeof(pingHeader)],sizeof(sentMS));
+		sLoadStats.AddSample(LoadStats::LATENCY_RTT,currMS - sentMS);
+	}
+	else if (m_state == STATE_WORLD_CONNECT)
+	{
+		//the calibration heartbeats, the server is ready for us
+		sLoadStats.Count(LoadStats::WORLD_COMPLETED);
+		sLoadStats.AddSample(LoadStats::LATENCY_WORLD,currMS - m_stepStartMS);
+
+		ByteBuffer readyForSpawn;
+		readyForSpawn << uint8(0x05);
+		QueueCommand(readyForSpawn);
+
+		SetState(STATE_WORLD_SPAWN);
+		m_spawnRequestMS = currMS;
+		SendWorldPacket(currMS);
+	}
+}
+
+void BotClient::HandleWorldEncrypted( const char *buf, size_t len )
+{
+	if (!m_tfEngine.IsValid() || m_state < STATE_WORLD_SPAWN)
+		return;
+
+	ByteBuffer data;
+	try
+	{
+		ByteBuffer cipherText(buf,len);
+		TwofishEncryptedPacket plainText(cipherText,m_tfEngine);
+		SequencedPacket packet(plainText);
+
+		AcknowledgeOwnPackets(packet.getRemoteSeq(),packet.getAckBits());
+		NoteServerSequence(packet.getLocalSeq());
+		data = packet.getData();
+	}
+	catch (InvalidCRCException)
+	{
+		DEBUG_LOG(format("%1%: world packet failed crc") % m_username);
+		return;
+	}
+	catch (std::exception &e)
+	{
+		DEBUG_LOG(format("%1%: bad world packet (%2%)") % m_username % e.what());
+		return;
+	}
+
+	try
+	{
+		enum { SERVERFLAGS_SIMTIME = (1 << 7) };
+		uint8 serverFlags;
+		data >> serverFlags;
+		if (serverFlags & SERVERFLAGS_SIMTIME)
+		{
+			float simTime;
+			data >> simTime;
+		}
+
+		//empty ones are just acks, no need to ack those back
+		if (data.remaining() < 1)
+			return;
+		m_ackPending = true;
+
+		ByteBuffer rest(&data.contents()[data.rpos()],data.remaining());
+		if (rest.contents()[0] == 0x03)
+		{
+			HandleWorldState(rest);
+		}
+		else if (rest.contents()[0] == 0x04)
+		{
+			OrderedPacket commands;
+			if (commands.FromBuffer(rest))
+			{
+				for (list<MsgBlock>::iterator it1=commands.msgBlocks.begin();it1!=commands.msgBlocks.end();++it1)
+				{
+					for (list<ByteBuffer>::iterator it2=it1->subPackets.begin();it2!=it1->subPackets.end();++it2)
+						HandleWorldCommand(*it2);
+				}
+			}
+		}
+	}
+	catch (ByteBuffer::out_of_range)
+	{
+		DEBUG_LOG(format("%1%: truncated world packet") % m_username);
+	}
+}
+
+void BotClient::HandleWorldState( ByteBuffer &state )
+{
+	//the spawn is 202 bytes starting with 03 01 00 0C, handle at 0x5F, position at 0x9E and view id at 0xC5
+	const byte spawnHeader[4] = {0x03, 0x01, 0x00, 0x0C};
+	const size_t spawnSize = 202;
+	if (m_state != STATE_WORLD_SPAWN || state.size() != spawnSize || memcmp(state.contents(),spawnHeader,sizeof(spawnHeader)) != 0)
+		return;
+
+	string spawnedHandle(&state.contents()[0x5F],strnlen(&state.contents()[0x5F],32));
+	if (spawnedHandle != m_handle)
+		return;
+
+	double position[3];
+	memcpy(position,&state.contents()[0x9E],sizeof(position));
+	memcpy(&m_viewId,&state.contents()[0xC5],sizeof(m_viewId));
+	for (int i=0;i<3;i++)
+		m_spawnPos[i] = m_pos[i] = float(position[i]);
+
+	uint32 currMS = getMSTime();
+	sLoadStats.Count(LoadStats::SPAWNED);
+	sLoadStats.AddSample(LoadStats::LATENCY_SPAWN,currMS - m_spawnRequestMS);
+	sLoadStats.AddSample(LoadStats::LATENCY_LOGIN,currMS - m_loginStartMS);
+
+	SetState(STATE_IN_WORLD);
+	m_inWorldSinceMS = m_lastMoveMS = m_lastChatMS = currMS;
+	m_nextWaypoint = 0;
+}
+
+void BotClient::HandleWorldCommand( ByteBuffer &command )
+{
+	//80 fd, the server's done with the jackout
+	if (m_state == STATE_JACKOUT && command.size() >= 2 &&
+		uint8(command.contents()[0]) == 0x80 && uint8(command.contents()[1]) == 0xfd && m_jackoutConfirmedMS == 0)
+	{
+		m_jackoutConfirmedMS = getMSTime();
+
+		ByteBuffer jackoutFinished;
+		jackoutFinished << uint8(0x80) << uint8(0xfe);
+		QueueCommand(jackoutFinished);
+	}
+}
+
+void BotClient::NoteServerSequence( uint16 serverSeq )
+{
+	const uint32 seqMask = 0xFFF;
+	if (!m_serverSeqValid)
+	{
+		m_serverSeqValid = true;
+		m_serverSeq = serverSeq;
+		m_serverSeqBits = 1;
+		sLoadStats.AddSequences(1,0,0);
+	}
+	else if (IsSequenceMoreRecent(serverSeq,m_serverSeq))
+	{
+		uint32 gap = (serverSeq - m_serverSeq) & seqMask;
+		m_serverSeqBits = (gap < 32) ? ((m_serverSeqBits << gap) | 1) : 1;
+		m_serverSeq = serverSeq;
+		sLoadStats.AddSequences(1,gap-1,0);
+	}
+	else
+	{
+		uint32 behind = (m_serverSeq - serverSeq) & seqMask;
+		if (behind < 32 && (m_serverSeqBits & (1 << behind)) == 0)
+		{
+			//late, but not lost after all
+			m_serverSeqBits |= (1 << behind);
+			sLoadStats.AddSequences(1,0,1);
+		}
+	}
+}
+
+void BotClient::AcknowledgeOwnPackets( uint16 clientSeq, uint8 ackBits )
+{
+	const int maxAckedPackets = 7;
+	for (int i=0;i<maxAckedPackets;i++)
+	{
+		if ((ackBits & (1 << i)) == 0)
+			continue;
+
+		uint16 ackedSeq = (clientSeq - i) & 0xFFF;
+		for (deque<PendingCommand>::iterator it=m_pendingCommands.begin();it!=m_pendingCommands.end();)
+		{
+			if (std::count(it->sentIn.begin(),it->sentIn.end(),ackedSeq) > 0)
+				it = m_pendingCommands.erase(it);
+			else
+				++it;
+		}
+	}
+}
+
+void BotClient::QueueCommand( const ByteBuffer &command )
+{
+	PendingCommand pending;
+	pending.sequenceId = m_commandsSent++;
+	pending.data = command;
+	pending.lastSentMS = 0;
+	m_pendingCommands.push_back(pending);
+}
+
+void BotClient::SendWorldPacket( uint32 currMS )
+{
+	if (m_udp == NULL || !m_tfEngine.IsValid())
+		return;
+
+	//commands go out until a packet carrying them gets acked
+	const uint32 commandResendMS = 500;
+	const size_t maxCommandsPerPacket = 8;
+	OrderedPacket commands;
+	for (deque<PendingCommand>::iterator it=m_pendingCommands.begin();it!=m_pendingCommands.end() && commands.msgBlocks.size()<maxCommandsPerPacket;++it)
+	{
+		if (it->lastSentMS != 0 && currMS - it->lastSentMS < commandResendMS)
+			continue;
+
+		MsgBlock block;
+		block.sequenceId = it->sequenceId;
+		block.subPackets.push_back(it->data);
+		commands.msgBlocks.push_back(block);
+
+		it->lastSentMS = currMS;
+		it->sentIn.push_back(m_clientSeq);
+	}
+
+	//acks alone can wait a bit to ride along with something, but not forever
+	const uint32 ackDelayMS = 100;
+	const uint32 keepAliveMS = 1000;
+	bool haveSomething = commands.msgBlocks.size() > 0 || m_pendingState.size() > 0 || m_pendingTrailingState.size() > 0;
+	if (!haveSomething && !(m_ackPending && currMS - m_lastUdpSendMS >= ackDelayMS) && currMS - m_lastUdpSendMS < keepAliveMS)
+		return;
+
+	ByteBuffer payload;
+	payload << uint8(0x02);
+	if (m_pendingState.size() > 0)
+	{
+		payload.append(m_pendingState);
+		m_pendingState.clear();
+	}
+	if (commands.msgBlocks.size() > 0)
+		payload.append(commands.toBuf());
+	if (m_pendingTrailingState.size() > 0)
+	{
+		payload.append(m_pendingTrailingState);
+		m_pendingTrailingState.clear();
+	}
+
+	uint8 ackBits = uint8(m_serverSeqBits & 0x7F);
+	SequencedPacket sequenced(m_clientSeq,m_serverSeq,ackBits,payload);
+	TwofishEncryptedPacket encrypted(sequenced.getDataWithHeader());
+
+	ByteBuffer packet;
+	packet << uint8(0x01);
+	packet.append(encrypted.toCipherText(m_tfEngine));
+	m_udp->Send(packet);
+
+	m_clientSeq = (m_clientSeq + 1) & 0xFFF;
+	m_ackPending = false;
+	m_lastUdpSendMS = currMS;
+}
+
+void BotClient::SendPing( uint32 currMS )
+{
+	const byte pingHeader[8] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x04, 0x08};
+	ByteBuffer ping;
+	ping.append(pingHeader,sizeof(pingHeader));
+	ping << uint32(currMS);
+
+	m_udp->Send(ping);
+	m_lastPingMS = currMS;
+}
+
+void BotClient::WorldActivity( uint32 currMS )
+{
+	if (currMS - m_lastPingMS >= m_settings.pingIntervalMS)
+		SendPing(currMS);
+
+	if (m_state == STATE_IN_WORLD)
+	{
+		if (m_settings.replay != NULL)
+		{
+			Replay(currMS);
+		}
+		else if (currMS - m_inWorldSinceMS >= m_settings.sessionMS)
+		{
+			StartJackout();
+		}
+		else
+		{
+			if (currMS - m_lastMoveMS >= m_settings.moveIntervalMS)
+				Walk(currMS);
+			if (m_settings.chatIntervalMS > 0 && currMS - m_lastChatMS >= m_settings.chatIntervalMS)
+			{
+				m_lastChatMS = currMS;
+				Chat();
+			}
+		}
+	}
+	else if (m_state == STATE_JACKOUT)
+	{
+		//we're out once the server has our jackout finished, it may well drop us before acking it
+		const uint32 jackoutFinishedMS = 2000;
+		if (m_jackoutConfirmedMS != 0 && (m_pendingCommands.empty() || currMS - m_jackoutConfirmedMS >= jackoutFinishedMS))
+		{
+			Finish();
+			return;
+		}
+		if (currMS - m_stateSinceMS >= m_settings.stepTimeoutMS)
+		{
+			Fail("timed out");
+			return;
+		}
+	}
+
+	SendWorldPacket(currMS);
+}
+
+void BotClient::Walk( uint32 currMS )
+{
+	float maxStep = m_settings.moveSpeed * float(currMS - m_lastMoveMS) / 1000.0f;
+	m_lastMoveMS = currMS;
+
+	const BotSettings::Waypoint &waypoint = m_settings.path[m_nextWaypoint];
+	float target[3] = { m_spawnPos[0]+waypoint.x, m_spawnPos[1]+waypoint.y, m_spawnPos[2]+waypoint.z };
+	float delta[3] = { target[0]-m_pos[0], target[1]-m_pos[1], target[2]-m_pos[2] };
+	float distance = sqrtf(delta[0]*delta[0] + delta[1]*delta[1] + delta[2]*delta[2]);
+	if (distance <= maxStep)
+	{
+		memcpy(m_pos,target,sizeof(m_pos));
+		m_nextWaypoint = (m_nextWaypoint + 1) % m_settings.path.size();
+	}
+	else
+	{
+		for (int i=0;i<3;i++)
+			m_pos[i] += delta[i] * maxStep / distance;
+	}
+
+	//03, our view, 01, 08 then xyz
+	m_pendingState.clear();
+	m_pendingState << uint8(0x03)
+		<< uint16(m_viewId)
+		<< uint8(0x01)
+		<< uint8(0x08)
+		<< float(m_pos[0]) << float(m_pos[1]) << float(m_pos[2]);
+}
+
+void BotClient::Chat()
+{
+	//28 10, where the string starts, 4 unknown bytes, then the string
+	ByteBuffer chat;
+	chat << uint8(0x28) << uint8(0x10)
+		<< uint16(swap16(8))
+		<< uint32(0);
+	chat.writeString((format("load test message %1% from %2%") % ++m_chatCount % m_handle).str());
+
+	QueueCommand(chat);
+	sLoadStats.Count(LoadStats::CHATS_SENT);
+}
+
+void BotClient::Replay( uint32 currMS )
+{
+	const vector<ReplayLog::Packet> &packets = m_settings.replay->GetPackets();
+	uint32 replayMS = uint32(float(currMS - m_inWorldSinceMS) * m_settings.replaySpeed);
+
+	//everything due goes out, state updates replace each other like they do in the client
+	while (m_replayNext < packets.size() && packets[m_replayNext].atMS <= replayMS)
+	{
+		const ReplayLog::Packet &packet = packets[m_replayNext++];
+		if (packet.state.size() > 0)
+		{
+			m_pendingState = packet.state;
+			RemapState(m_pendingState);
+		}
+		if (packet.trailingState.size() > 0)
+		{
+			m_pendingTrailingState = packet.trailingState;
+			RemapState(m_pendingTrailingState);
+		}
+		for (list<ByteBuffer>::const_iterator it=packet.commands.begin();it!=packet.commands.end();++it)
+		{
+			//we jack out on our own once the recording's over
+			if (it->size() >= 2 && uint8(it->contents()[0]) == 0x80 &&
+				(uint8(it->contents()[1]) == 0xfc || uint8(it->contents()[1]) == 0xfe))
+				continue;
+
+			QueueCommand(*it);
+		}
+		sLoadStats.Count(LoadStats::PACKETS_REPLAYED);
+	}
+
+	if (m_replayNext >= packets.size() && m_pendingCommands.empty())
+		StartJackout();
+}
+
+void BotClient::RemapState( ByteBuffer &state ) const
+{
+	//03, view id of whoever recorded it, the rest is the same for us
+	if (state.size() >= 3 && uint8(state.contents()[0]) == 0x03)
+		state.put(1,uint16(m_viewId));
+}
+
+void BotClient::StartJackout()
+{
+	//any movement cancels a jackout, so from here on we stand still
+	m_pendingState.clear();
+	m_pendingTrailingState.clear();
+
+	ByteBuffer jackoutRequest;
+	jackoutRequest << uint8(0x80) << uint8(0xfc)
+		<< uint32(0) << uint32(0);
+	QueueCommand(jackoutRequest);
+
+	SetState(STATE_JACKOUT);
+}
@@ -0,0 +1,235 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_BOTCLIENT_H
+#define MXOEMU_BOTCLIENT_H
+
+#include "Common.h"
+#include "ByteBuffer.h"
+#include "SymmetricCrypto.h"
+#include "SignedDataStruct.h"
+#include <Sockets/socket_include.h>
+
+class ReplayLog;
+
+class BotTcpSocket;
+class BotUdpSocket;
+class BotWorker;
+
+// What every bot needs to know, read from LoadGen.conf once at startup
+struct BotSettings
+{
+	struct Waypoint
+	{
+		float x,y,z;
+	};
+
+	ipaddr_t authAddress;
+	port_t authPort;
+	ipaddr_t marginAddress;
+	port_t marginPort;
+	ipaddr_t worldAddress;
+	port_t worldPort;
+
+	string accountPrefix;
+	string password;
+
+	uint32 stepTimeoutMS;
+	uint32 sessionMS;
+	uint32 moveIntervalMS;
+	float moveSpeed;
+	uint32 chatIntervalMS;
+	uint32 pingIntervalMS;
+	bool repeat;
+	uint32 repeatDelayMS;
+
+	// offsets from wherever the character spawned, walked in a loop
+	vector<Waypoint> path;
+
+	// a recorded session to play back in world instead of walking and chatting, ReplaySpeed 2 plays it twice as fast
+	shared_ptr<ReplayLog> replay;
+	float replaySpeed;
+
+	bool Load();
+	string AccountName(uint32 botIndex) const
+	{
+		return (format("%s%04u") % accountPrefix % botIndex).str();
+	}
+};
+
+// One simulated player. Logs in through auth and margin like the real client does, then
+// connects to the world, spawns, walks the scripted path and chats until its session is up,
+// and jacks out. With a replay file it plays back the recorded session instead, with its own view id in
+// the state updates and its own command sequence, and jacks out at the end of it. Lives on a single worker thread, which drives it through Tick and the socket callbacks.
+class BotClient
+{
+public:
+	BotClient(BotWorker &worker, uint32 botIndex, uint32 startMS);
+	~BotClient();
+
+	void Tick(uint32 currMS);
+	bool IsDone() const;
+	bool InWorld() const;
+	bool IsConnecting() const;
+
+	// socket callbacks
+	void OnTcpConnected(BotTcpSocket *sock);
+	void OnTcpClosed(BotTcpSocket *sock, const char *why);
+	void OnTcpFrame(BotTcpSocket *sock, const byte *buf, size_t len);
+	void OnUdpData(const char *buf, size_t len);
+private:
+	enum BotState
+	{
+		STATE_WAITING,
+		STATE_AUTH_CONNECT,
+		STATE_AUTH_PUBLIC_KEY,
+		STATE_AUTH_CHALLENGE,
+		STATE_AUTH_REPLY,
+		STATE_MARGIN_CONNECT,
+		STATE_MARGIN_CERT_CHALLENGE,
+		STATE_MARGIN_CERT_REPLY,
+		STATE_MARGIN_CHALLENGE,
+		STATE_MARGIN_SESSION,
+		STATE_MARGIN_CHARACTER,
+		STATE_WORLD_CONNECT,
+		STATE_WORLD_SPAWN,
+		STATE_IN_WORLD,
+		STATE_JACKOUT,
+		STATE_FINISHED,
+		STATE_FAILED
+	};
+	static const char *StateName(BotState state);
+	void SetState(BotState newState);
+	void Fail(const string &reason);
+	void Finish();
+	void Reset();
+	void CloseSockets();
+
+	// auth
+	void StartAuth();
+	void HandleAuthFrame(ByteBuffer &packet);
+	void SendAuthRequest(ByteBuffer &keyReply);
+	void SendAuthChallengeResponse(ByteBuffer &challenge);
+	void HandleAuthReply(ByteBuffer &reply);
+
+	// margin
+	void StartMargin();
+	void HandleMarginFrame(ByteBuffer &packet);
+	void HandleCertChallenge(ByteBuffer &packet);
+	void SendMarginEncrypted(const ByteBuffer &plainText);
+
+	// world
+	void StartWorld();
+	void SendInitialUdpPacket();
+	void HandleWorldEncrypted(const char *buf, size_t len);
+	void HandleWorldState(ByteBuffer &state);
+	void HandleWorldCommand(ByteBuffer &command);
+	void NoteServerSequence(uint16 serverSeq);
+	void AcknowledgeOwnPackets(uint16 clientSeq, uint8 ackBits);
+	void QueueCommand(const ByteBuffer &command);
+	void SendWorldPacket(uint32 currMS);
+	void SendPing(uint32 currMS);
+	void WorldActivity(uint32 currMS);
+	void Walk(uint32 currMS);
+	void Chat();
+	void Replay(uint32 currMS);
+	void RemapState(ByteBuffer &state) const;
+	void StartJackout();
+
+	static bool IsSequenceMoreRecent(uint16 biggerSequence, uint16 smallerSequence)
+	{
+		const int32 maxSequence = 4096;
+		return	( (biggerSequence > smallerSequence) && (biggerSequence-smallerSequence <= maxSequence/2) )
+			|| ( (smallerSequence > biggerSequence) && (smallerSequence-biggerSequence > maxSequence/2) );
+	}
+
+	BotWorker &m_worker;
+	const BotSettings &m_settings;
+	uint32 m_botIndex;
+	string m_username;
+
+	BotState m_state;
+	uint32 m_stateSinceMS;
+	uint32 m_startMS;
+	uint32 m_loginStartMS;
+	uint32 m_stepStartMS;
+
+	BotTcpSocket *m_tcp;
+	BotUdpSocket *m_udp;
+
+	// auth
+	TwofishCryptEngine m_authEngine;
+	byte m_authKey[16];
+	byte m_authChallenge[16];
+	uint32 m_authTime;
+	string m_serverModulus;
+
+	// what auth gave us, the signed ticket goes to margin as is
+	vector<byte> m_ticket;
+	signedDataStruct m_signedData;
+	string m_privateExponent;
+	uint64 m_charId;
+	string m_handle;
+
+	// margin, its key is also used for the world
+	TwofishCryptEngine m_tfEngine;
+	uint32 m_sessionId;
+	byte m_weirdBytes[16];
+
+	// world reliability
+	struct PendingCommand
+	{
+		uint16 sequenceId;
+		ByteBuffer data;
+		uint32 lastSentMS;
+		vector<uint16> sentIn;
+	};
+	deque<PendingCommand> m_pendingCommands;
+	uint16 m_commandsSent;
+	ByteBuffer m_pendingState;
+	ByteBuffer m_pendingTrailingState;
+	uint16 m_clientSeq;
+	uint16 m_serverSeq;
+	bool m_serverSeqValid;
+	uint32 m_serverSeqBits;
+	bool m_ackPending;
+	uint32 m_lastUdpSendMS;
+	uint32 m_lastPingMS;
+
+	// world activity
+	uint16 m_viewId;
+	float m_spawnPos[3];
+	float m_pos[3];
+	size_t m_nextWaypoint;
+	uint32 m_lastMoveMS;
+	uint32 m_lastChatMS;
+	uint32 m_chatCount;
+	uint32 m_spawnRequestMS;
+	uint32 m_inWorldSinceMS;
+	uint32 m_jackoutConfirmedMS;
+	size_t m_replayNext;
+};
+
+#endif
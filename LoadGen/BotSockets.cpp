@@ -0,0 +1,88 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#include "BotSockets.h"
+#include "BotClient.h"
+#include "LoadStats.h"
+
+BotTcpSocket::BotTcpSocket( ISocketHandler& h, BotClient *owner ) : TCPVarLenSocket(h), m_owner(owner)
+{
+}
+
+BotTcpSocket::~BotTcpSocket()
+{
+}
+
+void BotTcpSocket::Send( const ByteBuffer &packet )
+{
+	sLoadStats.AddTraffic(false,packet.size());
+	SendPacket(TCPVariableLengthPacket(packet));
+}
+
+void BotTcpSocket::OnConnect()
+{
+	if (m_owner != NULL)
+		m_owner->OnTcpConnected(this);
+}
+
+void BotTcpSocket::OnConnectFailed()
+{
+	if (m_owner != NULL)
+		m_owner->OnTcpClosed(this,"connect failed");
+}
+
+void BotTcpSocket::OnDisconnect()
+{
+	if (m_owner != NULL)
+		m_owner->OnTcpClosed(this,"disconnected");
+}
+
+void BotTcpSocket::ProcessData( const byte *buf,size_t len )
+{
+	sLoadStats.AddTraffic(true,len);
+	if (m_owner != NULL)
+		m_owner->OnTcpFrame(this,buf,len);
+}
+
+BotUdpSocket::BotUdpSocket( ISocketHandler& h, BotClient *owner ) : UdpSocket(h), m_owner(owner)
+{
+}
+
+BotUdpSocket::~BotUdpSocket()
+{
+}
+
+void BotUdpSocket::Send( const ByteBuffer &packet )
+{
+	sLoadStats.AddTraffic(false,packet.size());
+	SendBuf(packet.contents(),packet.size());
+}
+
+void BotUdpSocket::OnRawData( const char *buf,size_t len,struct sockaddr *sa,socklen_t sa_len )
+{
+	sLoadStats.AddTraffic(true,len);
+	if (m_owner != NULL)
+		m_owner->OnUdpData(buf,len);
+}
@@ -0,0 +1,70 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_BOTSOCKETS_H
+#define MXOEMU_BOTSOCKETS_H
+
+#include "Common.h"
+#include "ByteBuffer.h"
+#include "TCPVarLenSocket.h"
+#include <Sockets/UdpSocket.h>
+
+class BotClient;
+
+// The sockets are owned by their handler, which deletes them once they're closed.
+// A bot that lets go of one calls ReleaseOwner first, so nothing calls back into it afterwards.
+class BotTcpSocket : public TCPVarLenSocket
+{
+public:
+	BotTcpSocket(ISocketHandler& h, BotClient *owner);
+	~BotTcpSocket();
+
+	void ReleaseOwner() { m_owner = NULL; }
+	void Send(const ByteBuffer &packet);
+
+	void OnConnect();
+	void OnConnectFailed();
+	void OnDisconnect();
+private:
+	void ProcessData(const byte *buf,size_t len);
+
+	BotClient *m_owner;
+};
+
+class BotUdpSocket : public UdpSocket
+{
+public:
+	BotUdpSocket(ISocketHandler& h, BotClient *owner);
+	~BotUdpSocket();
+
+	void ReleaseOwner() { m_owner = NULL; }
+	void Send(const ByteBuffer &packet);
+
+	void OnRawData(const char *buf,size_t len,struct sockaddr *sa,socklen_t sa_len);
+private:
+	BotClient *m_owner;
+};
+
+#endif
@@ -0,0 +1,98 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#include "BotWorker.h"
+#include "LoadStats.h"
+#include "Timer.h"
+#include "Util.h"
+
+BotWorker::BotWorker( uint32 workerIdx, const BotSettings &settings ) : ThreadContext(), m_workerIdx(workerIdx), m_settings(settings), m_finished(false)
+{
+}
+
+BotWorker::~BotWorker()
+{
+	for (size_t i=0;i<m_bots.size();i++)
+		delete m_bots[i];
+
+	m_bots.clear();
+}
+
+void BotWorker::AddBot( uint32 botIndex, uint32 startMS )
+{
+	m_bots.push_back(new BotClient(*this,botIndex,startMS));
+}
+
+bool BotWorker::run()
+{
+	SetThreadName((format("LoadGen Worker %1%") % m_workerIdx).str().c_str());
+
+	uint32 lastTickMS = 0;
+	uint32 lastActiveMS = 0;
+	while (m_threadRunning && !m_bots.empty())
+	{
+		m_handler.Select(0,TICK_MS*1000/2);
+
+		uint32 currMS = getMSTime();
+		if (currMS - lastTickMS < TICK_MS)
+			continue;
+		lastTickMS = currMS;
+
+		uint32 inWorld = 0, connecting = 0;
+		for (vector<BotClient*>::iterator it=m_bots.begin();it!=m_bots.end();)
+		{
+			BotClient *bot = *it;
+			bot->Tick(currMS);
+			if (bot->IsDone())
+			{
+				delete bot;
+				it = m_bots.erase(it);
+				continue;
+			}
+
+			if (bot->InWorld())
+				inWorld++;
+			else if (bot->IsConnecting())
+				connecting++;
+			++it;
+		}
+
+		if (currMS - lastActiveMS >= 1000)
+		{
+			lastActiveMS = currMS;
+			sLoadStats.SetActive(m_workerIdx,inWorld,connecting);
+		}
+	}
+
+	//let the sockets of whoever is left close properly
+	for (size_t i=0;i<m_bots.size();i++)
+		delete m_bots[i];
+	m_bots.clear();
+	m_handler.Select(0,0);
+
+	sLoadStats.SetActive(m_workerIdx,0,0);
+	m_finished = true;
+	return false;
+}
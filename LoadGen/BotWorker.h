@@ -0,0 +1,63 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_BOTWORKER_H
+#define MXOEMU_BOTWORKER_H
+
+#include "Common.h"
+#include "Crypto.h"
+#include "BotClient.h"
+#include "Threading/ThreadStarter.h"
+#include <Sockets/SocketHandlerEp.h>
+
+// A thread with its own epoll socket handler, driving a share of the bots.
+// run() returns false so the thread pool leaves it alone, main waits for IsFinished() and deletes it.
+class BotWorker : public ThreadContext
+{
+public:
+	BotWorker(uint32 workerIdx, const BotSettings &settings);
+	~BotWorker();
+
+	// only before the thread is started
+	void AddBot(uint32 botIndex, uint32 startMS);
+
+	bool run();
+	bool IsFinished() { return m_finished; }
+
+	ISocketHandler &GetHandler() { return m_handler; }
+	CryptoPP::RandomNumberGenerator &GetRNG() { return m_rng; }
+	const BotSettings &GetSettings() { return m_settings; }
+private:
+	static const uint32 TICK_MS = 50;
+
+	uint32 m_workerIdx;
+	const BotSettings &m_settings;
+	SocketHandlerEp m_handler;
+	CryptoPP::AutoSeededRandomPool m_rng;
+	vector<BotClient*> m_bots;
+	volatile bool m_finished;
+};
+
+#endif
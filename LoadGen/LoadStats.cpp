@@ -0,0 +1,165 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#include "LoadStats.h"
+#include "Threading/Guard.h"
+#include "Timer.h"
+
+createFileSingleton( LoadStats );
+
+LoadStats::LoadStats()
+{
+	m_startMS = m_intervalStartMS = 0;
+	memset(m_counters,0,sizeof(m_counters));
+	m_bytesIn = m_bytesOut = 0;
+	m_packetsIn = m_packetsOut = 0;
+	m_seqReceived = m_seqLost = 0;
+	m_totalSeqReceived = m_totalSeqLost = 0;
+}
+
+LoadStats::~LoadStats()
+{
+}
+
+void LoadStats::Start()
+{
+	Guard guard(m_lock);
+	m_startMS = m_intervalStartMS = getMSTime();
+}
+
+void LoadStats::Count( Counter which, uint32 amount )
+{
+	Guard guard(m_lock);
+	m_counters[which] += amount;
+}
+
+void LoadStats::AddSample( Latency which, uint32 ms )
+{
+	Guard guard(m_lock);
+	m_samples[which].push_back(ms);
+}
+
+void LoadStats::AddTraffic( bool fromServer, size_t bytes )
+{
+	Guard guard(m_lock);
+	if (fromServer)
+	{
+		m_bytesIn += bytes;
+		m_packetsIn++;
+	}
+	else
+	{
+		m_bytesOut += bytes;
+		m_packetsOut++;
+	}
+}
+
+void LoadStats::AddSequences( uint32 received, uint32 lost, uint32 recovered )
+{
+	Guard guard(m_lock);
+	m_seqReceived += received;
+	m_seqLost += lost;
+	m_totalSeqReceived += received;
+	m_totalSeqLost += lost;
+
+	//late packets were counted as lost when their gap showed up
+	m_seqLost -= min(uint64(recovered),m_seqLost);
+	m_totalSeqLost -= min(uint64(recovered),m_totalSeqLost);
+}
+
+void LoadStats::SetActive( uint32 workerIdx, uint32 inWorld, uint32 connecting )
+{
+	Guard guard(m_lock);
+	m_active[workerIdx] = std::make_pair(inWorld,connecting);
+}
+
+string LoadStats::Percentiles( vector<uint32> &samples )
+{
+	if (samples.empty())
+		return "-";
+
+	sort(samples.begin(),samples.end());
+	size_t last = samples.size()-1;
+	return (format("p50 %1%ms p90 %2%ms p99 %3%ms max %4%ms (%5%)")
+		% samples[last*50/100]
+		% samples[last*90/100]
+		% samples[last*99/100]
+		% samples[last]
+		% samples.size()).str();
+}
+
+string LoadStats::Report()
+{
+	Guard guard(m_lock);
+
+	uint32 currMS = getMSTime();
+	float seconds = float(currMS - m_intervalStartMS)/1000.0f;
+	if (seconds <= 0.0f)
+		seconds = 1.0f;
+
+	uint32 inWorld = 0, connecting = 0;
+	for (map<uint32, std::pair<uint32,uint32> >::iterator it=m_active.begin();it!=m_active.end();++it)
+	{
+		inWorld += it->second.first;
+		connecting += it->second.second;
+	}
+
+	ostringstream report;
+	report << format("[%1%s] %2% in world, %3% logging in | started %4% auth %5% margin %6% world %7% spawned %8% chats %9% replayed %10% jackouts %11% failed %12%")
+		% ((currMS - m_startMS)/1000)
+		% inWorld % connecting
+		% m_counters[BOTS_STARTED] % m_counters[AUTH_COMPLETED] % m_counters[MARGIN_COMPLETED]
+		% m_counters[WORLD_COMPLETED] % m_counters[SPAWNED] % m_counters[CHATS_SENT] % m_counters[PACKETS_REPLAYED]
+		% m_counters[JACKED_OUT] % m_counters[FAILED];
+
+	const char *latencyNames[NUM_LATENCIES] = {"auth","margin","world","spawn","login","rtt"};
+	for (int i=0;i<NUM_LATENCIES;i++)
+	{
+		if (m_samples[i].empty())
+			continue;
+
+		report << std::endl << format("    %-7s %s") % latencyNames[i] % Percentiles(m_samples[i]);
+		m_samples[i].clear();
+	}
+
+	float intervalLoss = 0.0f;
+	if (m_seqReceived + m_seqLost > 0)
+		intervalLoss = float(m_seqLost) * 100.0f / float(m_seqReceived + m_seqLost);
+	float totalLoss = 0.0f;
+	if (m_totalSeqReceived + m_totalSeqLost > 0)
+		totalLoss = float(m_totalSeqLost) * 100.0f / float(m_totalSeqReceived + m_totalSeqLost);
+
+	report << std::endl << format("    server %.1f KB/s %.0f pkt/s, bots %.1f KB/s %.0f pkt/s, loss %.2f%% (%.2f%% overall)")
+		% (float(m_bytesIn)/1024.0f/seconds) % (float(m_packetsIn)/seconds)
+		% (float(m_bytesOut)/1024.0f/seconds) % (float(m_packetsOut)/seconds)
+		% intervalLoss % totalLoss;
+
+	m_bytesIn = m_bytesOut = 0;
+	m_packetsIn = m_packetsOut = 0;
+	m_seqReceived = m_seqLost = 0;
+	m_intervalStartMS = currMS;
+
+	return report.str();
+}
@@ -0,0 +1,97 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_LOADSTATS_H
+#define MXOEMU_LOADSTATS_H
+
+#include "Common.h"
+#include "Singleton.h"
+#include "Threading/NativeMutex.h"
+
+// Everything the bots measure ends up here, from whichever worker thread they run on.
+// Counters keep running for the whole test, latency samples and traffic are per report interval.
+class LoadStats : public Singleton<LoadStats>
+{
+public:
+	enum Counter
+	{
+		BOTS_STARTED,
+		AUTH_COMPLETED,
+		MARGIN_COMPLETED,
+		WORLD_COMPLETED,
+		SPAWNED,
+		CHATS_SENT,
+		PACKETS_REPLAYED,
+		JACKED_OUT,
+		FAILED,
+		NUM_COUNTERS
+	};
+	enum Latency
+	{
+		LATENCY_AUTH,		// tcp connect to AS_AuthReply
+		LATENCY_MARGIN,		// tcp connect to the first MS_LoadCharacterReply
+		LATENCY_WORLD,		// first udp packet to the heartbeats
+		LATENCY_SPAWN,		// ReadyForSpawn to our own spawn state
+		LATENCY_LOGIN,		// auth connect to spawned, the whole thing
+		LATENCY_RTT,		// world ping round trips
+		NUM_LATENCIES
+	};
+
+	LoadStats();
+	~LoadStats();
+
+	// the test starts now, as far as the report is concerned
+	void Start();
+
+	void Count(Counter which, uint32 amount=1);
+	void AddSample(Latency which, uint32 ms);
+	void AddTraffic(bool fromServer, size_t bytes);
+	// sequences the server skipped and ones that arrived late after all
+	void AddSequences(uint32 received, uint32 lost, uint32 recovered);
+	void SetActive(uint32 workerIdx, uint32 inWorld, uint32 connecting);
+
+	// takes the interval's samples and returns the report for them
+	string Report();
+private:
+	static string Percentiles(vector<uint32> &samples);
+
+	NativeMutex m_lock;
+	uint32 m_startMS;
+	uint32 m_intervalStartMS;
+
+	uint64 m_counters[NUM_COUNTERS];
+	vector<uint32> m_samples[NUM_LATENCIES];
+
+	uint64 m_bytesIn, m_bytesOut;
+	uint64 m_packetsIn, m_packetsOut;
+	uint64 m_seqReceived, m_seqLost;
+	uint64 m_totalSeqReceived, m_totalSeqLost;
+
+	map<uint32, std::pair<uint32,uint32> > m_active;
+};
+
+#define sLoadStats LoadStats::getSingleton()
+
+#endif
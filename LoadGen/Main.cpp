@@ -0,0 +1,150 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#include "Common.h"
+#include "Config.h"
+#include "Log.h"
+#include "Timer.h"
+#include "Threading/Threading.h"
+#include "BotClient.h"
+#include "BotWorker.h"
+#include "LoadStats.h"
+
+#define LOADGEN_CONFIG "LoadGen.conf"
+
+static volatile bool stopEvent = false;
+
+static void OnSignal(int s)
+{
+	stopEvent = true;
+	signal(s, OnSignal);
+}
+
+// The bots log in with accounts bot0000, bot0001... which have to exist on the server first.
+// This prints the console commands that create them, to paste or pipe into Reality.
+static void PrintAccountCommands(uint32 numClients, const BotSettings &settings)
+{
+	string worldName = sConfig.GetStringDefault("LoadGen.WorldName","Reality");
+	for (uint32 i=0;i<numClients;i++)
+	{
+		string accountName = settings.AccountName(i);
+		cout << format("register %1% %2%") % accountName % settings.password << std::endl;
+		cout << format("createCharacter %1% %2% %2% Load Bot%3%") % worldName % accountName % i << std::endl;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	const char *configFile = LOADGEN_CONFIG;
+	bool printAccounts = false;
+	for (int i=1;i<argc;i++)
+	{
+		if (string(argv[i]) == "accounts")
+			printAccounts = true;
+		else if (string(argv[i]) == "-c" && i+1 < argc)
+			configFile = argv[++i];
+		else
+		{
+			cout << format("Usage: %1% [-c config] [accounts]") % argv[0] << std::endl;
+			return 1;
+		}
+	}
+
+	if (!sConfig.SetSource(configFile))
+	{
+		CRITICAL_LOG(format("Could not find configuration file %1%.") % configFile);
+		return 1;
+	}
+	sLog.OpenLogFile("LoadGen.log");
+
+	BotSettings settings;
+	if (!settings.Load())
+		return 1;
+
+	uint32 numClients = sConfig.GetIntDefault("LoadGen.Clients",100);
+	if (printAccounts)
+	{
+		PrintAccountCommands(numClients,settings);
+		return 0;
+	}
+
+	uint32 numThreads = max(sConfig.GetIntDefault("LoadGen.Threads",2),1);
+	uint32 rampUpPerSecond = max(sConfig.GetIntDefault("LoadGen.RampUpPerSecond",50),1);
+	uint32 reportIntervalMS = max(sConfig.GetIntDefault("LoadGen.ReportIntervalSeconds",5),1) * 1000;
+
+	INFO_LOG(format("Starting %1% bots on %2% threads, %3% per second") % numClients % numThreads % rampUpPerSecond);
+
+	signal(SIGINT, OnSignal);
+	signal(SIGTERM, OnSignal);
+
+	ThreadPool.Startup();
+
+	//bots are dealt out round robin, each starting a bit after the one before
+	uint32 startMS = getMSTime();
+	sLoadStats.Start();
+	vector<BotWorker*> workers;
+	for (uint32 i=0;i<numThreads;i++)
+		workers.push_back(new BotWorker(i,settings));
+	for (uint32 i=0;i<numClients;i++)
+		workers[i % numThreads]->AddBot(i,startMS + uint32(uint64(i)*1000/rampUpPerSecond));
+	for (uint32 i=0;i<numThreads;i++)
+		ThreadPool.ExecuteTask(workers[i]);
+
+	uint32 lastReportMS = startMS;
+	for (;;)
+	{
+		Sleep(100);
+
+		bool allFinished = true;
+		for (uint32 i=0;i<numThreads;i++)
+		{
+			if (stopEvent)
+				workers[i]->Terminate();
+			if (!workers[i]->IsFinished())
+				allFinished = false;
+		}
+		if (allFinished)
+			break;
+
+		uint32 currMS = getMSTime();
+		if (currMS - lastReportMS >= reportIntervalMS)
+		{
+			lastReportMS = currMS;
+			INFO_LOG(sLoadStats.Report());
+		}
+	}
+
+	INFO_LOG(sLoadStats.Report());
+
+	for (uint32 i=0;i<numThreads;i++)
+		delete workers[i];
+	workers.clear();
+
+	signal(SIGINT, 0);
+	signal(SIGTERM, 0);
+
+	ThreadPool.Shutdown();
+	return 0;
+}
@@ -0,0 +1,129 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#include "ReplayLog.h"
+#include "MessageTypes.h"
+#include "Log.h"
+
+bool ReplayLog::Load( const string &fileName )
+{
+	ifstream replayStream(fileName.c_str());
+	if (!replayStream.is_open())
+	{
+		CRITICAL_LOG(format("Could not open replay file %1%") % fileName);
+		return false;
+	}
+
+	//"<ms since the first packet> <payload in hex>" per line
+	m_packets.clear();
+	m_seenCommands.clear();
+	uint32 lineNum = 0;
+	string line;
+	while (getline(replayStream,line))
+	{
+		lineNum++;
+		if (line.length() < 1 || line[0] == '#' || line[0] == '\r')
+			continue;
+
+		stringstream lineParser(line);
+		uint32 atMS;
+		string payloadHex;
+		lineParser >> atMS >> payloadHex;
+		if (lineParser.fail())
+		{
+			WARNING_LOG(format("%1%:%2%: malformed line skipped") % fileName % lineNum);
+			continue;
+		}
+
+		string payload;
+		CryptoPP::StringSource(payloadHex, true, new CryptoPP::HexDecoder(new CryptoPP::StringSink(payload)));
+
+		Packet packet;
+		packet.atMS = atMS;
+		if (!ParsePayload(payload,packet))
+		{
+			WARNING_LOG(format("%1%:%2%: payload isn't a client world packet, skipped") % fileName % lineNum);
+			continue;
+		}
+
+		//acks and resends only, the bots do their own
+		if (packet.state.size() == 0 && packet.commands.empty() && packet.trailingState.size() == 0)
+			continue;
+
+		m_packets.push_back(packet);
+	}
+
+	if (m_packets.empty())
+	{
+		CRITICAL_LOG(format("Replay file %1% has no packets") % fileName);
+		return false;
+	}
+
+	INFO_LOG(format("Loaded %1% packets (%2% seconds) to replay from %3%") % m_packets.size() % (GetLengthMS()/1000) % fileName);
+	return true;
+}
+
+bool ReplayLog::ParsePayload( const string &payload, Packet &packet )
+{
+	//client payloads always start with 02
+	if (payload.length() < 1 || uint8(payload[0]) != 0x02)
+		return false;
+
+	ByteBuffer data((const byte*)&payload[1],payload.length()-1);
+
+	//same search for the ordered block the server does
+	size_t commandOffset = data.size();
+	for (size_t i=0;i<data.size();i++)
+	{
+		if (uint8(data.contents()[i]) != 0x04)
+			continue;
+
+		data.rpos(i);
+		OrderedPacket commands;
+		if (commands.FromBuffer(data) == false)
+			continue;
+
+		//the client resends commands until they're acked, we only want them the first time
+		commandOffset = i;
+		for (list<MsgBlock>::iterator it=commands.msgBlocks.begin();it!=commands.msgBlocks.end();++it)
+		{
+			uint16 commandSeq = it->sequenceId;
+			for (list<ByteBuffer>::iterator cmd=it->subPackets.begin();cmd!=it->subPackets.end();++cmd,++commandSeq)
+			{
+				if (m_seenCommands.insert(commandSeq).second)
+					packet.commands.push_back(*cmd);
+			}
+		}
+
+		if (data.remaining() > 0)
+			packet.trailingState.append(&data.contents()[data.rpos()],data.remaining());
+		break;
+	}
+
+	if (commandOffset > 0)
+		packet.state.append(data.contents(),commandOffset);
+
+	return true;
+}
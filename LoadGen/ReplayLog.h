@@ -0,0 +1,56 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_REPLAYLOG_H
+#define MXOEMU_REPLAYLOG_H
+
+#include "Common.h"
+#include "ByteBuffer.h"
+
+// A client->world session recorded by the Proxy (Session.replay), each payload split up the way
+// GameClient::HandleEncrypted splits it: the state update in front of the ordered commands, the
+// commands themselves, and whatever state trails them. Loaded once, every bot reads the same copy.
+class ReplayLog
+{
+public:
+	struct Packet
+	{
+		uint32 atMS;
+		ByteBuffer state;
+		list<ByteBuffer> commands;
+		ByteBuffer trailingState;
+	};
+
+	bool Load(const string &fileName);
+	const vector<Packet>& GetPackets() const { return m_packets; }
+	uint32 GetLengthMS() const { return m_packets.empty() ? 0 : m_packets.back().atMS; }
+private:
+	bool ParsePayload(const string &payload, Packet &packet);
+
+	vector<Packet> m_packets;
+	std::set<uint16> m_seenCommands;
+};
+
+#endif
@@ -3,6 +3,8 @@
 #include "TCPVariableLengthPacket.h"
 #include "EncryptedPacket.h"
 #include "SequencedPacket.h"
+#include <windows.h>
+#include <iomanip>
 
 #pragma pack(1)
 
@@ -74,6 +76,30 @@ void LogWorldPacket(const char *pData,size_t pSize,PacketDirection direction,uin
 	LogPacket(pData,pSize,direction,comment.str());
 }
 
+//decrypted client->world payloads with the ms they came in at, what LoadGen's replay mode plays back
+void LogReplayPacket(const char *pData,size_t pSize)
+{
+	static DWORD replayStartTime = 0;
+	std::ofstream File;
+	if (replayStartTime == 0)
+	{
+		replayStartTime = GetTickCount();
+		File.open("Session.replay",std::ios::trunc);
+		File << "# client->world payloads: ms since the first one, payload in hex" << endl;
+	}
+	else
+	{
+		File.open("Session.replay",std::ios::app);
+	}
+
+	std::ostringstream hexStr;
+	for (size_t i=0;i<pSize;i++)
+		hexStr << std::hex << std::setw(2) << std::setfill('0') << (int)(byte)pData[i];
+
+	File << (GetTickCount() - replayStartTime) << " " << hexStr.str() << endl;
+	File.close();
+}
+
 void LogString(string &title,string &contents)
 {
 	char dateStr [9];
@@ -1357,6 +1383,7 @@ string ClientToWorld( const char* pData,size_t pSize )
 		CTW_flags = headerless.getPSS();
 
 		LogWorldPacket(headerless.contents(),headerless.size(),CLIENT_TO_WORLD,CTW_localSeq,CTW_remoteSeq,CTW_flags);
+		LogReplayPacket(headerless.contents(),headerless.size());
 
 		//reencrypt
 		ByteBuffer reencrypted = encryptionless.toCipherText(TFEncryptCTW);
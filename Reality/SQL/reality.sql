@@ -75,7 +75,8 @@ CREATE TABLE `hardlines` (
   `ROT` double NOT NULL,
   `DistrictId` smallint(6) unsigned NOT NULL,
   PRIMARY KEY (`Id`),
-  UNIQUE KEY `Id` (`Id`)
+  UNIQUE KEY `Id` (`Id`),
+  UNIQUE KEY `DistrictHardline` (`DistrictId`,`HardLineId`)
 ) ENGINE=MyISAM AUTO_INCREMENT=139 DEFAULT CHARSET=utf8;
 
 -- ----------------------------
@@ -101,7 +102,8 @@ CREATE TABLE `locations` (
   `Z` double NOT NULL,
   `District` tinyint(3) unsigned NOT NULL,
   PRIMARY KEY (`Id`),
-  UNIQUE KEY `Id` (`Id`)
+  UNIQUE KEY `Id` (`Id`),
+  UNIQUE KEY `DistrictCommand` (`District`,`Command`)
 ) ENGINE=MyISAM AUTO_INCREMENT=62 DEFAULT CHARSET=utf8;
 
 -- ----------------------------
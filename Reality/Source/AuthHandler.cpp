@@ -24,13 +24,75 @@
 // ***************************************************************************
 
 #include "AuthHandler.h"
+#include "Common.h"
+#include "AuthSocket.h"
+#include "ListenerShards.h"
 
-AuthHandler::AuthHandler()
-:SocketHandler()
+AuthHandler::AuthHandler(uint32 shardIndex)
+:SocketHandler(), m_shardIndex(shardIndex), m_lastMetricsMS(0)
 {
+	m_cryptoCompletions.reset(new CryptoCompletionQueue);
+
+	//crypto workers poke this so Select returns as soon as a job is done
+	m_wakeup = new ShardWakeupSocket(*this);
+	m_wakeup->SetDeleteByHandler();
+	Add(m_wakeup);
+	m_cryptoCompletions->SetWakeup(boost::bind(&ShardWakeupSocket::Wake,m_wakeup));
 }
 
 
 AuthHandler::~AuthHandler()
 {
-}
\ No newline at end of file
+	m_cryptoCompletions->Close();
+}
+
+void AuthHandler::Loop()
+{
+	m_cryptoCompletions->Drain();
+	Select(0, 100000);                      // 100 ms
+
+	if (MetricsPublishDue(m_lastMetricsMS))
+		PublishMetrics();
+}
+
+void AuthHandler::PublishMetrics()
+{
+	string labels = (format("server=\"auth\",shard=\"%1%\"") % m_shardIndex).str();
+	PublishThreadMetrics(labels,&m_traffic);
+
+	//the listener and the wakeup socket are two of the sockets
+	size_t sockets = GetCount();
+	sMetrics.SetGauge("reality_clients","Clients connected to the server.",double(sockets > 2 ? sockets-2 : 0),labels);
+}
+
+class AuthSocket *AuthHandler::FindByUniqueId( socketuid_t uid )
+{
+	for (socket_m::iterator it = m_sockets.begin(); it != m_sockets.end(); it++)
+	{
+		Socket *p = it->second;
+		if (p == NULL || p->UniqueIdentifier() != uid)
+			continue;
+
+		return dynamic_cast<AuthSocket *>(p);
+	}
+	return NULL;
+}
+
+void AuthHandler::OnAuthBlobDecrypted( socketuid_t sockId, CryptoJob &decryptJob )
+{
+	//socket might have disconnected while the job was running
+	AuthSocket *theSocket = FindByUniqueId(sockId);
+	if (theSocket == NULL)
+		return;
+
+	theSocket->HandleAuthBlob(decryptJob);
+}
+
+void AuthHandler::OnAuthReplySigned( socketuid_t sockId, CryptoJob &signJob )
+{
+	AuthSocket *theSocket = FindByUniqueId(sockId);
+	if (theSocket == NULL)
+		return;
+
+	theSocket->SendAuthReply(signJob);
+}
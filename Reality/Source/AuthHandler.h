@@ -26,13 +26,35 @@
 #ifndef MXOSIM_AUTHHANDLER_H
 #define MXOSIM_AUTHHANDLER_H
 
+#include "Common.h"
+#include "CryptoWorkerPool.h"
+#include "Metrics.h"
 #include <Sockets/SocketHandler.h>
+#include <Sockets/socket_include.h>
 
+// One auth server shard: its sockets, and the crypto results coming back for them
 class AuthHandler : public SocketHandler
 {
 public:
-	AuthHandler();
+	AuthHandler(uint32 shardIndex);
 	~AuthHandler();
+
+	uint32 GetShardIndex() { return m_shardIndex; }
+	void Loop();
+	TrafficCounters &GetTraffic() { return m_traffic; }
+	class AuthSocket *FindByUniqueId(socketuid_t uid);
+
+	shared_ptr<CryptoCompletionQueue> GetCryptoCompletions() { return m_cryptoCompletions; }
+	void OnAuthBlobDecrypted(socketuid_t sockId, CryptoJob &decryptJob);
+	void OnAuthReplySigned(socketuid_t sockId, CryptoJob &signJob);
+private:
+	void PublishMetrics();
+
+	uint32 m_shardIndex;
+	TrafficCounters m_traffic;
+	uint32 m_lastMetricsMS;
+	shared_ptr<CryptoCompletionQueue> m_cryptoCompletions;
+	class ShardWakeupSocket *m_wakeup;
 };
 
 #endif // _MARGINHANDLER_H
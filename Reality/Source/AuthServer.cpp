@@ -30,6 +30,7 @@
 #include "Config.h"
 #include "Database/DatabaseEnv.h"
 #include "Util.h"
+#include "Threading/Threading.h"
 
 initialiseSingleton( AuthServer );
 
@@ -341,6 +342,7 @@ void AuthServer::LoadCryptoKeys()
 string AuthServer::Encrypt(string input)
 {
 	string output;
+	Guard randGuard(m_randLock);
 	CryptoPP::StringSource(input,true, new CryptoPP::PK_EncryptorFilter(randPool, rsaEncryptor, new CryptoPP::StringSink(output)));
 	return output;
 }
@@ -348,6 +350,7 @@ string AuthServer::Encrypt(string input)
 string AuthServer::Decrypt(string input)
 {
 	string output;
+	Guard randGuard(m_randLock);
 	CryptoPP::StringSource(input,true, new CryptoPP::PK_DecryptorFilter(randPool, rsaDecryptor, new CryptoPP::StringSink(output)));
 	return output;
 }
@@ -358,7 +361,11 @@ ByteBuffer AuthServer::SignWith1024Bit( byte *message,size_t messageLen )
 	ByteBuffer signMe(message,messageLen);
 	vector<byte> signature;
 	signature.resize(signer1024bit.MaxSignatureLength());
-	size_t actualSignatureSize = signer1024bit.SignMessage(randPool,(byte*)signMe.contents(),signMe.size(),&signature[0]);
+	size_t actualSignatureSize;
+	{
+		Guard randGuard(m_randLock);
+		actualSignatureSize = signer1024bit.SignMessage(randPool,(byte*)signMe.contents(),signMe.size(),&signature[0]);
+	}
 	signature.resize(actualSignatureSize);
 
 	return ByteBuffer(signature);
@@ -388,63 +395,100 @@ ByteBuffer AuthServer::GetPubKeyData()
 
 AuthServer::AuthServer()
 {
-	listenSocketInst = NULL;
 }
 
 AuthServer::~AuthServer()
 {
-	if (listenSocketInst != NULL)
-	{
-		delete listenSocketInst;
-	}
 }
 
 void AuthServer::Start()
 {
 	LoadSignKeys();
 	LoadCryptoKeys();
+	userKeyPool.Start(sConfig.GetIntDefault("AuthServer.RSAKeyPoolSize",16));
+	sCrypto.Start(sConfig.GetIntDefault("AuthServer.CryptoWorkerCount",4),rsaDecryptor.AccessKey());
 
 	string Interface = sConfig.GetStringDefault("AuthServer.IP","0.0.0.0");
 	int Port = sConfig.GetIntDefault("AuthServer.Port",11000);
-	INFO_LOG(format("Starting Auth server on port %1%") % Port);	
+	uint32 numShards = ListenerShardLimit(sConfig.GetIntDefault("AuthServer.ThreadCount",1));
+	INFO_LOG(format("Starting Auth server on port %1% with %2% threads") % Port % numShards);	
 
-	if (listenSocketInst != NULL)
+	for (uint32 i=0;i<numShards;i++)
 	{
-		delete listenSocketInst;
-	}
-	listenSocketInst = new AuthListenSocket(authSocketHandler);
-	bool bindFailed=false;
-	try
-	{
-		if (listenSocketInst->Bind(Interface,Port)!=0)
+		AuthHandler *theHandler = new AuthHandler(i);
+		AuthListenSocket *theListener = new AuthListenSocket(*theHandler);
+		bool bindFailed=false;
+		try
+		{
+			if (theListener->Bind(Interface,Port)!=0)
+				bindFailed=true;
+		}
+		catch (Exception)
+		{
 			bindFailed=true;
+		}
+		if (bindFailed)
+		{
+			ERROR_LOG(format("Error binding AuthServer thread %1% to port %2%") % i % Port);
+			delete theListener;
+			//the first one sticks around so Loop has something to run
+			if (i == 0)
+				m_handlers.push_back(theHandler);
+			else
+				delete theHandler;
+
+			break;
+		}
+		theHandler->Add(theListener);
+		m_handlers.push_back(theHandler);
+		m_listenSockets.push_back(theListener);
 	}
-	catch (Exception)
-	{
-		bindFailed=true;
-	}
-	if (bindFailed)
+
+	//the first shard runs on the auth thread itself
+	for (uint32 i=1;i<m_handlers.size();i++)
 	{
-		ERROR_LOG(format("Error binding AuthServer to port %1%") % Port);
-		return;
+		ListenerShardThread *theThread = new ListenerShardThread((format("Auth Server Thread %1%") % i).str(),
+			boost::bind(&AuthHandler::Loop,m_handlers[i]));
+		m_shardThreads.push_back(theThread);
+		ThreadPool.ExecuteTask(theThread);
 	}
-	authSocketHandler.Add(listenSocketInst);
 }
 
 void AuthServer::Stop()
 {
 	INFO_LOG("Auth Server shutdown");
-	if (listenSocketInst != NULL)
+	for (uint32 i=0;i<m_shardThreads.size();i++)
+		m_shardThreads[i]->Terminate();
+	for (uint32 i=0;i<m_shardThreads.size();i++)
 	{
-		delete listenSocketInst;
-		listenSocketInst = NULL;
+		while (!m_shardThreads[i]->IsFinished())
+			Sleep(10);
+
+		delete m_shardThreads[i];
 	}
+	m_shardThreads.clear();
+
+	for (uint32 i=0;i<m_listenSockets.size();i++)
+		delete m_listenSockets[i];
+	m_listenSockets.clear();
+	for (uint32 i=0;i<m_handlers.size();i++)
+		delete m_handlers[i];
+	m_handlers.clear();
+
+	userKeyPool.Stop();
+	sCrypto.Stop();
 }
 
 
 void AuthServer::Loop(void)
 {
-	authSocketHandler.Select(0, 100000);                      // 100 ms
+	if (m_handlers.empty())
+	{
+		Sleep(100);
+		return;
+	}
+
+	m_handlers[0]->Loop();
 }
 
 string AuthServer::MakeSHA1HashHex( const string& input )
@@ -506,7 +550,7 @@ bool AuthServer::ChangePassword( const string& username,const string& newPass )
 	string salt = GenerateSalt(8);
 	string passwordHash = HashPassword(salt,newPass);
 
-	return sDatabase.Execute(format("UPDATE `users` SET `passwordSalt`='%1%', `passwordHash`='%2%' WHERE `userId`='%3%' LIMIT 1")
+	return sDatabase.Execute(accountId,format("UPDATE `users` SET `passwordSalt`='%1%', `passwordHash`='%2%' WHERE `userId`='%3%' LIMIT 1")
 		% sDatabase.EscapeString(salt)
 		% sDatabase.EscapeString(passwordHash)
 		% accountId );
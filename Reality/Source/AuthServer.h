@@ -31,8 +31,10 @@
 #include "AuthSocket.h"
 #include "Crypto.h"
 #include "ByteBuffer.h"
-
-#include <Sockets/ListenSocket.h>
+#include "RSAKeyPool.h"
+#include "CryptoWorkerPool.h"
+#include "ListenerShards.h"
+#include "Threading/NativeMutex.h"
 
 class AuthServer : public Singleton <AuthServer>
 {
@@ -41,6 +43,7 @@ public:
 	~AuthServer();;
 	void Start();
 	void Stop();
+	// services the first shard, the rest run on threads of their own
 	void Loop();
 	string Encrypt(string input);
 	string Decrypt(string input);
@@ -52,6 +55,7 @@ public:
 	bool ChangePassword(const string& username,const string& newPass);
 	bool CreateWorld(const string& worldName);
 	bool CreateCharacter(const string& worldName, const string& userName, const string& charHandle, const string& firstName, const string& lastName);
+	void TakeUserKey(RSAKeyPool::UserKey &keyOut) { userKeyPool.Take(keyOut); }
 private:
 	uint32 getAccountIdForUsername(const string &username);
 	uint16 getWorldIdForName(const string &worldName);
@@ -66,11 +70,16 @@ private:
 	string MakeSHA1HashHex(const string& input);
 	string GenerateSalt(uint32 length);
 
-	AuthHandler authSocketHandler;
-	typedef ListenSocket<AuthSocket> AuthListenSocket;
-	AuthListenSocket *listenSocketInst;
+	//one handler, listener and thread per shard, they share the port through SO_REUSEPORT
+	typedef ReusePortListenSocket<AuthSocket> AuthListenSocket;
+	vector<AuthHandler*> m_handlers;
+	vector<AuthListenSocket*> m_listenSockets;
+	vector<ListenerShardThread*> m_shardThreads;
 
+	//randPool is used from any shard (and the console), the key objects are only read after Start
+	NativeMutex m_randLock;
 	CryptoPP::AutoSeededRandomPool randPool;
+	RSAKeyPool userKeyPool;
 
 	CryptoPP::RSAES_OAEP_SHA_Decryptor rsaDecryptor;
 	CryptoPP::RSAES_OAEP_SHA_Encryptor rsaEncryptor;
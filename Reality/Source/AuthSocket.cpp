@@ -28,6 +28,7 @@
 #include "Util.h"
 #include "ByteBuffer.h"
 #include "AuthServer.h"
+#include "AuthHandler.h"
 #include "Log.h"
 #include "Timer.h"
 #include "TCPVariableLengthPacket.h"
@@ -40,12 +41,18 @@ AuthSocket::AuthSocket(ISocketHandler& h) : TCPVarLenSocket(h)
 	packetNum = 0;
 	memset(finalChallenge,0,sizeof(finalChallenge));
 	memset(challenge,0,sizeof(challenge));
+	m_cryptoPending = false;
 }
 
 AuthSocket::~AuthSocket()
 {
 }
 
+TrafficCounters * AuthSocket::GetTrafficCounters()
+{
+	return &GetAuthHandler().GetTraffic();
+}
+
 enum AuthOpcode
 {
 	AS_GetPublicKeyRequest = 0x06,
@@ -109,6 +116,14 @@ void AuthSocket::ProcessData( const byte *buf,size_t len )
 	packetContents >> packetOpcode;
 	AuthOpcode opcode = AuthOpcode(packetOpcode);
 
+	//the login state these work on is still in use until the crypto job that's out comes back
+	if (m_cryptoPending && (opcode == AS_AuthRequest || opcode == AS_AuthChallengeResponse))
+	{
+		WARNING_LOG(format("Auth opcode %1% while the previous request is still being processed, disconnecting.") % uint32(opcode));
+		SetCloseAndDelete(true);
+		return;
+	}
+
 	switch (opcode)
 	{
 	default:
@@ -205,19 +220,26 @@ void AuthSocket::HandleAuthRequest( ByteBuffer &packet )
 	encryptedBlob.resize(requestHeader.blobLen);
 	packet.read(&encryptedBlob[0],encryptedBlob.size());
 
-	string decryptedBlob;
+	//RSA decryption is slow, a crypto worker does it and HandleAuthBlob carries on from there
+	m_cryptoPending = true;
+	sCrypto.Decrypt(string((const char*)&encryptedBlob[0],encryptedBlob.size()),
+		boost::bind(&AuthHandler::OnAuthBlobDecrypted,&GetAuthHandler(),UniqueIdentifier(),_1),
+		GetAuthHandler().GetCryptoCompletions());
+}
 
-	try
-	{
-		decryptedBlob = sAuth.Decrypt(string((const char*)&encryptedBlob[0],encryptedBlob.size()));
-	}
-	catch (CryptoPP::InvalidCiphertext)
+void AuthSocket::HandleAuthBlob( CryptoJob &decryptJob )
+{
+	m_cryptoPending = false;
+
+	if (decryptJob.success == false)
 	{
 		ERROR_LOG("Invalid RSA ciphertext, client used bad pubkey.dat, disconnecting.");
 		SetCloseAndDelete(true);
 		return;
 	}
 
+	const string &decryptedBlob = decryptJob.output;
+
 	DEBUG_LOG(format("Got encrypted Blob: |%1%|") % Bin2Hex(decryptedBlob));
 
 	ByteBuffer rsaBlobBuffer(decryptedBlob.substr(sizeof(byte)));
@@ -428,30 +450,15 @@ void AuthSocket::HandleAuthChallengeResponse( ByteBuffer &packet )
 	{
 		INFO_LOG(format("Invalid RSA keys for user %1%, regenerating.") % m_username );
 
-		for (;;)
-		{
-			//generate RSA keypair for client
-			CryptoPP::AutoSeededRandomPool randPool;
-			CryptoPP::InvertibleRSAFunction params;
-			params.GenerateRandomWithKeySize( randPool, 768 );
-			CryptoPP::RSA::PublicKey userPubKey(params);
-			CryptoPP::RSA::PrivateKey userPrivKey(params);
-			m_publicExponent = uint16(userPubKey.GetPublicExponent().ConvertToLong()); 
-			byte tempBuf[96];
-			userPubKey.GetModulus().Encode(tempBuf,sizeof(tempBuf));
-			m_publicModulus = string((const char*)tempBuf,sizeof(tempBuf));
-			m_privateExponent.clear();
-			CryptoPP::StringSink privateExponentSink(m_privateExponent);
-			userPrivKey.GetPrivateExponent().Encode(privateExponentSink,userPrivKey.GetPrivateExponent().MinEncodedSize());
-
-			if (m_publicExponent == 17 && m_publicModulus.size() == 96 && m_privateExponent.size() == 96)
-			{
-				break;
-			}
-		}
+		//RSA keypair for client comes ready made from the pool
+		RSAKeyPool::UserKey userKey;
+		sAuth.TakeUserKey(userKey);
+		m_publicExponent = userKey.publicExponent;
+		m_publicModulus = userKey.publicModulus;
+		m_privateExponent = userKey.privateExponent;
 
 		//update db info
-		sDatabase.Execute(format("UPDATE `users` SET `publicExponent` = %1%, `publicModulus` = %2%, `privateExponent` = %3% WHERE `userId` = %4%") 
+		sDatabase.Execute(m_userId,format("UPDATE `users` SET `publicExponent` = %1%, `publicModulus` = %2%, `privateExponent` = %3% WHERE `userId` = %4%") 
 			% m_publicExponent
 			% Bin2Hex(m_publicModulus,BIN2HEX_ZEROES)
 			% Bin2Hex(m_privateExponent,BIN2HEX_ZEROES)
@@ -476,7 +483,30 @@ void AuthSocket::HandleAuthChallengeResponse( ByteBuffer &packet )
 	md5Object.Update((const byte*)&signedData,sizeof(signedData));
 	byte signMePlease[16];
 	md5Object.Final(signMePlease);
-	ByteBuffer signature = sAuth.SignWith1024Bit(signMePlease,sizeof(signMePlease));
+
+	//signing happens on a crypto worker, SendAuthReply finishes up once it's done
+	//with the data that was signed, which travels along with the job
+	m_cryptoPending = true;
+	sCrypto.Sign(signMePlease,sizeof(signMePlease),
+		boost::bind(&AuthHandler::OnAuthReplySigned,&GetAuthHandler(),UniqueIdentifier(),_1),
+		GetAuthHandler().GetCryptoCompletions(),
+		string((const char*)&signedData,sizeof(signedData)));
+}
+
+void AuthSocket::SendAuthReply( CryptoJob &signJob )
+{
+	m_cryptoPending = false;
+
+	if (signJob.success == false || signJob.context.size() != sizeof(signedDataStruct))
+	{
+		ERROR_LOG(format("Signing auth data for user %1% failed, disconnecting.") % m_username);
+		SetCloseAndDelete(true);
+		return;
+	}
+
+	ByteBuffer signature(signJob.output);
+	signedDataStruct signedData;
+	memcpy(&signedData,signJob.context.data(),sizeof(signedData));
 
 	//the encrypted data is the private exponent of user's RSA key
 	//to encrypt 96 byte exponent, use auth_key as key and challenge as IV
@@ -30,13 +30,23 @@
 #include "Common.h"
 #include "Crypto.h"
 #include "SymmetricCrypto.h"
+#include "SignedDataStruct.h"
+#include "CryptoWorkerPool.h"
 
 class AuthSocket : public TCPVarLenSocket
 {
 public:
 	AuthSocket(ISocketHandler& );
 	~AuthSocket();
+
+	//continuations of the handlers below, once the crypto workers are done
+	void HandleAuthBlob(CryptoJob &decryptJob);
+	void SendAuthReply(CryptoJob &signJob);
 private:
+	//the shard this socket belongs to
+	class AuthHandler &GetAuthHandler() { return (class AuthHandler&)Handler(); }
+	TrafficCounters *GetTrafficCounters();
+
 	void HandleGetPublicKeyRequest(ByteBuffer &packet);
 	void HandleAuthRequest(ByteBuffer &packet);
 	void HandleAuthChallengeResponse(ByteBuffer &packet);
@@ -62,6 +72,8 @@ private:
 	string m_publicModulus;
 	string m_privateExponent;
 	uint32 m_timeCreated;
+	//a decrypt or sign for this socket is on a crypto worker
+	bool m_cryptoPending;
 };
 
 
@@ -0,0 +1,158 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#include "AuthTicketCache.h"
+#include "Crypto.h"
+#include "Util.h"
+#include "Timer.h"
+
+// lives for the whole process, like the session registry
+createFileSingleton( AuthTicketCache );
+
+AuthTicketCache::AuthTicketCache()
+{
+	m_capacity = 1024;
+	m_hits = 0;
+	m_misses = 0;
+	m_expired = 0;
+	m_evicted = 0;
+}
+
+AuthTicketCache::~AuthTicketCache()
+{
+}
+
+void AuthTicketCache::SetCapacity( size_t capacity )
+{
+	m_lock.Acquire();
+	m_capacity = capacity;
+	Trim();
+	m_lock.Release();
+}
+
+string AuthTicketCache::MakeKey( const byte *digest, size_t digestLen, const byte *signature, size_t signatureLen )
+{
+	CryptoPP::Weak::MD5 md5Object;
+	md5Object.Update(digest,digestLen);
+	md5Object.Update(signature,signatureLen);
+	byte keyBytes[16];
+	md5Object.Final(keyBytes);
+
+	return string((const char*)keyBytes,sizeof(keyBytes));
+}
+
+bool AuthTicketCache::IsVerified( const byte *digest, size_t digestLen, const byte *signature, size_t signatureLen )
+{
+	string theKey = MakeKey(digest,digestLen,signature,signatureLen);
+
+	m_lock.Acquire();
+	ticketMap::iterator it = m_tickets.find(theKey);
+	if (it == m_tickets.end())
+	{
+		m_misses++;
+		m_lock.Release();
+		return false;
+	}
+
+	if (it->second->second < getTime())
+	{
+		m_lru.erase(it->second);
+		m_tickets.erase(it);
+		m_expired++;
+		m_misses++;
+		m_lock.Release();
+		return false;
+	}
+
+	//move to the front of the line
+	m_lru.splice(m_lru.begin(),m_lru,it->second);
+	m_hits++;
+	m_lock.Release();
+	return true;
+}
+
+void AuthTicketCache::AddVerified( const byte *digest, size_t digestLen, const byte *signature, size_t signatureLen, uint32 expiryTime )
+{
+	string theKey = MakeKey(digest,digestLen,signature,signatureLen);
+
+	m_lock.Acquire();
+	if (m_capacity == 0)
+	{
+		m_lock.Release();
+		return;
+	}
+
+	ticketMap::iterator it = m_tickets.find(theKey);
+	if (it != m_tickets.end())
+	{
+		it->second->second = expiryTime;
+		m_lru.splice(m_lru.begin(),m_lru,it->second);
+	}
+	else
+	{
+		m_lru.push_front(ticketEntry(theKey,expiryTime));
+		m_tickets[theKey] = m_lru.begin();
+		Trim();
+	}
+	m_lock.Release();
+}
+
+void AuthTicketCache::Trim()
+{
+	while (m_tickets.size() > m_capacity)
+	{
+		m_tickets.erase(m_lru.back().first);
+		m_lru.pop_back();
+		m_evicted++;
+	}
+}
+
+uint64 AuthTicketCache::GetHits()
+{
+	m_lock.Acquire();
+	uint64 hits = m_hits;
+	m_lock.Release();
+	return hits;
+}
+
+uint64 AuthTicketCache::GetMisses()
+{
+	m_lock.Acquire();
+	uint64 misses = m_misses;
+	m_lock.Release();
+	return misses;
+}
+
+string AuthTicketCache::GetStats()
+{
+	stringstream out;
+
+	m_lock.Acquire();
+	out << format("%1%/%2% tickets cached. %3% hits, %4% misses, %5% expired, %6% evicted")
+		% m_tickets.size() % m_capacity % m_hits % m_misses % m_expired % m_evicted << std::endl;
+	m_lock.Release();
+
+	return out.str();
+}
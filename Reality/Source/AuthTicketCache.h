@@ -0,0 +1,74 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_AUTHTICKETCACHE_H
+#define MXOEMU_AUTHTICKETCACHE_H
+
+#include "Common.h"
+#include "Singleton.h"
+#include "Threading/NativeMutex.h"
+
+// Auth tickets (the signed data the auth server hands out) whose signature the margin server already checked.
+// Clients come back to margin with the same ticket until it expires, so a ticket that's been verified once
+// skips the RSA verification after that.
+// Entries are keyed by a digest of the signed data's md5 together with the signature, so a known signature
+// with anything else attached to it still misses. The least recently used ticket goes when the cache is full,
+// and an entry is dropped once its ticket expires.
+class AuthTicketCache : public Singleton<AuthTicketCache>
+{
+public:
+	AuthTicketCache();
+	~AuthTicketCache();
+
+	void SetCapacity(size_t capacity);
+
+	bool IsVerified(const byte *digest, size_t digestLen, const byte *signature, size_t signatureLen);
+	void AddVerified(const byte *digest, size_t digestLen, const byte *signature, size_t signatureLen, uint32 expiryTime);
+
+	uint64 GetHits();
+	uint64 GetMisses();
+	string GetStats();
+private:
+	static string MakeKey(const byte *digest, size_t digestLen, const byte *signature, size_t signatureLen);
+	void Trim();
+
+	typedef std::pair<string,uint32> ticketEntry; //key, expiry time
+	typedef list<ticketEntry> ticketList;
+	typedef unordered_map<string,ticketList::iterator> ticketMap;
+
+	NativeMutex m_lock;
+	ticketList m_lru; //most recently used first
+	ticketMap m_tickets;
+	size_t m_capacity;
+
+	uint64 m_hits;
+	uint64 m_misses;
+	uint64 m_expired;
+	uint64 m_evicted;
+};
+
+#define sTickets AuthTicketCache::getSingleton()
+
+#endif
@@ -104,6 +104,8 @@ typedef unsigned char byte;
 #define snprintf sprintf_s
 #endif
 #define atoll __atoi64
+#define strtoll _strtoi64
+#define strtoull _strtoui64
 #else
 #define stricmp strcasecmp
 #define strnicmp strncasecmp
@@ -25,80 +25,121 @@
 
 #include "Common.h"
 #include "Config.h"
+#include "Log.h"
 #include "DotConfPP/dotconfpp.h"
 
 createFileSingleton(Config);
 
-Config::Config() : mConf(0)
+Config::Config() : m_ignoreCase(true), m_generation(0)
 {
 }
 
 
 Config::~Config()
 {
-    if (mConf)
-        delete mConf;
 }
 
 
-bool Config::SetSource(const char *file, bool ignorecase)
+bool Config::Parse(const char *file, bool ignorecase, valueMap &values)
 {
-    mConf = new DOTCONFDocument(ignorecase ?
+    DOTCONFDocument theDoc(ignorecase ?
         DOTCONFDocument::CASEINSENSETIVE :
     DOTCONFDocument::CASESENSETIVE);
 
-    if (mConf->setContent(file) == -1)
-    {
-        delete mConf;
-        mConf = 0;
+    if (theDoc.setContent(file) == -1)
         return false;
+
+    for (const DOTCONFDocumentNode *node = theDoc.getFirstNode(); node != NULL; node = node->getNextNode())
+    {
+        if (node->getParentNode() != NULL || node->getValue() == NULL)
+            continue;
+
+        std::string name = node->getName();
+        if (ignorecase)
+            std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+        std::string value = node->getValue(0);
+        for (int i=1; node->getValue(i) != NULL; i++)
+            value += std::string(" ") + node->getValue(i);
+
+        // first one wins, same as findNode did
+        values.insert(std::make_pair(name, value));
     }
 
     return true;
 }
 
 
-bool Config::GetString(const char* name, std::string *value)
+bool Config::SetSource(const char *file, bool ignorecase)
 {
-    if(!mConf)
-        return false;
+    m_file = file;
+    m_ignoreCase = ignorecase;
+    return Reload();
+}
+
 
-    DOTCONFDocumentNode *node = (DOTCONFDocumentNode *)mConf->findNode(name);
-    if(!node || !node->getValue())
+bool Config::Reload()
+{
+    valueMap newValues;
+    if (!Parse(m_file.c_str(), m_ignoreCase, newValues))
+    {
+        // nothing to keep on the first load, the caller reports that one
+        if (m_generation > 0)
+            ERROR_LOG(format("Could not reload %1%, keeping the current settings") % m_file);
         return false;
+    }
+
+    m_lock.Acquire();
+    m_values.swap(newValues);
+    m_generation++;
+    m_lock.Release();
 
-    *value = node->getValue();
+    if (m_generation > 1)
+        INFO_LOG(format("Reloaded %1% (%2% settings)") % m_file % m_values.size());
 
     return true;
 }
 
 
-std::string Config::GetStringDefault(const char* name, const char* def)
+bool Config::Find(const char* name, std::string &value)
 {
-    if(!mConf)
-		return std::string(def);
+    std::string key = name;
+    if (m_ignoreCase)
+        std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+
+    m_lock.Acquire();
+    valueMap::const_iterator it = m_values.find(key);
+    bool found = (it != m_values.end());
+    if (found)
+        value = it->second;
+    m_lock.Release();
+
+    return found;
+}
 
-    DOTCONFDocumentNode *node = (DOTCONFDocumentNode *)mConf->findNode(name);
-    if(!node || !node->getValue())
-		return std::string(def);
 
-	return std::string(node->getValue());
+bool Config::GetString(const char* name, std::string *value)
+{
+    return Find(name, *value);
 }
 
 
-bool Config::GetBool(const char* name, bool *value)
+std::string Config::GetStringDefault(const char* name, const char* def)
 {
-    if(!mConf)
-        return false;
+    std::string val;
+    return GetString(name, &val) ? val : std::string(def);
+}
 
-    DOTCONFDocumentNode *node = (DOTCONFDocumentNode *)mConf->findNode(name);
-    if(!node || !node->getValue())
+
+bool Config::GetBool(const char* name, bool *value)
+{
+    std::string str;
+    if (!Find(name, str))
         return false;
 
-    const char* str = node->getValue();
-    if(strcmp(str, "true") == 0 || strcmp(str, "TRUE") == 0 ||
-        strcmp(str, "yes") == 0 || strcmp(str, "YES") == 0 ||
-        strcmp(str, "1") == 0)
+    if(str == "true" || str == "TRUE" ||
+        str == "yes" || str == "YES" ||
+        str == "1")
     {
         *value = true;
     }
@@ -118,14 +159,11 @@ bool Config::GetBoolDefault(const char* name, const bool def)
 
 bool Config::GetInt(const char* name, int *value)
 {
-    if(!mConf)
+    std::string str;
+    if (!Find(name, str))
         return false;
 
-    DOTCONFDocumentNode *node = (DOTCONFDocumentNode *)mConf->findNode(name);
-    if(!node || !node->getValue())
-        return false;
-
-    *value = atoi(node->getValue());
+    *value = atoi(str.c_str());
 
     return true;
 }
@@ -133,14 +171,11 @@ bool Config::GetInt(const char* name, int *value)
 
 bool Config::GetFloat(const char* name, float *value)
 {
-    if(!mConf)
-        return false;
-
-    DOTCONFDocumentNode *node = (DOTCONFDocumentNode *)mConf->findNode(name);
-    if(!node || !node->getValue())
+    std::string str;
+    if (!Find(name, str))
         return false;
 
-    *value = (float)atof(node->getValue());
+    *value = (float)atof(str.c_str());
 
     return true;
 }
@@ -27,6 +27,7 @@
 #define MXOSIM_CONFIG_H
 
 #include "Singleton.h"
+#include "Threading/NativeMutex.h"
 #include <string>
 
 class Config : public Singleton<Config>
@@ -36,6 +37,11 @@ class Config : public Singleton<Config>
         ~Config();
 
         bool SetSource(const char *file, bool ignorecase = true);
+        // Parses the file again and swaps all settings at once, keeps the old ones if it doesn't parse.
+        // Settings only read at startup (ports, thread counts) still need a restart.
+        bool Reload();
+        // Goes up every time the settings change, cached lookups check it
+        uint32 GetGeneration() const { return m_generation; }
 
 		bool GetString(const char* name, std::string *value);
 		std::string GetStringDefault(const char* name, const char* def);
@@ -49,9 +55,84 @@ class Config : public Singleton<Config>
         bool GetFloat(const char* name, float *value);
         float GetFloatDefault(const char* name, const float def);
 
+        // same as the above, for ConfigValue
+        bool Get(const char* name, std::string *value) { return GetString(name, value); }
+        bool Get(const char* name, bool *value) { return GetBool(name, value); }
+        bool Get(const char* name, int *value) { return GetInt(name, value); }
+        bool Get(const char* name, float *value) { return GetFloat(name, value); }
+
     private:
-        class DOTCONFDocument *mConf;
+        typedef unordered_map<std::string,std::string> valueMap;
+        // every top level setting in the file, with all its values joined by spaces
+        static bool Parse(const char *file, bool ignorecase, valueMap &values);
+        bool Find(const char* name, std::string &value);
+
+        std::string m_file;
+        bool m_ignoreCase;
+        valueMap m_values;
+        NativeMutex m_lock;
+        volatile uint32 m_generation;
 };
 
 #define sConfig Config::getSingleton()
+
+// One setting looked up once and cached until the config is reloaded, for things read all the time.
+// Fine as a static, it doesn't touch the config until the first Get.
+template <typename T>
+class ConfigValue
+{
+public:
+	ConfigValue(const char *name, const T &def) : m_name(name), m_default(def), m_value(def), m_generation(0) {}
+
+	T Get()
+	{
+		if (m_generation != sConfig.GetGeneration())
+			Refresh();
+		return m_value;
+	}
+private:
+	void Refresh()
+	{
+		//a reload between here and the lookup just means another refresh next time
+		uint32 currGeneration = sConfig.GetGeneration();
+		T theValue = m_default;
+		sConfig.Get(m_name, &theValue);
+		m_value = theValue;
+		m_generation = currGeneration;
+	}
+
+	const char *m_name;
+	T m_default;
+	volatile T m_value;
+	volatile uint32 m_generation;
+};
+
+// Strings can't be swapped under a reader, those get copied out under a lock
+template <>
+class ConfigValue<std::string>
+{
+public:
+	ConfigValue(const char *name, const std::string &def) : m_name(name), m_default(def), m_value(def), m_generation(0) {}
+
+	std::string Get()
+	{
+		m_lock.Acquire();
+		if (m_generation != sConfig.GetGeneration())
+		{
+			m_generation = sConfig.GetGeneration();
+			m_value = m_default;
+			sConfig.Get(m_name, &m_value);
+		}
+		std::string theValue = m_value;
+		m_lock.Release();
+		return theValue;
+	}
+private:
+	const char *m_name;
+	std::string m_default;
+	std::string m_value;
+	uint32 m_generation;
+	NativeMutex m_lock;
+};
+
 #endif
@@ -27,10 +27,15 @@
 #include "Log.h"
 #include "ConsoleThread.h"
 #include "Util.h"
+#include "Config.h"
 #include "Master.h"
 #include "Crypto.h"
 #include "GameServer.h"
 #include "AuthServer.h"
+#include "Database/DatabaseEnv.h"
+#include "AuthTicketCache.h"
+#include "TickProfiler.h"
+#include "NetImpairment.h"
 
 #include <boost/algorithm/string.hpp>
 using boost::iequals;
@@ -117,6 +122,70 @@ bool ConsoleThread::run()
 				% charHandle % worldName % userName % firstName % lastName );
 
 		}
+		else if (iequals(command, "dbStats"))
+		{
+			cout << sDatabase.GetPoolStats();
+			cout << sDatabase.GetExecutorStats();
+		}
+		else if (iequals(command, "ticketStats"))
+		{
+			cout << sTickets.GetStats();
+		}
+		else if (iequals(command, "reloadConfig"))
+		{
+			//things that only read their settings at startup don't see the change
+			if (sConfig.Reload())
+				cout << "OK" << std::endl;
+		}
+		else if (iequals(command, "loopStats"))
+		{
+			if (GameServer::getSingletonPtr() != NULL)
+				cout << sGame.GetLoopStats() << std::endl;
+		}
+		else if (iequals(command, "tickProfile"))
+		{
+			//each dump covers the time since the previous one
+			static TickProfiler::Baseline consoleBaseline;
+			cout << sTickProfiler.Report(consoleBaseline);
+		}
+		else if (iequals(command, "impair"))
+		{
+			//impair <ip[:port]|all> off, or impair <ip[:port]|all> latency=100 jitter=20 loss=2 ...
+			string theLine;
+			getline(cin,theLine);
+			stringstream lineParser;
+			lineParser.str(theLine);
+			string target;
+			lineParser >> target;
+
+			if (target.length() < 1)
+			{
+				cout << sImpairment.GetStatus() << std::endl;
+				continue;
+			}
+
+			ImpairmentProfile theProfile;
+			bool clear = false, valid = true;
+			string setting;
+			while (lineParser >> setting)
+			{
+				size_t equalsPos = setting.find('=');
+				if (iequals(setting, "off"))
+					clear = true;
+				else if (equalsPos == string::npos || !theProfile.Set(setting.substr(0,equalsPos),setting.substr(equalsPos+1)))
+					valid = false;
+			}
+
+			if (!valid)
+				WARNING_LOG("Usage: impair <ip[:port]|all> off|latency= jitter= loss= burstEnter= burstExit= burstLoss= duplicate= reorder= reorderDelay=");
+			else if (clear || !theProfile.IsActive())
+				sImpairment.ClearProfile(target);
+			else
+				sImpairment.SetProfile(target,theProfile);
+
+			if (valid)
+				cout << "OK" << std::endl;
+		}
 		else if (iequals(command, "broadcastMsg") || iequals(command, "modalMsg"))
 		{
 			string theAnnouncement;
@@ -0,0 +1,339 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#include "Common.h"
+#include "CryptoWorkerPool.h"
+#include "Threading/Threading.h"
+#include "Log.h"
+#include "Util.h"
+
+createFileSingleton( CryptoWorkerPool );
+
+CryptoCompletionQueue::~CryptoCompletionQueue()
+{
+	Close();
+}
+
+void CryptoCompletionQueue::SetWakeup( Wakeup wakeup )
+{
+	m_lock.Acquire();
+	m_wakeup = wakeup;
+	m_lock.Release();
+}
+
+void CryptoCompletionQueue::Post( CryptoJob *job )
+{
+	m_lock.Acquire();
+	if (m_closed)
+	{
+		m_lock.Release();
+		delete job;
+		return;
+	}
+	bool wasEmpty = m_completed.empty();
+	m_completed.push_back(job);
+	if (wasEmpty && !m_wakeup.empty())
+		m_wakeup();
+	m_lock.Release();
+}
+
+size_t CryptoCompletionQueue::Drain()
+{
+	deque<CryptoJob*> toRun;
+	m_lock.Acquire();
+	toRun.swap(m_completed);
+	m_lock.Release();
+
+	for (deque<CryptoJob*>::iterator it=toRun.begin();it!=toRun.end();++it)
+	{
+		if (!(*it)->callback.empty())
+			(*it)->callback(**it);
+
+		delete *it;
+	}
+
+	return toRun.size();
+}
+
+void CryptoCompletionQueue::Close()
+{
+	m_lock.Acquire();
+	m_closed = true;
+	m_wakeup.clear();
+	while (m_completed.size() > 0)
+	{
+		delete m_completed.front();
+		m_completed.pop_front();
+	}
+	m_lock.Release();
+}
+
+CryptoWorkerPool::WorkerState::WorkerState( const CryptoPP::RSA::PrivateKey &privateKey )
+	: signer(privateKey), verifier(CryptoPP::RSA::PublicKey(privateKey)), decryptor(privateKey)
+{
+}
+
+CryptoWorkerPool::CryptoWorkerPool() : m_cond(&m_lock)
+{
+	m_haveKey = false;
+	m_stopping = false;
+	m_numWorkers = 0;
+	m_workersRunning = 0;
+	m_jobsDone = 0;
+}
+
+CryptoWorkerPool::~CryptoWorkerPool()
+{
+	Stop();
+}
+
+void CryptoWorkerPool::Start( uint32 numWorkers, const CryptoPP::RSA::PrivateKey &privateKey )
+{
+	m_cond.BeginSynchronized();
+	if (m_workersRunning > 0)
+	{
+		m_cond.EndSynchronized();
+		ERROR_LOG("Crypto worker pool already started");
+		return;
+	}
+	m_privateKey = privateKey;
+	m_haveKey = true;
+	m_inlineLock.Acquire();
+	m_inlineState.reset();
+	m_inlineLock.Release();
+	m_stopping = false;
+	m_numWorkers = numWorkers;
+	m_workersRunning = numWorkers;
+	m_cond.EndSynchronized();
+
+	for (uint32 i=0;i<numWorkers;i++)
+		ThreadPool.ExecuteTask(new CryptoWorkerThread(this,i));
+
+	//anything submitted before we had a key to work with
+	m_cond.BeginSynchronized();
+	if (numWorkers > 0)
+	{
+		m_cond.Broadcast();
+		m_cond.EndSynchronized();
+	}
+	else
+	{
+		deque<CryptoJob*> early;
+		early.swap(m_jobs);
+		m_cond.EndSynchronized();
+
+		for (deque<CryptoJob*>::iterator it=early.begin();it!=early.end();++it)
+			RunInline(*it);
+	}
+
+	INFO_LOG(format("Crypto worker pool started with %1% workers") % numWorkers);
+}
+
+void CryptoWorkerPool::Stop()
+{
+	m_cond.BeginSynchronized();
+	m_stopping = true;
+	m_cond.Broadcast();
+	while (m_workersRunning > 0)
+	{
+		m_cond.EndSynchronized();
+		Sleep(10);
+		m_cond.BeginSynchronized();
+		m_cond.Broadcast();
+	}
+	m_numWorkers = 0;
+	deque<CryptoJob*> leftover;
+	leftover.swap(m_jobs);
+	bool haveKey = m_haveKey;
+	m_cond.EndSynchronized();
+
+	//workers are gone, finish what they left behind here
+	for (deque<CryptoJob*>::iterator it=leftover.begin();it!=leftover.end();++it)
+	{
+		if (haveKey)
+			RunInline(*it);
+		else
+			delete *it;
+	}
+}
+
+void CryptoWorkerPool::Submit( CryptoJob *job )
+{
+	m_cond.BeginSynchronized();
+	if (m_numWorkers > 0 || !m_haveKey)
+	{
+		//without a key yet it waits for Start
+		m_jobs.push_back(job);
+		m_cond.Signal();
+		m_cond.EndSynchronized();
+		return;
+	}
+	m_cond.EndSynchronized();
+
+	RunInline(job);
+}
+
+void CryptoWorkerPool::Sign( const byte *message, size_t messageLen, CryptoJob::Callback callback, shared_ptr<CryptoCompletionQueue> completeOn, const string &context )
+{
+	CryptoJob *job = new CryptoJob(CryptoJob::CRYPTO_SIGN,string((const char*)message,messageLen),callback,completeOn);
+	job->context = context;
+	Submit(job);
+}
+
+void CryptoWorkerPool::Verify( const byte *message, size_t messageLen, const byte *signature, size_t signatureLen, CryptoJob::Callback callback, shared_ptr<CryptoCompletionQueue> completeOn, const string &context )
+{
+	CryptoJob *job = new CryptoJob(CryptoJob::CRYPTO_VERIFY,string((const char*)message,messageLen),callback,completeOn);
+	job->signature = string((const char*)signature,signatureLen);
+	job->context = context;
+	Submit(job);
+}
+
+void CryptoWorkerPool::Decrypt( const string &cipherText, CryptoJob::Callback callback, shared_ptr<CryptoCompletionQueue> completeOn )
+{
+	Submit(new CryptoJob(CryptoJob::CRYPTO_DECRYPT,cipherText,callback,completeOn));
+}
+
+uint32 CryptoWorkerPool::GetQueueSize()
+{
+	m_cond.BeginSynchronized();
+	uint32 queueSize = uint32(m_jobs.size());
+	m_cond.EndSynchronized();
+	return queueSize;
+}
+
+uint64 CryptoWorkerPool::GetJobsDone()
+{
+	m_cond.BeginSynchronized();
+	uint64 jobsDone = m_jobsDone;
+	m_cond.EndSynchronized();
+	return jobsDone;
+}
+
+void CryptoWorkerPool::Perform( CryptoJob *job, WorkerState &state )
+{
+	try
+	{
+		switch (job->operation)
+		{
+		case CryptoJob::CRYPTO_SIGN:
+			{
+				vector<byte> signature(state.signer.MaxSignatureLength());
+				size_t actualSignatureSize = state.signer.SignMessage(state.randPool,(const byte*)job->input.data(),job->input.size(),&signature[0]);
+				job->output = string((const char*)&signature[0],actualSignatureSize);
+				job->success = true;
+				break;
+			}
+		case CryptoJob::CRYPTO_VERIFY:
+			{
+				job->success = state.verifier.VerifyMessage((const byte*)job->input.data(),job->input.size(),
+					(const byte*)job->signature.data(),job->signature.size());
+				break;
+			}
+		case CryptoJob::CRYPTO_DECRYPT:
+			{
+				job->output.clear();
+				CryptoPP::StringSource(job->input,true,
+					new CryptoPP::PK_DecryptorFilter(state.randPool,state.decryptor,new CryptoPP::StringSink(job->output)));
+				job->success = true;
+				break;
+			}
+		}
+	}
+	catch (CryptoPP::Exception &e)
+	{
+		DEBUG_LOG(format("Crypto job failed: %1%") % e.what());
+		job->output.clear();
+		job->success = false;
+	}
+}
+
+void CryptoWorkerPool::Complete( CryptoJob *job )
+{
+	m_cond.BeginSynchronized();
+	m_jobsDone++;
+	m_cond.EndSynchronized();
+
+	if (job->completion != NULL)
+	{
+		//queue owns it from now on
+		shared_ptr<CryptoCompletionQueue> completeOn = job->completion;
+		completeOn->Post(job);
+	}
+	else
+	{
+		if (!job->callback.empty())
+			job->callback(*job);
+
+		delete job;
+	}
+}
+
+void CryptoWorkerPool::RunInline( CryptoJob *job )
+{
+	//setting up the key objects and seeding the random pool costs about as much as the job, so do it once
+	m_inlineLock.Acquire();
+	if (m_inlineState == NULL)
+		m_inlineState.reset(new WorkerState(m_privateKey));
+	Perform(job,*m_inlineState);
+	m_inlineLock.Release();
+
+	Complete(job);
+}
+
+void CryptoWorkerPool::thread_proc( uint32 index )
+{
+	WorkerState state(m_privateKey);
+
+	m_cond.BeginSynchronized();
+	for (;;)
+	{
+		if (m_jobs.empty())
+		{
+			if (m_stopping)
+				break;
+
+			m_cond.Wait();
+			continue;
+		}
+
+		CryptoJob *job = m_jobs.front();
+		m_jobs.pop_front();
+		m_cond.EndSynchronized();
+
+		Perform(job,state);
+		Complete(job);
+
+		m_cond.BeginSynchronized();
+	}
+	m_workersRunning--;
+	m_cond.EndSynchronized();
+}
+
+bool CryptoWorkerThread::run()
+{
+	SetThreadName((format("Crypto Worker %1%") % m_index).str().c_str());
+	m_pool->thread_proc(m_index);
+	return true;
+}
@@ -0,0 +1,151 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_CRYPTOWORKERPOOL_H
+#define MXOEMU_CRYPTOWORKERPOOL_H
+
+#include "Common.h"
+#include "Singleton.h"
+#include "Crypto.h"
+#include "Threading/ThreadStarter.h"
+#include "Threading/Condition.h"
+
+class CryptoCompletionQueue;
+
+// One operation with the auth server's 1024 bit RSA key.
+// Filled in by a crypto worker, then handed back to whoever submitted it.
+struct CryptoJob
+{
+	enum Operation
+	{
+		CRYPTO_SIGN,
+		CRYPTO_VERIFY,
+		CRYPTO_DECRYPT
+	};
+	typedef boost::function<void (CryptoJob&)> Callback;
+
+	CryptoJob(Operation theOperation, const string &theInput, Callback theCallback, shared_ptr<CryptoCompletionQueue> completeOn)
+		: operation(theOperation), input(theInput), success(false), callback(theCallback), completion(completeOn) {}
+
+	Operation operation;
+	string input; //message to sign or verify, or the ciphertext to decrypt
+	string signature; //what to verify the message against
+	string context; //not used by the pool, handed back to the callback as it was submitted
+
+	bool success; //signature made or valid, ciphertext decrypted
+	string output; //the signature, or the plaintext
+
+	Callback callback;
+	shared_ptr<CryptoCompletionQueue> completion;
+};
+
+// Finished CryptoJobs waiting for their owning server thread to run the callbacks.
+// Works like QueryCompletionQueue, the owner calls Drain() from its loop and Close() when it stops,
+// and can SetWakeup() to be woken when a job comes back.
+class CryptoCompletionQueue
+{
+public:
+	typedef boost::function<void ()> Wakeup;
+
+	CryptoCompletionQueue() : m_closed(false) {}
+	~CryptoCompletionQueue();
+
+	void SetWakeup(Wakeup wakeup);
+	void Post(CryptoJob *job);
+	size_t Drain();
+	void Close();
+private:
+	NativeMutex m_lock;
+	deque<CryptoJob*> m_completed;
+	bool m_closed;
+	Wakeup m_wakeup;
+};
+
+// Runs the auth server's RSA private key operations (and signature checks) on worker threads,
+// so the auth and margin threads can carry on with other clients while one is being signed/decrypted.
+// With no workers jobs run inline on the submitting thread, their callbacks still go through the completion queue.
+class CryptoWorkerPool : public Singleton<CryptoWorkerPool>
+{
+public:
+	CryptoWorkerPool();
+	~CryptoWorkerPool();
+
+	void Start(uint32 numWorkers, const CryptoPP::RSA::PrivateKey &privateKey);
+	void Stop();
+
+	void Submit(CryptoJob *job);
+	void Sign(const byte *message, size_t messageLen, CryptoJob::Callback callback, shared_ptr<CryptoCompletionQueue> completeOn, const string &context=string());
+	void Verify(const byte *message, size_t messageLen, const byte *signature, size_t signatureLen, CryptoJob::Callback callback, shared_ptr<CryptoCompletionQueue> completeOn, const string &context=string());
+	void Decrypt(const string &cipherText, CryptoJob::Callback callback, shared_ptr<CryptoCompletionQueue> completeOn);
+
+	uint32 GetQueueSize();
+	uint64 GetJobsDone();
+private:
+	friend class CryptoWorkerThread;
+	void thread_proc(uint32 index);
+
+	// every worker gets its own key objects and random pool, nothing is shared between them
+	struct WorkerState
+	{
+		WorkerState(const CryptoPP::RSA::PrivateKey &privateKey);
+
+		CryptoPP::AutoSeededRandomPool randPool;
+		CryptoPP::Weak::RSASSA_PKCS1v15_MD5_Signer signer;
+		CryptoPP::Weak::RSASSA_PKCS1v15_MD5_Verifier verifier;
+		CryptoPP::RSAES_OAEP_SHA_Decryptor decryptor;
+	};
+	static void Perform(CryptoJob *job, WorkerState &state);
+	void Complete(CryptoJob *job);
+	void RunInline(CryptoJob *job);
+
+	NativeMutex m_lock;
+	Condition m_cond;
+	deque<CryptoJob*> m_jobs;
+
+	// used by every job that runs inline, made once per key, m_inlineLock serializes its users
+	NativeMutex m_inlineLock;
+	scoped_ptr<WorkerState> m_inlineState;
+
+	CryptoPP::RSA::PrivateKey m_privateKey;
+	bool m_haveKey;
+	bool m_stopping;
+	uint32 m_numWorkers;
+	uint32 m_workersRunning;
+	uint64 m_jobsDone;
+};
+
+class CryptoWorkerThread : public ThreadContext
+{
+public:
+	CryptoWorkerThread(CryptoWorkerPool *pool, uint32 index) : ThreadContext(), m_pool(pool), m_index(index) {}
+	bool run();
+private:
+	CryptoWorkerPool *m_pool;
+	uint32 m_index;
+};
+
+#define sCrypto CryptoWorkerPool::getSingleton()
+
+#endif
@@ -0,0 +1,149 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_CRYPTOWORKERPOOLTEST_H
+#define MXOEMU_CRYPTOWORKERPOOLTEST_H
+
+#define UNITTEST
+
+#include "Common.h"
+#include "Util.h"
+#include "Timer.h"
+#include "Crypto.h"
+#include "Threading/Threading.h"
+#include "CryptoWorkerPool.h"
+
+// Logins per second through the crypto worker pool at 1, 4 and 8 workers.
+// Every login asks the pool for what the auth and margin servers need from it: decrypting the
+// client's RSA blob, signing its auth data, and checking that signature when it reaches the margin.
+// A fixed number of clients is kept in flight, and this thread drains completions the way AuthServer::Loop does.
+
+static const uint32 BENCH_LOGINS = 2000;
+static const uint32 BENCH_CLIENTS_IN_FLIGHT = 64;
+
+class CryptoBench
+{
+public:
+	CryptoBench(const string &cipherText, shared_ptr<CryptoCompletionQueue> completions)
+		: m_cipherText(cipherText), m_completions(completions), m_started(0), m_finished(0), m_failed(0)
+	{
+		memset(m_message,0xAB,sizeof(m_message));
+	}
+
+	void StartLogin()
+	{
+		m_started++;
+		sCrypto.Decrypt(m_cipherText,boost::bind(&CryptoBench::OnDecrypted,this,_1),m_completions);
+	}
+	void OnDecrypted(CryptoJob &job)
+	{
+		if (job.success == false)
+			m_failed++;
+
+		sCrypto.Sign(m_message,sizeof(m_message),boost::bind(&CryptoBench::OnSigned,this,_1),m_completions);
+	}
+	void OnSigned(CryptoJob &job)
+	{
+		if (job.success == false)
+			m_failed++;
+
+		sCrypto.Verify(m_message,sizeof(m_message),(const byte*)job.output.data(),job.output.size(),
+			boost::bind(&CryptoBench::OnVerified,this,_1),m_completions);
+	}
+	void OnVerified(CryptoJob &job)
+	{
+		if (job.success == false)
+			m_failed++;
+
+		m_finished++;
+		if (m_started < BENCH_LOGINS)
+			StartLogin();
+	}
+
+	uint32 GetFinished() { return m_finished; }
+	uint32 GetFailed() { return m_failed; }
+private:
+	string m_cipherText;
+	shared_ptr<CryptoCompletionQueue> m_completions;
+	byte m_message[16];
+	uint32 m_started;
+	uint32 m_finished;
+	uint32 m_failed;
+};
+
+void runCryptoBench(uint32 numWorkers, const CryptoPP::RSA::PrivateKey &privateKey, const string &cipherText)
+{
+	shared_ptr<CryptoCompletionQueue> completions(new CryptoCompletionQueue);
+	CryptoBench theBench(cipherText,completions);
+
+	sCrypto.Start(numWorkers,privateKey);
+
+	uint32 startTime = getMSTime();
+	for (uint32 i=0; i<BENCH_CLIENTS_IN_FLIGHT; i++)
+		theBench.StartLogin();
+
+	while (theBench.GetFinished() < BENCH_LOGINS)
+	{
+		if (completions->Drain() == 0)
+			Sleep(1);
+	}
+	uint32 elapsed = getMSTime() - startTime;
+	if (elapsed == 0)
+		elapsed = 1;
+
+	sCrypto.Stop();
+	completions->Close();
+
+	cout << format("%1% workers: %2% logins in %3% ms, %4% logins/s, %5% failed")
+		% numWorkers % BENCH_LOGINS % elapsed % (uint64(BENCH_LOGINS) * 1000 / elapsed) % theBench.GetFailed() << std::endl;
+}
+
+void runTest()
+{
+	ThreadPool.Startup();
+
+	CryptoPP::AutoSeededRandomPool randPool;
+	CryptoPP::InvertibleRSAFunction params;
+	params.GenerateRandomWithKeySize(randPool,1024);
+	CryptoPP::RSA::PrivateKey privateKey(params);
+
+	//same shape as the blob a client sends in AS_AuthRequest
+	byte clientBlob[31];
+	randPool.GenerateBlock(clientBlob,sizeof(clientBlob));
+	CryptoPP::RSAES_OAEP_SHA_Encryptor encryptor((CryptoPP::RSA::PublicKey(privateKey)));
+	string cipherText;
+	CryptoPP::StringSource(string((const char*)clientBlob,sizeof(clientBlob)),true,
+		new CryptoPP::PK_EncryptorFilter(randPool,encryptor,new CryptoPP::StringSink(cipherText)));
+
+	//0 runs every job inline on this thread
+	const uint32 workerCounts[] = { 0, 1, 4, 8 };
+	for (int round=0; round<2; round++)
+	{
+		for (size_t i=0; i<sizeof(workerCounts)/sizeof(workerCounts[0]); i++)
+			runCryptoBench(workerCounts[i],privateKey,cipherText);
+	}
+}
+
+#endif
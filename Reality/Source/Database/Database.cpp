@@ -27,24 +27,42 @@
 #include "../Log.h"
 #include "../Util.h"
 #include "../Threading/Threading.h"
+#include "../Timer.h"
+#include "../Metrics.h"
 
 SQLCallbackBase::~SQLCallbackBase()
 {
 
 }
 
-Database::Database() : ThreadContext()
+Database::Database() : ThreadContext(), m_poolCond(&m_poolLock)
 {
 	_counter=0;
+	m_nextWaiterTicket = 0;
+	m_pingIdleMS = 30000;
+	m_poolCreated = 0;
+	m_poolCheckouts = 0;
+	m_poolWaits = 0;
+	m_poolTimeouts = 0;
+	m_poolTotalWaitMS = 0;
+	m_poolMaxWaitMS = 0;
 	ThreadRunning = true;
+	m_asyncThreadsRunning = 0;
+	m_executorThreadsRunning = 0;
+	qt = NULL;
 }
 
 Database::~Database()
 {
 	Shutdown();
+
+	for (vector<ExecutorQueue*>::iterator it=m_executors.begin();it!=m_executors.end();++it)
+		delete *it;
+
+	m_executors.clear();
 }
 
-bool Database::Initialize(const char* Hostname, unsigned int port, const char* Username, const char* Password, const char* DatabaseName, uint32 ConnectionCount, uint32 BufferSize)
+bool Database::Initialize(const char* Hostname, unsigned int port, const char* Username, const char* Password, const char* DatabaseName, uint32 ConnectionCount, uint32 BufferSize, uint32 AsyncThreadCount, uint32 ExecutorThreadCount)
 {
 	uint32 i;
 	MYSQL * temp, * temp2;
@@ -54,6 +72,7 @@ bool Database::Initialize(const char* Hostname, unsigned int port, const char* U
 	mUsername = string(Username);
 	mPassword = string(Password);
 	mDatabaseName = string(DatabaseName);
+	mPort = port;
 
 	INFO_LOG(format("MySQLDatabase Connecting to `%1%`, database `%2%`...") % Hostname % DatabaseName);
 
@@ -73,37 +92,198 @@ bool Database::Initialize(const char* Hostname, unsigned int port, const char* U
 			return false;
 		}
 
-		m_connections.push_back(DatabaseConnection(temp2));
+		m_connections.push_back(DatabaseConnection(temp2,i));
+	}
+
+	// m_connections doesn't change size from here on, so handing out pointers into it is safe
+	m_poolCreated = getMSTime();
+	for(connectionsList::iterator it=m_connections.begin();it!=m_connections.end();++it)
+	{
+		it->lastReleased = m_poolCreated;
+		m_freeConnections.push_back(&(*it));
 	}
 
+	// one sub-queue per executor, the database thread itself services the first one
+	if (ExecutorThreadCount < 1)
+		ExecutorThreadCount = 1;
+
+	for( i = 0; i < ExecutorThreadCount; ++i )
+		m_executors.push_back(new ExecutorQueue(i));
+
 	// Spawn Database thread
 	ThreadPool.ExecuteTask(this);
 
+	for( i = 1; i < ExecutorThreadCount; ++i )
+	{
+		m_executorThreadsLock.Acquire();
+		m_executorThreadsRunning++;
+		m_executorThreadsLock.Release();
+
+		ThreadPool.ExecuteTask(new ExecutorThread(this,i));
+	}
+
 	// launch the query thread
 	qt = new QueryThread(this);
 	ThreadPool.ExecuteTask(qt);
 
+	// and the async query workers
+	for( i = 0; i < AsyncThreadCount; ++i )
+	{
+		m_asyncThreadsLock.Acquire();
+		m_asyncThreadsRunning++;
+		m_asyncThreadsLock.Release();
+
+		ThreadPool.ExecuteTask(new AsyncQueryThread(this));
+	}
+
 	return true;
 }
 
 DatabaseConnection &Database::GetFreeConnection()
 {
-	uint32 i = 0;
-	for(;;)
+	return *_TakeConnection(POOL_WAIT_FOREVER);
+}
+
+DatabaseConnection *Database::GetFreeConnection( uint32 timeoutMS )
+{
+	return _TakeConnection(timeoutMS);
+}
+
+DatabaseConnection *Database::_TakeConnection( uint32 timeoutMS )
+{
+	DatabaseConnection *con = NULL;
+	uint32 startTime = getMSTime();
+
+	m_poolCond.BeginSynchronized();
+	if (m_poolWaiters.empty() && !m_freeConnections.empty())
+	{
+		con = m_freeConnections.front();
+		m_freeConnections.pop_front();
+	}
+	else
 	{
-		DatabaseConnection &con = m_connections[ ((i++) % m_connections.size()) ];
-		if(con.Busy.AttemptAcquire())
-			return con;
+		// get in line behind everyone that's already waiting
+		uint32 myTicket = m_nextWaiterTicket++;
+		m_poolWaiters.push_back(myTicket);
+		m_poolWaits++;
+
+		bool timedOut = false;
+		while (m_poolWaiters.front() != myTicket || m_freeConnections.empty())
+		{
+			if (timeoutMS == POOL_WAIT_FOREVER)
+			{
+				m_poolCond.Wait();
+				continue;
+			}
+
+			uint32 waited = getMSTime() - startTime;
+			if (waited >= timeoutMS)
+			{
+				timedOut = true;
+				break;
+			}
+			m_poolCond.WaitMS(timeoutMS - waited);
+		}
 
-		// sleep every 20 iterations, otherwise this can cause 100% cpu if the db link goes dead
-		if( !(i % 20) )
+		m_poolWaiters.erase(std::find(m_poolWaiters.begin(),m_poolWaiters.end(),myTicket));
+		if (timedOut)
 		{
-			Sleep(10);
+			m_poolTimeouts++;
+			// we might have been first in line, let the next one have a go
+			m_poolCond.Broadcast();
+			m_poolCond.EndSynchronized();
+
+			WARNING_LOG(format("MySQLDatabase timed out after %1% ms waiting for a free connection") % timeoutMS);
+			return NULL;
 		}
+
+		con = m_freeConnections.front();
+		m_freeConnections.pop_front();
+
+		// more than one connection might have come back while we were waiting
+		if (!m_poolWaiters.empty() && !m_freeConnections.empty())
+			m_poolCond.Broadcast();
+
+		uint32 waitTime = getMSTime() - startTime;
+		m_poolTotalWaitMS += waitTime;
+		if (waitTime > m_poolMaxWaitMS)
+			m_poolMaxWaitMS = waitTime;
 	}
 
-	// shouldn't be reached
-	throw(exception());
+	m_poolCheckouts++;
+	con->checkouts++;
+	con->checkedOutAt = getMSTime();
+	uint32 idleFor = con->checkedOutAt - con->lastReleased;
+	m_poolCond.EndSynchronized();
+
+	if (m_pingIdleMS > 0 && idleFor >= m_pingIdleMS)
+		_CheckConnection(*con);
+
+	return con;
+}
+
+void Database::ReleaseConnection( DatabaseConnection &con )
+{
+	m_poolCond.BeginSynchronized();
+	uint32 now = getMSTime();
+	uint32 heldFor = now - con.checkedOutAt;
+	con.totalHoldMS += heldFor;
+	if (heldFor > con.maxHoldMS)
+		con.maxHoldMS = heldFor;
+	con.lastReleased = now;
+
+	// most recently used goes on top, so the rest get to sit idle and will be pinged when next used
+	m_freeConnections.push_front(&con);
+	if (!m_poolWaiters.empty())
+		m_poolCond.Broadcast();
+	m_poolCond.EndSynchronized();
+}
+
+void Database::_CheckConnection( DatabaseConnection &con )
+{
+	if (con.conn != NULL && mysql_ping(con.conn) == 0)
+		return;
+
+	WARNING_LOG(format("MySQLDatabase connection %1% failed its health check, reconnecting") % con.index);
+	_Reconnect(con);
+}
+
+string Database::GetPoolStats()
+{
+	stringstream out;
+
+	m_poolCond.BeginSynchronized();
+	uint32 now = getMSTime();
+	uint32 upTime = now - m_poolCreated;
+	if (upTime == 0)
+		upTime = 1;
+
+	uint64 avgWait = 0;
+	if (m_poolWaits > 0)
+		avgWait = m_poolTotalWaitMS / m_poolWaits;
+
+	out << format("%1% connections, %2% free, %3% waiting. %4% checkouts, %5% had to wait (avg %6% ms, max %7% ms), %8% timed out")
+		% m_connections.size() % m_freeConnections.size() % m_poolWaiters.size()
+		% m_poolCheckouts % m_poolWaits % avgWait % m_poolMaxWaitMS % m_poolTimeouts << std::endl;
+
+	for(connectionsList::iterator it=m_connections.begin();it!=m_connections.end();++it)
+	{
+		uint64 heldMS = it->totalHoldMS;
+		bool inUse = (std::find(m_freeConnections.begin(),m_freeConnections.end(),&(*it)) == m_freeConnections.end());
+		if (inUse)
+			heldMS += now - it->checkedOutAt;
+
+		uint64 avgHold = 0;
+		if (it->checkouts > 0)
+			avgHold = it->totalHoldMS / it->checkouts;
+
+		out << format("Connection %1%: %2% checkouts, avg hold %3% ms, max hold %4% ms, %5$.1f%% utilised%6%")
+			% it->index % it->checkouts % avgHold % it->maxHoldMS % (double(heldMS) * 100.0 / double(upTime))
+			% (inUse ? " (in use)" : "") << std::endl;
+	}
+	m_poolCond.EndSynchronized();
+
+	return out.str();
 }
 
 QueryResult *Database::Query( string QueryString )
@@ -115,7 +295,7 @@ QueryResult *Database::Query( string QueryString )
 	if( _SendQuery( con, QueryString.c_str(), false ) )
 		qResult = _StoreQueryResult( con );
 
-	con.Busy.Release();
+	ReleaseConnection(con);
 	return qResult;
 }
 
@@ -129,6 +309,60 @@ QueryResult * Database::FQuery( string QueryString, DatabaseConnection &con)
 	return qResult;
 }
 
+bool Database::StreamQuery( string QueryString, RowCallback onRow, uint64 *rowCount )
+{
+	uint64 rowsRead = 0;
+	DatabaseConnection &con = GetFreeConnection();
+	if( !_SendQuery( con, QueryString.c_str(), false ) )
+	{
+		ReleaseConnection(con);
+		return false;
+	}
+
+	MYSQL_RES *pRes = mysql_use_result( con.conn );
+	if( pRes == NULL )
+	{
+		bool noResultSet = (mysql_errno( con.conn ) == 0);
+		ReleaseConnection(con);
+		if (rowCount != NULL)
+			*rowCount = 0;
+
+		return noResultSet;
+	}
+
+	uint32 uFields = (uint32)mysql_num_fields( pRes );
+	vector<Field> fields(uFields);
+
+	MYSQL_ROW row;
+	while( (row = mysql_fetch_row( pRes )) != NULL )
+	{
+		unsigned long *lengths = mysql_fetch_lengths( pRes );
+		for( uint32 i = 0; i < uFields; ++i )
+			fields[i].SetValue( row[i], lengths[i] );
+
+		rowsRead++;
+		if( !onRow( uFields ? &fields[0] : NULL, uFields ) )
+			break;
+	}
+
+	// fetch_row returns NULL both at the end and when the connection broke halfway
+	bool success = true;
+	if( row == NULL && mysql_errno( con.conn ) != 0 )
+	{
+		ERROR_LOG(format("Sql streaming query failed after %1% rows due to [%2%], Query: [%3%]") % rowsRead % mysql_error( con.conn ) % QueryString);
+		success = false;
+	}
+
+	// also reads off whatever rows we didn't want
+	mysql_free_result( pRes );
+	ReleaseConnection(con);
+
+	if (rowCount != NULL)
+		*rowCount = rowsRead;
+
+	return success;
+}
+
 void Database::FWaitExecute( string QueryString, DatabaseConnection &con)
 {	
 	// Send the query
@@ -167,25 +401,105 @@ void Database::PerformQueryBuffer(QueryBuffer * b)
 		b->queries.pop_front();
 	}
 
-	con.Busy.Release();
+	ReleaseConnection(con);
 }
 
 
 bool Database::Execute( string QueryString)
 {
-	if(!ThreadRunning)
+	// unkeyed statements all share the first executor, same as when there was only one
+	return Execute(0, QueryString);
+}
+
+bool Database::Execute( uint64 key, string QueryString)
+{
+	if(!ThreadRunning || !m_threadRunning || m_executors.empty())
 		return WaitExecute(QueryString);
 
-	queries_queue.push(new string(QueryString));
+	_QueueExecute(new QueuedExecute(key,QueryString));
 	return true;
 }
 
+void Database::_QueueExecute( QueuedExecute *item )
+{
+	item->queuedAt = getMSTime();
+	m_executors[item->key % m_executors.size()]->queue.push(item);
+}
+
+uint32 Database::GetQueueSize()
+{
+	uint32 queueSize = 0;
+	for (vector<ExecutorQueue*>::iterator it=m_executors.begin();it!=m_executors.end();++it)
+		queueSize += (*it)->queue.get_size();
+
+	return queueSize;
+}
+
+string Database::GetExecutorStats()
+{
+	stringstream out;
+	for (vector<ExecutorQueue*>::iterator it=m_executors.begin();it!=m_executors.end();++it)
+	{
+		ExecutorQueue *executor = *it;
+		executor->statsLock.Acquire();
+		uint64 avgLatency = 0;
+		if (executor->executed > 0)
+			avgLatency = executor->totalLatencyMS / executor->executed;
+
+		out << format("Executor %1%: %2% queued, %3% executed, avg latency %4% ms, max latency %5% ms")
+			% executor->index % executor->queue.get_size() % executor->executed % avgLatency % executor->maxLatencyMS << std::endl;
+		executor->statsLock.Release();
+	}
+	return out.str();
+}
+
+void Database::PublishMetrics()
+{
+	for (vector<ExecutorQueue*>::iterator it=m_executors.begin();it!=m_executors.end();++it)
+	{
+		ExecutorQueue *executor = *it;
+		string labels = (format("executor=\"%1%\"") % executor->index).str();
+
+		executor->statsLock.Acquire();
+		uint64 executed = executor->executed;
+		uint64 totalLatencyMS = executor->totalLatencyMS;
+		uint32 maxLatencyMS = executor->maxLatencyMS;
+		uint64 threadCPUUS = executor->threadCPUUS;
+		executor->statsLock.Release();
+
+		sMetrics.SetGauge("reality_db_queue_size","Statements waiting for the executor.",executor->queue.get_size(),labels);
+		sMetrics.SetCounter("reality_db_statements_executed_total","Statements the executor ran.",double(executed),labels);
+		sMetrics.SetCounter("reality_db_statement_latency_ms_total","Sum of the time statements spent from being queued to being done.",double(totalLatencyMS),labels);
+		sMetrics.SetGauge("reality_db_statement_latency_max_ms","Longest time a statement spent from being queued to being done.",maxLatencyMS,labels);
+		sMetrics.SetCounter("reality_thread_cpu_seconds_total","CPU time used by the thread.",threadCPUUS / 1000000.0,
+			(format("server=\"db\",executor=\"%1%\"") % executor->index).str());
+	}
+
+	m_poolCond.BeginSynchronized();
+	size_t connections = m_connections.size();
+	size_t freeConnections = m_freeConnections.size();
+	size_t waiters = m_poolWaiters.size();
+	uint64 checkouts = m_poolCheckouts;
+	uint64 waits = m_poolWaits;
+	uint64 totalWaitMS = m_poolTotalWaitMS;
+	uint64 timeouts = m_poolTimeouts;
+	m_poolCond.EndSynchronized();
+
+	sMetrics.SetGauge("reality_db_connections","Connections in the pool.",double(connections));
+	sMetrics.SetGauge("reality_db_connections_free","Connections in the pool nobody has checked out.",double(freeConnections));
+	sMetrics.SetGauge("reality_db_connection_waiters","Threads waiting for a connection.",double(waiters));
+	sMetrics.SetCounter("reality_db_connection_checkouts_total","Connections handed out by the pool.",double(checkouts));
+	sMetrics.SetCounter("reality_db_connection_waits_total","Checkouts that had to wait for a connection.",double(waits));
+	sMetrics.SetCounter("reality_db_connection_wait_ms_total","Time spent waiting for a connection.",double(totalWaitMS));
+	sMetrics.SetCounter("reality_db_connection_timeouts_total","Checkouts that gave up waiting.",double(timeouts));
+}
+
 //this will wait for completion
 bool Database::WaitExecute( string QueryString)
 {
 	DatabaseConnection &con = GetFreeConnection();
 	bool Result = _SendQuery(con, QueryString.c_str(), false);
-	con.Busy.Release();
+	ReleaseConnection(con);
 	return Result;
 }
 
@@ -193,36 +507,81 @@ bool Database::run()
 {
 	SetThreadName("Database Executor");
 	ThreadRunning = true;
-	string *query = queries_queue.pop();
-	DatabaseConnection &con = GetFreeConnection();
-	while(query)
+	thread_proc_execute(0);
+
+	ThreadRunning = false;
+	return false;
+}
+
+void Database::thread_proc_execute( uint32 executorIndex )
+{
+	ExecutorQueue &executor = *m_executors[executorIndex];
+	vector<QueuedExecute*> batch;
+	QueuedExecute *next = executor.queue.pop();
+	while(next)
 	{
-		_SendQuery( con, query->c_str(), false );
-		delete query;
+		// statements for the same key that are already waiting share one connection checkout,
+		// they still run one at a time, the tables are MyISAM so there's nothing to gain from a transaction
+		batch.push_back(next);
+		next = NULL;
+		while (batch.size() < MAX_EXECUTE_BATCH)
+		{
+			next = executor.queue.pop_nowait();
+			if (next == NULL || next->key != batch.front()->key)
+				break;
+
+			batch.push_back(next);
+			next = NULL;
+		}
+
+		_RunExecuteBatch(&executor,batch);
+
 		if(!m_threadRunning)
 			break;
 
-		query = queries_queue.pop();
+		if (next == NULL)
+			next = executor.queue.pop();
 	}
 
-	con.Busy.Release();
+	// execute all the remaining queries
+	if (next == NULL)
+		next = executor.queue.pop_nowait();
 
-	if(queries_queue.get_size() > 0)
+	while(next)
 	{
-		// execute all the remaining queries
-		query = queries_queue.pop_nowait();
-		while(query)
-		{
-			DatabaseConnection &con = GetFreeConnection();
-			_SendQuery( con, query->c_str(), false );
-			con.Busy.Release();
-			delete query;
-			query=queries_queue.pop_nowait();
-		}
+		batch.push_back(next);
+		_RunExecuteBatch(&executor,batch);
+		next = executor.queue.pop_nowait();
 	}
+}
 
-	ThreadRunning = false;
-	return false;
+void Database::_RunExecuteBatch( ExecutorQueue *executor, vector<QueuedExecute*> &batch )
+{
+	DatabaseConnection &con = GetFreeConnection();
+
+	// each statement once, in the order it was queued, a failure doesn't affect the ones around it
+	for (vector<QueuedExecute*>::iterator it=batch.begin();it!=batch.end();++it)
+		_SendQuery(con, (*it)->statement.c_str(), false);
+
+	ReleaseConnection(con);
+
+	uint32 now = getMSTime();
+	executor->statsLock.Acquire();
+	for (vector<QueuedExecute*>::iterator it=batch.begin();it!=batch.end();++it)
+	{
+		uint32 latency = now - (*it)->queuedAt;
+		executor->executed++;
+		executor->totalLatencyMS += latency;
+		if (latency > executor->maxLatencyMS)
+			executor->maxLatencyMS = latency;
+	}
+	executor->threadCPUUS = getThreadCPUTimeUS();
+	executor->statsLock.Release();
+
+	for (vector<QueuedExecute*>::iterator it=batch.begin();it!=batch.end();++it)
+		delete *it;
+
+	batch.clear();
 }
 
 void AsyncQuery::AddQuery( string fmt )
@@ -246,7 +605,16 @@ void AsyncQuery::Perform()
 	for(vector<AsyncQueryResult>::iterator itr = queries.begin(); itr != queries.end(); ++itr)
 		itr->result = db->FQuery(itr->query, conn);
 
-	conn.Busy.Release();
+	db->ReleaseConnection(conn);
+
+	if (completion != NULL)
+		completion->Post(this);
+	else
+		Complete();
+}
+
+void AsyncQuery::Complete()
+{
 	func->run(queries);
 
 	delete this;
@@ -265,20 +633,78 @@ AsyncQuery::~AsyncQuery()
 	queries.clear();
 }
 
+QueryCompletionQueue::~QueryCompletionQueue()
+{
+	Close();
+}
+
+void QueryCompletionQueue::SetWakeup( Wakeup wakeup )
+{
+	m_lock.Acquire();
+	m_wakeup = wakeup;
+	m_lock.Release();
+}
+
+void QueryCompletionQueue::Post( AsyncQuery * query )
+{
+	m_lock.Acquire();
+	if (m_closed)
+	{
+		m_lock.Release();
+		delete query;
+		return;
+	}
+	//the owner drains everything at once, so it only needs waking for the first one
+	bool wasEmpty = m_completed.empty();
+	m_completed.push_back(query);
+	if (wasEmpty && !m_wakeup.empty())
+		m_wakeup();
+	m_lock.Release();
+}
+
+size_t QueryCompletionQueue::Drain()
+{
+	deque<AsyncQuery*> toRun;
+	m_lock.Acquire();
+	toRun.swap(m_completed);
+	m_lock.Release();
+
+	for (deque<AsyncQuery*>::iterator it=toRun.begin();it!=toRun.end();++it)
+		(*it)->Complete();
+
+	return toRun.size();
+}
+
+void QueryCompletionQueue::Close()
+{
+	m_lock.Acquire();
+	m_closed = true;
+	m_wakeup.clear();
+	while (m_completed.size() > 0)
+	{
+		delete m_completed.front();
+		m_completed.pop_front();
+	}
+	m_lock.Release();
+}
+
 void Database::EndThreads()
 {
 	Terminate();
-	while(ThreadRunning || qt)
+	while(ThreadRunning || qt || m_asyncThreadsRunning > 0 || m_executorThreadsRunning > 0)
 	{
-		if(query_buffer.get_size() == 0)
-			query_buffer.GetCond().Broadcast();
+		// only makes pop() give up once the queue is empty, nothing queued gets lost
+		query_buffer.Wake();
+
+		for (vector<ExecutorQueue*>::iterator it=m_executors.begin();it!=m_executors.end();++it)
+			(*it)->queue.Wake();
 
-		if(queries_queue.get_size() == 0)
-			queries_queue.GetCond().Broadcast();
+		if(async_queries.get_size() == 0)
+			async_queries.GetCond().Broadcast();
 
 
 		Sleep(100);
-		if(!ThreadRunning)
+		if(!ThreadRunning && m_asyncThreadsRunning == 0 && m_executorThreadsRunning == 0)
 			break;
 
 		Sleep(1000);
@@ -296,15 +722,32 @@ QueryThread::~QueryThread()
 	db->qt = NULL;
 }
 
+bool ExecutorThread::run()
+{
+	SetThreadName((format("Database Executor %1%") % executorIndex).str().c_str());
+	db->thread_proc_execute(executorIndex);
+
+	db->m_executorThreadsLock.Acquire();
+	db->m_executorThreadsRunning--;
+	db->m_executorThreadsLock.Release();
+	return true;
+}
+
+bool AsyncQueryThread::run()
+{
+	SetThreadName("Database Async Query");
+	db->thread_proc_async();
+	return true;
+}
+
 void Database::thread_proc_query()
 {
 	QueryBuffer * q;
-	DatabaseConnection &con = GetFreeConnection();
 
 	q = query_buffer.pop( );
 	while( q != NULL )
 	{
-		PerformQueryBuffer( q, con );
+		PerformQueryBuffer( q );
 		delete q;
 
 		if( !m_threadRunning )
@@ -313,8 +756,6 @@ void Database::thread_proc_query()
 		q = query_buffer.pop( );
 	}
 
-	con.Busy.Release();
-
 	// kill any queries
 	q = query_buffer.pop_nowait( );
 	while( q != NULL )
@@ -326,17 +767,42 @@ void Database::thread_proc_query()
 	}
 }
 
+void Database::thread_proc_async()
+{
+	AsyncQuery * q = async_queries.pop();
+	while( q != NULL )
+	{
+		q->Perform();
+
+		if( !m_threadRunning )
+			break;
+
+		q = async_queries.pop();
+	}
+
+	// finish off anything still queued
+	q = async_queries.pop_nowait();
+	while( q != NULL )
+	{
+		q->Perform();
+		q = async_queries.pop_nowait();
+	}
+
+	m_asyncThreadsLock.Acquire();
+	m_asyncThreadsRunning--;
+	m_asyncThreadsLock.Release();
+}
+
 void Database::QueueAsyncQuery(AsyncQuery * query)
 {
 	query->db = this;
-	/*if(qt == NULL)
+	if(m_asyncThreadsRunning == 0 || !m_threadRunning)
 	{
-	query->Perform();
-	return;
+		query->Perform();
+		return;
 	}
 
-	qqueries_queue.push(query);*/
-	query->Perform();
+	async_queries.push(query);
 }
 
 void Database::AddQueryBuffer(QueryBuffer * b)
@@ -357,17 +823,12 @@ void Database::FreeQueryResult(QueryResult * p)
 
 string Database::EscapeString(std::string Escape)
 {
-	char a2[16384] = {0};
+	//every connection is opened as utf8, which escapes the same with or without a connection,
+	//so don't check one out of the pool (and maybe wait for it) just to escape a string
+	vector<char> escaped(Escape.length()*2+1);
+	unsigned long escapedLen = mysql_escape_string(&escaped[0], Escape.c_str(), (unsigned long)Escape.length());
 
-	DatabaseConnection &con = GetFreeConnection();
-	const char * ret;
-	if(mysql_real_escape_string(con.conn, a2, Escape.c_str(), (unsigned long)Escape.length()) == 0)
-		ret = Escape.c_str();
-	else
-		ret = a2;
-
-	con.Busy.Release();
-	return string(ret);
+	return string(&escaped[0],escapedLen);
 }
 
 void Database::EscapeLongString(const char * str, uint32 len, stringstream& out)
@@ -382,7 +843,7 @@ void Database::EscapeLongString(const char * str, uint32 len, stringstream& out)
 		ret = a2;
 
 	out.write(a2, (std::streamsize)strlen(a2));
-	con.Busy.Release();
+	ReleaseConnection(con);
 }
 
 string Database::EscapeString(const char * esc, DatabaseConnection * con)
@@ -452,8 +913,9 @@ bool QueryResult::NextRow()
 	if(row == NULL)
 		return false;
 
+	unsigned long *lengths = mysql_fetch_lengths(mResult);
 	for(uint32 i = 0; i < mFieldCount; ++i)
-		mCurrentRow[i].SetValue(row[i]);
+		mCurrentRow[i].SetValue(row[i], lengths[i]);
 
 	return true;
 }
@@ -519,5 +981,6 @@ void Database::Shutdown()
 			it->conn = NULL;
 		}
 	}
+	m_freeConnections.clear();
 	m_connections.clear();
 }
@@ -28,6 +28,7 @@
 
 #include <string>
 #include "../Threading/Queue.h"
+#include "../Threading/MPSCQueue.h"
 #include "../CallBack.h"
 #include "../Threading/ThreadStarter.h"
 #include "Field.h"
@@ -35,14 +36,25 @@
 
 class QueryResult;
 class QueryThread;
+class AsyncQueryThread;
+class ExecutorThread;
+class QueryCompletionQueue;
 class Database;
 
 struct DatabaseConnection
 {
-	DatabaseConnection(MYSQL *rawPtr):conn(rawPtr) {}
+	DatabaseConnection(MYSQL *rawPtr, uint32 poolIndex):conn(rawPtr),index(poolIndex),
+		checkouts(0),totalHoldMS(0),maxHoldMS(0),checkedOutAt(0),lastReleased(0) {}
 	~DatabaseConnection() {}
-	FastMutex Busy;
 	MYSQL *conn;
+	uint32 index;
+
+	// pool statistics, only touched while the pool lock is held
+	uint64 checkouts;
+	uint64 totalHoldMS;
+	uint32 maxHoldMS;
+	uint32 checkedOutAt;
+	uint32 lastReleased;
 };
 
 struct AsyncQueryResult
@@ -57,15 +69,68 @@ class AsyncQuery
 	SQLCallbackBase * func;
 	vector<AsyncQueryResult> queries;
 	Database * db;
+	shared_ptr<QueryCompletionQueue> completion;
 public:
-	AsyncQuery(SQLCallbackBase * f) : func(f) {}
+	// with no completion queue, the callback runs on the database thread that performed the query
+	AsyncQuery(SQLCallbackBase * f) : func(f), db(NULL) {}
+	AsyncQuery(SQLCallbackBase * f, shared_ptr<QueryCompletionQueue> completeOn) : func(f), db(NULL), completion(completeOn) {}
 	~AsyncQuery();
 	void AddQuery(string fmt);
 	void AddQuery(format &fmt) { AddQuery(fmt.str()); }
 	void Perform();
+	void Complete();
 	inline void SetDB(Database * dbb) { db = dbb; }
 };
 
+// Finished AsyncQueries waiting for their owning server thread to run the callbacks.
+// The owner calls Drain() from its loop, and Close() when it stops so that
+// queries still in flight are thrown away instead of calling into a dead object.
+// An owner that sleeps in Select can SetWakeup() to be woken as soon as something arrives.
+class QueryCompletionQueue
+{
+public:
+	typedef boost::function<void ()> Wakeup;
+
+	QueryCompletionQueue() : m_closed(false) {}
+	~QueryCompletionQueue();
+
+	void SetWakeup(Wakeup wakeup);
+	void Post(AsyncQuery * query);
+	size_t Drain();
+	void Close();
+private:
+	NativeMutex m_lock;
+	deque<AsyncQuery*> m_completed;
+	bool m_closed;
+	Wakeup m_wakeup;
+};
+
+// A fire and forget statement waiting for an executor thread.
+// Everything with the same key lands on the same executor, so it runs in the order it was queued.
+struct QueuedExecute
+{
+	QueuedExecute(uint64 theKey, const string &theStatement) : key(theKey), queuedAt(0), statement(theStatement) {}
+
+	uint64 key;
+	uint32 queuedAt;
+	string statement;
+};
+
+struct ExecutorQueue
+{
+	ExecutorQueue(uint32 theIndex) : index(theIndex), executed(0), totalLatencyMS(0), maxLatencyMS(0), threadCPUUS(0) {}
+
+	uint32 index;
+	MPSCQueue<QueuedExecute*> queue;
+
+	// statistics, written by the executor thread under statsLock
+	NativeMutex statsLock;
+	uint64 executed;
+	uint64 totalLatencyMS;
+	uint32 maxLatencyMS;
+	uint64 threadCPUUS; //as of the last batch
+};
+
 class QueryBuffer
 {
 	deque<string> queries;
@@ -78,6 +143,7 @@ public:
 class Database : public ThreadContext
 {
 	friend class QueryThread;
+	friend class ExecutorThread;
 	friend class AsyncQuery;
 
 public:
@@ -95,23 +161,37 @@ public:
 	/************************************************************************/
 	bool Initialize(const char* Hostname, unsigned int port,
 		const char* Username, const char* Password, const char* DatabaseName,
-		uint32 ConnectionCount, uint32 BufferSize);
+		uint32 ConnectionCount, uint32 BufferSize, uint32 AsyncThreadCount=2, uint32 ExecutorThreadCount=2);
 
 	void Shutdown();
 
 	QueryResult* Query(string QueryString);
 	QueryResult* Query(format &fmt) { return Query(fmt.str()); }
 	QueryResult * FQuery( string QueryString, DatabaseConnection &con);
+
+	// For big scans. Rows come off the wire one at a time (mysql_use_result) and are handed
+	// to onRow instead of the whole set being copied into memory first. onRow returns false
+	// to stop early. The connection is held until the scan finishes, so keep onRow cheap.
+	typedef boost::function<bool (Field *fields, uint32 fieldCount)> RowCallback;
+	bool StreamQuery( string QueryString, RowCallback onRow, uint64 *rowCount=NULL);
+	bool StreamQuery( format &fmt, RowCallback onRow, uint64 *rowCount=NULL) { return StreamQuery(fmt.str(), onRow, rowCount); }
 	void FWaitExecute( string QueryString, DatabaseConnection &con);
 	bool WaitExecute( string QueryString);//Wait For Request Completion
 	bool WaitExecute(format &fmt) { return WaitExecute(fmt.str()); }
 	bool Execute( string QueryString);
 	bool Execute(format &fmt) { return Execute(fmt.str()); }
+	// statements sharing a key (e.g. a charId) keep their order, different keys may run in parallel
+	bool Execute( uint64 key, string QueryString);
+	bool Execute( uint64 key, format &fmt) { return Execute(key, fmt.str()); }
 
 	inline const string& GetHostName() { return mHostname; }
 	inline const string& GetDatabaseName() { return mDatabaseName; }
-	inline const uint32 GetQueueSize() { return queries_queue.get_size(); }
+	uint32 GetQueueSize();
+	string GetExecutorStats();
+	// copies the executor and connection pool statistics into the metrics registry
+	void PublishMetrics();
 
+	// doesn't touch the connection pool, safe to call from the game thread
 	string EscapeString(string Escape);
 	void EscapeLongString(const char * str, uint32 len, stringstream& out);
 	string EscapeString(const char * esc, DatabaseConnection *con);
@@ -120,9 +200,19 @@ public:
 	void EndThreads();
 
 	void thread_proc_query();
+	void thread_proc_execute(uint32 executorIndex);
+	void thread_proc_async();
 	void FreeQueryResult(QueryResult * p);
 
+	// Connection pool. Waiters are served in the order they arrived, and a connection that
+	// has been idle for a while is pinged (and reconnected if need be) before it's handed out.
 	DatabaseConnection &GetFreeConnection();
+	DatabaseConnection *GetFreeConnection(uint32 timeoutMS);
+	void ReleaseConnection(DatabaseConnection &con);
+	void SetPingIdleTime(uint32 idleMS) { m_pingIdleMS = idleMS; }
+	string GetPoolStats();
+
+	static const uint32 POOL_WAIT_FOREVER = 0xFFFFFFFF;
 
 	void PerformQueryBuffer(QueryBuffer * b);
 	void PerformQueryBuffer(QueryBuffer * b, DatabaseConnection &ccon);
@@ -142,14 +232,43 @@ protected:
 	bool _HandleError(DatabaseConnection &conn, uint32 ErrorNumber);
 	bool _Reconnect(DatabaseConnection &conn);
 
+	void _QueueExecute(QueuedExecute *item);
+	void _RunExecuteBatch(ExecutorQueue *executor, vector<QueuedExecute*> &batch);
+
 	////////////////////////////////
-	FQueue<QueryBuffer*> query_buffer;
+	MPSCQueue<QueryBuffer*> query_buffer;
 
 	////////////////////////////////
-	FQueue<string*> queries_queue;
+	// several async threads pop from this one, so it can't be single consumer
+	FQueue<AsyncQuery*> async_queries;
+	uint32 m_asyncThreadsRunning;
+	NativeMutex m_asyncThreadsLock;
+
+	////////////////////////////////
+	vector<ExecutorQueue*> m_executors;
+	uint32 m_executorThreadsRunning;
+	NativeMutex m_executorThreadsLock;
+	static const uint32 MAX_EXECUTE_BATCH = 32;
 	typedef vector<DatabaseConnection> connectionsList;
 	connectionsList m_connections;
 
+	DatabaseConnection *_TakeConnection(uint32 timeoutMS);
+	void _CheckConnection(DatabaseConnection &con);
+
+	NativeMutex m_poolLock;
+	Condition m_poolCond;
+	deque<DatabaseConnection*> m_freeConnections;
+	deque<uint32> m_poolWaiters;
+	uint32 m_nextWaiterTicket;
+	uint32 m_pingIdleMS;
+	uint32 m_poolCreated;
+
+	uint64 m_poolCheckouts;
+	uint64 m_poolWaits;
+	uint64 m_poolTimeouts;
+	uint64 m_poolTotalWaitMS;
+	uint32 m_poolMaxWaitMS;
+
 	uint32 _counter;
 	///////////////////////////////
 
@@ -193,4 +312,23 @@ public:
 	bool run();
 };
 
+class ExecutorThread : public ThreadContext
+{
+	Database * db;
+	uint32 executorIndex;
+public:
+	ExecutorThread(Database * d, uint32 index) : ThreadContext(), db(d), executorIndex(index) {}
+	~ExecutorThread() {}
+	bool run();
+};
+
+class AsyncQueryThread : public ThreadContext
+{
+	Database * db;
+public:
+	AsyncQueryThread(Database * d) : ThreadContext(), db(d) {}
+	~AsyncQueryThread() {}
+	bool run();
+};
+
 #endif
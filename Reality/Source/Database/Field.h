@@ -28,26 +28,71 @@
 
 #include <cstdlib>
 
+// One column of the current row. The text mysql hands us is only parsed the first time
+// a numeric getter is called, after that every getter reads the cached value.
 class Field
 {
 public:
+	Field() : mValue(NULL), mLength(0), mParsed(0) {}
 
-	inline void SetValue(char* value) { mValue = value; }
+	inline void SetValue(char* value, unsigned long length=0)
+	{
+		mValue = value;
+		mLength = length;
+		mParsed = 0;
+	}
 
 	inline const char *GetString() { return mValue; }
-	inline float GetFloat() { return mValue ? static_cast<float>(atof(mValue)) : 0; }
-	inline double GetDouble() { return atof(mValue); }
-	inline bool GetBool() { return mValue ? atoi(mValue) > 0 : false; }
-	inline uint8 GetUInt8() { return mValue ? static_cast<uint8>(atol(mValue)) : 0; }
-	inline int8 GetInt8() { return mValue ? static_cast<int8>(atol(mValue)) : 0; }
-	inline uint16 GetUInt16() { return mValue ? static_cast<uint16>(atol(mValue)) : 0; }
-	inline uint32 GetUInt32() { return mValue ? static_cast<uint32>(atol(mValue)) : 0; }
-	inline int32 GetInt32() { return mValue ? static_cast<int32>(atol(mValue)) : 0; }
-	inline int64 GetInt64() { return mValue ? lexical_cast<int64>(mValue) : 0; }
-	inline uint64 GetUInt64() { return mValue ? lexical_cast<uint64>(mValue) : 0; }
+	inline unsigned long GetLength() { return mLength; }
+	inline bool IsNull() { return mValue == NULL; }
+	inline float GetFloat() { return static_cast<float>(GetDouble()); }
+	inline double GetDouble()
+	{
+		if (!(mParsed & PARSED_FLOAT))
+		{
+			mFloatValue = mValue ? strtod(mValue,NULL) : 0;
+			mParsed |= PARSED_FLOAT;
+		}
+		return mFloatValue;
+	}
+	inline bool GetBool() { return GetInt64() > 0; }
+	inline uint8 GetUInt8() { return static_cast<uint8>(GetInteger()); }
+	inline int8 GetInt8() { return static_cast<int8>(GetInteger()); }
+	inline uint16 GetUInt16() { return static_cast<uint16>(GetInteger()); }
+	inline uint32 GetUInt32() { return static_cast<uint32>(GetInteger()); }
+	inline int32 GetInt32() { return static_cast<int32>(GetInteger()); }
+	inline int64 GetInt64() { return static_cast<int64>(GetInteger()); }
+	inline uint64 GetUInt64() { return GetInteger(); }
 
 private:
+	enum
+	{
+		PARSED_INTEGER = 1,
+		PARSED_FLOAT = 2
+	};
+
+	// two's complement bits, the getters above truncate them the same way atol() used to
+	inline uint64 GetInteger()
+	{
+		if (!(mParsed & PARSED_INTEGER))
+		{
+			if (mValue == NULL)
+				mIntValue = 0;
+			else if (mValue[0] == '-')
+				mIntValue = static_cast<uint64>(strtoll(mValue,NULL,10));
+			else
+				mIntValue = strtoull(mValue,NULL,10);
+
+			mParsed |= PARSED_INTEGER;
+		}
+		return mIntValue;
+	}
+
 	char *mValue;
+	unsigned long mLength;
+	uint8 mParsed;
+	uint64 mIntValue;
+	double mFloatValue;
 };
 
 #endif
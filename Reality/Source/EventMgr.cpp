@@ -0,0 +1,183 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#include "EventMgr.h"
+#include "Timer.h"
+#include "Log.h"
+
+EventMgr::EventMgr()
+{
+	m_nextId = 1;
+	m_currTick = 0;
+	m_nowTick = 0;
+	m_lastUpdateMS = getMSTime();
+	m_leftoverMS = 0;
+}
+
+EventMgr::~EventMgr()
+{
+	if (m_events.size() > 0)
+		DEBUG_LOG(format("EventMgr destroyed with %1% events pending") % m_events.size());
+}
+
+void EventMgr::Schedule( EventId id, eventEntry &theEvent, uint64 fireTick )
+{
+	//never into a slot that has already been done
+	if (fireTick <= m_currTick)
+		fireTick = m_currTick + 1;
+
+	theEvent.fireTick = fireTick;
+	m_wheel[fireTick % EVENT_WHEEL_SLOTS].push_back(id);
+}
+
+EventMgr::EventId EventMgr::AddEvent( const void *owner, uint32 type, EventFunc func, uint32 delayMS, uint32 repeatMS )
+{
+	if (func.empty())
+		return 0;
+
+	EventId id = m_nextId++;
+	if (m_nextId == 0)
+		m_nextId = 1;
+
+	eventEntry &theEvent = m_events[id];
+	theEvent.owner = owner;
+	theEvent.type = type;
+	theEvent.func = func;
+	theEvent.repeatMS = repeatMS;
+	//rounded up so nothing fires early
+	Schedule(id,theEvent,m_nowTick + (uint64(m_leftoverMS) + delayMS + EVENT_WHEEL_RESOLUTION_MS - 1) / EVENT_WHEEL_RESOLUTION_MS);
+	m_byOwner.insert(std::make_pair(owner,id));
+
+	return id;
+}
+
+void EventMgr::RemoveOwner( const void *owner, EventId id )
+{
+	std::pair<ownerMap::iterator,ownerMap::iterator> range = m_byOwner.equal_range(owner);
+	for (ownerMap::iterator it=range.first;it!=range.second;++it)
+	{
+		if (it->second == id)
+		{
+			m_byOwner.erase(it);
+			return;
+		}
+	}
+}
+
+bool EventMgr::CancelEvent( EventId id )
+{
+	eventMap::iterator it = m_events.find(id);
+	if (it == m_events.end())
+		return false;
+
+	RemoveOwner(it->second.owner,id);
+	m_events.erase(it);
+	return true;
+}
+
+size_t EventMgr::CancelEvents( const void *owner, uint32 type )
+{
+	size_t cancelledEvents = 0;
+	std::pair<ownerMap::iterator,ownerMap::iterator> range = m_byOwner.equal_range(owner);
+	for (ownerMap::iterator it=range.first;it!=range.second;)
+	{
+		eventMap::iterator eventIt = m_events.find(it->second);
+		if (type == ANY_TYPE || eventIt->second.type == type)
+		{
+			m_events.erase(eventIt);
+			m_byOwner.erase(it++);
+			cancelledEvents++;
+		}
+		else
+		{
+			++it;
+		}
+	}
+	return cancelledEvents;
+}
+
+bool EventMgr::HasEvent( const void *owner, uint32 type ) const
+{
+	std::pair<ownerMap::const_iterator,ownerMap::const_iterator> range = m_byOwner.equal_range(owner);
+	for (ownerMap::const_iterator it=range.first;it!=range.second;++it)
+	{
+		if (type == ANY_TYPE || m_events.find(it->second)->second.type == type)
+			return true;
+	}
+	return false;
+}
+
+void EventMgr::Update()
+{
+	uint32 currTime = getMSTime();
+	uint32 elapsedMS = currTime - m_lastUpdateMS + m_leftoverMS;
+	m_lastUpdateMS = currTime;
+
+	m_nowTick += elapsedMS / EVENT_WHEEL_RESOLUTION_MS;
+	m_leftoverMS = elapsedMS % EVENT_WHEEL_RESOLUTION_MS;
+	//after a long stall there's no point going round the same slots more than once
+	if (m_nowTick - m_currTick > EVENT_WHEEL_SLOTS)
+		m_currTick = m_nowTick - EVENT_WHEEL_SLOTS;
+
+	while (m_currTick < m_nowTick)
+	{
+		m_currTick++;
+		vector<EventId> &theSlot = m_wheel[m_currTick % EVENT_WHEEL_SLOTS];
+		if (theSlot.empty())
+			continue;
+
+		//events fired from here may add more to this slot, those are for the next turn
+		vector<EventId> slotEvents;
+		slotEvents.swap(theSlot);
+		foreach(EventId id, slotEvents)
+		{
+			eventMap::iterator it = m_events.find(id);
+			if (it == m_events.end())
+				continue;
+
+			if (it->second.fireTick > m_currTick)
+			{
+				theSlot.push_back(id);
+				continue;
+			}
+
+			//copied out, the event can cancel itself or its owner
+			EventFunc func = it->second.func;
+			if (it->second.repeatMS > 0)
+			{
+				//from when it was due rather than now so repeats don't drift
+				uint64 repeatTicks = (it->second.repeatMS + EVENT_WHEEL_RESOLUTION_MS - 1) / EVENT_WHEEL_RESOLUTION_MS;
+				Schedule(id,it->second,it->second.fireTick + repeatTicks);
+			}
+			else
+			{
+				RemoveOwner(it->second.owner,id);
+				m_events.erase(it);
+			}
+
+			func();
+		}
+	}
+}
@@ -0,0 +1,93 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_EVENTMGR_H
+#define MXOEMU_EVENTMGR_H
+
+#include "Common.h"
+#include <boost/function.hpp>
+
+// Timed events for the world (jackouts, doors, npcs), fired from the game loop on time whether or not
+// the client involved sends anything.
+// Events sit in a hashed timing wheel of EVENT_WHEEL_SLOTS slots, EVENT_WHEEL_RESOLUTION_MS each, so
+// scheduling and cancelling are O(1) and every tick only looks at the slots it passed. Events further out
+// than one turn of the wheel wait in their slot for the turns in between.
+// Every event has an owner and a type so everything an object scheduled can be cancelled at once, owners
+// have to do that before they go away.
+// Only used from the game server thread.
+class EventMgr
+{
+public:
+	typedef uint32 EventId;
+	typedef boost::function < void (void) > EventFunc;
+	static const uint32 ANY_TYPE = 0xFFFFFFFF;
+
+	EventMgr();
+	~EventMgr();
+
+	// fires after delayMS, then every repeatMS if that isn't 0. Returns 0 for no event
+	EventId AddEvent(const void *owner, uint32 type, EventFunc func, uint32 delayMS, uint32 repeatMS=0);
+	bool CancelEvent(EventId id);
+	// returns how many got cancelled
+	size_t CancelEvents(const void *owner, uint32 type=ANY_TYPE);
+	bool HasEvent(const void *owner, uint32 type=ANY_TYPE) const;
+
+	// fires everything that came due since the last call, call every loop
+	void Update();
+	size_t GetPendingCount() const { return m_events.size(); }
+private:
+	enum
+	{
+		EVENT_WHEEL_RESOLUTION_MS = 10,
+		EVENT_WHEEL_SLOTS = 512
+	};
+
+	struct eventEntry
+	{
+		const void *owner;
+		uint32 type;
+		EventFunc func;
+		uint64 fireTick;
+		uint32 repeatMS;
+	};
+
+	void Schedule(EventId id, eventEntry &theEvent, uint64 fireTick);
+	void RemoveOwner(const void *owner, EventId id);
+
+	typedef unordered_map<EventId,eventEntry> eventMap;
+	eventMap m_events;
+	// ids of the events in each slot, cancelled ones are dropped when their slot comes up
+	vector<EventId> m_wheel[EVENT_WHEEL_SLOTS];
+	typedef std::multimap<const void*,EventId> ownerMap;
+	ownerMap m_byOwner;
+
+	EventId m_nextId;
+	uint64 m_currTick;		// every slot up to and including this one has been fired
+	uint64 m_nowTick;		// the tick it is now, Update fires up to here
+	uint32 m_lastUpdateMS;
+	uint32 m_leftoverMS;	// time since the last update that didn't make up a whole tick
+};
+
+#endif
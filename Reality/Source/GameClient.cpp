@@ -31,23 +31,27 @@
 #include "MersenneTwister.h"
 #include "SequencedPacket.h"
 #include "RsiData.h"
-#include "MarginSocket.h"
-#include "MarginServer.h"
+#include "SessionRegistry.h"
 #include "Database/Database.h"
 #include "Log.h"
 #include "GameServer.h"
 #include "GameSocket.h"
 #include "EncryptedPacket.h"
+#include "TickProfiler.h"
+#include <typeinfo>
 
 GameClient::GameClient(sockaddr_in inc_addr, GameSocket *sock):m_address(inc_addr),m_sock(sock)
 {
 	m_validClient = true;
 	m_encryptionInitialized = false;
+	m_flushNeeded = false;
 
 	ResetRCC();
 
 	m_characterUID = 0;
+	m_sessionId = 0;
 	m_playerGoId=0;
+	m_playerLoading=false;
 }
 
 GameClient::~GameClient()
@@ -58,9 +62,60 @@ GameClient::~GameClient()
 	}
 	sObjMgr.releaseRelevantSet(this);
 
-	MarginSocket* marginConn = sMargin.GetSocketBySessionId(m_sessionId);
-	if(marginConn)
-		marginConn->ForceDisconnect();
+	if (m_sessionId != 0)
+		sSessions.RequestDisconnect(m_sessionId);
+}
+
+void GameClient::PlayerLoaded( QueryResultVector &loadResults )
+{
+	m_playerLoading = false;
+	if (!IsValid())
+		return;
+
+	try
+	{
+		m_playerGoId = sObjMgr.constructPlayer(this,m_characterUID,loadResults);
+	}
+	catch (ObjectMgr::ObjectNotAvailable)
+	{
+		ERROR_LOG(format("InitialUDPPacket(%1%): Character doesn't exist") % Address() );
+		Invalidate();
+		return;
+	}
+
+	if (sSessions.FindBySessionId(m_sessionId) == NULL)
+	{
+		ERROR_LOG(format("InitialUDPPacket(%1%): Margin session went away while loading character") % Address() );
+		Invalidate();
+		return;
+	}
+
+	m_encryptionInitialized=true;
+
+	//send latency/loss calibration heartbeats
+	const int numberOfBeats = 5;
+	for (int i=0;i<numberOfBeats;i++)
+	{
+		ByteBuffer beatPacket;
+		for (int j=0;j<numberOfBeats;j++)
+		{
+			beatPacket << uint8(0);
+		}
+		beatPacket << uint16(swap16(numberOfBeats));
+
+		m_sock->SendToClient(m_address, beatPacket.contents(), beatPacket.size());
+	}
+
+	//notify margin that udp session is established, the margin thread sends it on its next loop
+	//and reports back through the registry if it couldn't, GameServer drops us then
+	if (sSessions.RequestUdpReady(m_sessionId) == false)
+	{
+		ERROR_LOG(format("InitialUDPPacket(%1%): Margin not ready for UDP connection") % Address() );
+		m_encryptionInitialized=false;
+		Invalidate();
+		return;
+	}
+	sObjMgr.getGOPtr(m_playerGoId)->InitializeWorld();
 }
 
 void GameClient::HandlePacket( const char *pData, size_t nLength )
@@ -73,6 +128,10 @@ void GameClient::HandlePacket( const char *pData, size_t nLength )
 
 	if (m_encryptionInitialized == false && pData[0] == 0 && nLength == 43)
 	{
+		//client keeps resending this while the character is loading, ignore those
+		if (m_playerLoading == true)
+			return;
+
 		m_lastServerMS = getMSTime();
 
 		ByteBuffer packetData;
@@ -84,34 +143,21 @@ void GameClient::HandlePacket( const char *pData, size_t nLength )
 			return;
 		}
 		packetData >> m_characterUID;
-		try
-		{
-			m_playerGoId = sObjMgr.constructPlayer(this,m_characterUID);
-		}
-		catch (ObjectMgr::ObjectNotAvailable)
-		{
-			ERROR_LOG(format("InitialUDPPacket(%1%): Character doesn't exist") % Address() );
-			Invalidate();
-			return;
-		}
 
-		vector<MarginSocket*> marginConns = sMargin.GetSocketsForCharacterUID(m_characterUID);
-		if (marginConns.size() < 1)
+		vector<SessionRegistry::SessionPtr> marginSessions = sSessions.FindByCharacterUID(m_characterUID);
+		if (marginSessions.size() < 1)
 		{
 			ERROR_LOG(format("InitialUDPPacket(%1%): Margin session for character not found") % Address() );
 			Invalidate();
 			return;
 		}
 		//we need to test every margin session that has the same charId, for a matching sessionId
-		MarginSocket* marginConn = NULL;
-		foreach(marginConn, marginConns)
+		SessionRegistry::SessionPtr marginSession;
+		foreach(SessionRegistry::SessionPtr candidate, marginSessions)
 		{
-			m_sessionId = marginConn->GetSessionId();
-			m_charWorldId = marginConn->GetWorldCharId();
-
-			//initialize encryptors with key from margin
-			vector<byte> twofishKey = marginConn->GetTwofishKey();
-			m_tfEngine.Initialize(&twofishKey[0], twofishKey.size());
+			//initialize encryptors with the key margin already expanded
+			if (m_tfEngine.Initialize(candidate->twofishSchedule) == false)
+				continue;
 
 			//now we can verify if session key in this packet is correct
 			packetData.rpos(packetData.size()-TwofishCryptMethod::BLOCKSIZE);
@@ -119,7 +165,7 @@ void GameClient::HandlePacket( const char *pData, size_t nLength )
 			{
 				//wat, should never happen
 				Invalidate();
-				marginConn->ForceDisconnect();
+				sSessions.RequestDisconnect(candidate->sessionId);
 				return;
 			}
 			vector<byte> encryptedSessionId(packetData.remaining());
@@ -133,47 +179,28 @@ void GameClient::HandlePacket( const char *pData, size_t nLength )
 			uint32 recoveredSessionId=0;
 			decryptedData >> recoveredSessionId;
 
-			if (recoveredSessionId != m_sessionId)
+			if (recoveredSessionId != candidate->sessionId)
 			{
 				//invalid sessionId, try another connection
 				continue;
 			}
+
+			marginSession = candidate;
+			break;
 		}
 
-		if (!marginConn)
+		if (marginSession == NULL)
 		{
 			ERROR_LOG(format("InitialUDPPacket(%1%): Margin session for character not found") % Address() );
 			Invalidate();
 			return;
 		}
+		m_sessionId = marginSession->sessionId;
+		m_charWorldId = marginSession->worldCharId;
 
-		m_encryptionInitialized=true;
-
-		//send latency/loss calibration heartbeats
-		const int numberOfBeats = 5;
-		for (int i=0;i<numberOfBeats;i++)
-		{
-			ByteBuffer beatPacket;
-			for (int j=0;j<numberOfBeats;j++)
-			{
-				beatPacket << uint8(0);
-			}
-			beatPacket << uint16(swap16(numberOfBeats));
-
-			m_sock->SendToBuf(m_address, beatPacket.contents(), beatPacket.size(), 0);
-		}
-
-		//notify margin that udp session is established
-		if (marginConn->UdpReady(this) == false)
-		{
-			ERROR_LOG(format("InitialUDPPacket(%1%): Margin not ready for UDP connection") % Address() );
-			m_encryptionInitialized=false;
-			Invalidate();
-			marginConn->ForceDisconnect();
-			return;
-		}
-		sObjMgr.getGOPtr(m_playerGoId)->InitializeWorld();
-		FlushQueue();
+		//character comes from the db, PlayerLoaded picks up from here once it's in
+		m_playerLoading = true;
+		sObjMgr.loadPlayer(this,m_characterUID);
 		return;
 	}
 
@@ -187,7 +214,7 @@ void GameClient::HandlePacket( const char *pData, size_t nLength )
 		}
 		else
 		{
-			m_sock->SendToBuf(m_address, pData, int(nLength), 0);
+			m_sock->SendToClient(m_address, pData, nLength);
 		}
 	}
 	else
@@ -232,26 +259,22 @@ void GameClient::HandlePacket( const char *pData, size_t nLength )
 			}*/
 
 			//add to need to ack list
-			PacketReceived(packetData.getLocalSeq());						
-
-			//TODO: hack,we should update things irrespective of packets received
-			if (m_playerGoId != 0)
-			{
-				sObjMgr.getGOPtr(m_playerGoId)->Update();
-			}
+			if (PacketReceived(packetData.getLocalSeq()))
+				m_flushNeeded = true;
 
 			if (dataToParse.size() > 0)
 			{
 				HandleEncrypted(dataToParse);
 			}
-
-			FlushQueue();
+			//replies and acks go out with everything else on the next world tick
 		}
 	}
 }
 
 void GameClient::HandleEncrypted( ByteBuffer &srcData )
 {
+	ProfileProbe parseProbe(TickProfiler::PHASE_PARSE);
+
 	ByteBuffer dataCopy(&srcData.contents()[srcData.rpos()],srcData.remaining());
 	int32 commandOffset = -1;
 	ByteBuffer zeroFourBlock;
@@ -296,6 +319,7 @@ void GameClient::HandleEncrypted( ByteBuffer &srcData )
 	{
 		otherBlock = ByteBuffer(dataCopy.contents(),commandOffset);
 	}
+	parseProbe.Stop();
 
 	if (zeroFiveBlock.size() > 0)
 	{
@@ -324,6 +348,8 @@ void GameClient::HandleOther( ByteBuffer &otherData )
 			WARNING_LOG(format("HandleOther(%1%): 03 received but no player object to handle it") % this->Address() );
 			return;
 		}
+		ProfileProbe dispatchProbe(TickProfiler::PHASE_DISPATCH);
+		dispatchProbe.SetOpcode(TickProfiler::OPCODE_STATE_UPDATE);
 		sObjMgr.getGOPtr(m_playerGoId)->HandleStateUpdate(otherData);
 	}
 	else
@@ -334,8 +360,11 @@ void GameClient::HandleOther( ByteBuffer &otherData )
 
 void GameClient::HandleOrdered( ByteBuffer &orderedData )
 {
+	ProfileProbe parseProbe(TickProfiler::PHASE_PARSE);
 	OrderedPacket bigPacket;
-	if (bigPacket.FromBuffer(orderedData) == false)
+	bool parsed = bigPacket.FromBuffer(orderedData);
+	parseProbe.Stop();
+	if (parsed == false)
 	{
 		ERROR_LOG(format("(%1%) Error creating bigpacket from bytes %2%") % Address() % Bin2Hex(orderedData) );
 		return;
@@ -374,6 +403,7 @@ void GameClient::HandleOrdered( ByteBuffer &orderedData )
 
 SequencedPacket GameClient::Decrypt( const char *pData, size_t nLength )
 {
+	ProfileProbe decryptProbe(TickProfiler::PHASE_DECRYPT);
 	ByteBuffer tempBuf(pData,nLength);
 	TwofishEncryptedPacket decryptedData(tempBuf,m_tfEngine);
 	return SequencedPacket(decryptedData);
@@ -384,12 +414,15 @@ void GameClient::SendEncrypted(SequencedPacket withSequences)
 	if (!m_tfEngine.IsValid())
 		return;
 
+	ProfileProbe encryptProbe(TickProfiler::PHASE_ENCRYPT);
 	TwofishEncryptedPacket withEncryption(withSequences.getDataWithHeader());
 	ByteBuffer sendMe;
 	sendMe << uint8(1);
 	sendMe.append(withEncryption.toCipherText(m_tfEngine));
+	encryptProbe.Stop();
 
-	m_sock->SendToBuf(m_address, sendMe.contents(), sendMe.size(), 0);
+	ProfileProbe sendProbe(TickProfiler::PHASE_SEND);
+	m_sock->SendToClient(m_address, sendMe.contents(), sendMe.size());
 }
 
 bool GameClient::PacketReceived( uint16 clientSeq )
@@ -624,11 +657,27 @@ string GameClient::GetNetStats()
 	stringstream stats;
 	stats << "guarBlkSent: " << m_guarSent << " guarBlkResent: " << m_guarResent << " guarsInvalid: " << m_guarsInvalid << " guarsSkipped: " << m_guarsSkipped << "\n";
 	stats << "unGuarSent: " << m_unguarSent << " unGuarResent: " << m_unguarResent << " unGuarsInvalid: " << m_unguarsInvalid << " unGuarsRejected: " << m_unguarRejected << "\n";
-	stats << "duplicateCmdsRecvd: " << m_duplicateCmdsReceived << " additionalPcktRqsts: " << m_morePacketRequests << " rawPcktsResent: " << m_rawPacketsResent;
+	stats << "duplicateCmdsRecvd: " << m_duplicateCmdsReceived << " additionalPcktRqsts: " << m_morePacketRequests << " rawPcktsResent: " << m_rawPacketsResent << " ackPcktsSent: " << m_ackPacketsSent;
 
 	return	summary.str()+details.str()+stats.str();
 }
 
+void GameClient::AddNetTotals( NetTotals &totals ) const
+{
+	totals.guarSent += m_guarSent;
+	totals.guarResent += m_guarResent;
+	totals.guarsInvalid += m_guarsInvalid;
+	totals.guarsSkipped += m_guarsSkipped;
+	totals.unguarSent += m_unguarSent;
+	totals.unguarResent += m_unguarResent;
+	totals.unguarsInvalid += m_unguarsInvalid;
+	totals.duplicateCmdsReceived += m_duplicateCmdsReceived;
+	totals.unguarRejected += m_unguarRejected;
+	totals.morePacketRequests += m_morePacketRequests;
+	totals.rawPacketsResent += m_rawPacketsResent;
+	totals.ackPacketsSent += m_ackPacketsSent;
+}
+
 void GameClient::ResetRCC()
 {
 	m_serverSequence = 1;
@@ -655,6 +704,7 @@ void GameClient::ResetRCC()
 	m_unguarRejected = 0;
 	m_morePacketRequests = 0;
 	m_rawPacketsResent = 0;
+	m_ackPacketsSent = 0;
 
 	while (!m_savedPackets.empty()) m_savedPackets.pop_back();
 	
@@ -668,13 +718,17 @@ uint16 GameClient::SendSequencedPacket( msgBaseClassPtr jumboPacket )
 {
 	//serialize data from dynamic packet to a static one
 	ByteBuffer serializedData;
-	try
-	{
-		serializedData=jumboPacket->toBuf();
-	}
-	catch (MsgBaseClass::PacketNoLongerValid)
 	{
-		return 0;
+		ProfileProbe serializeProbe(TickProfiler::PHASE_SERIALIZE);
+		serializeProbe.SetMessageType(typeid(*jumboPacket).name());
+		try
+		{
+			serializedData=jumboPacket->toBuf();
+		}
+		catch (MsgBaseClass::PacketNoLongerValid)
+		{
+			return 0;
+		}
 	}
 
 	enum
@@ -716,6 +770,9 @@ uint16 GameClient::SendSequencedPacket( msgBaseClassPtr jumboPacket )
 
 void GameClient::FlushQueue( bool alsoResend )
 {
+	ProfileProbe flushProbe(TickProfiler::PHASE_FLUSH);
+	m_flushNeeded = false;
+
 	//reliable commands first
 	{
 		uint32 reliableResendMS = min(max((uint32)m_currentPing, MINIMUM_RESEND_TIME)*PING_MULTIPLIER_RELIABLE, MAXIMUM_RESEND_TIME);
@@ -758,6 +815,8 @@ void GameClient::FlushQueue( bool alsoResend )
 			ByteBuffer packetStaticBuf;
 			try
 			{
+				ProfileProbe serializeProbe(TickProfiler::PHASE_SERIALIZE);
+				serializeProbe.SetMessageType(typeid(*currMsg.data).name());
 				packetStaticBuf = currMsg.data->toBuf();
 			}
 			catch (MsgBaseClass::PacketNoLongerValid)
@@ -886,6 +945,8 @@ void GameClient::FlushQueue( bool alsoResend )
 			ByteBuffer serializedData;
 			try
 			{
+				ProfileProbe serializeProbe(TickProfiler::PHASE_SERIALIZE);
+				serializeProbe.SetMessageType(typeid(*it->stateData).name());
 				serializedData=it->stateData->toBuf();
 			}
 			catch (MsgBaseClass::PacketNoLongerValid)
@@ -922,17 +983,12 @@ void GameClient::FlushQueue( bool alsoResend )
 			++it;
 	}
 
-	//we ran out of packets but there are still more acks to be sent ?
-	size_t numUnacked=0;
-	typedef std::pair<uint16,bool> ackedType;
-	foreach(ackedType acked,m_recvdPacketSeqs)
+	//we ran out of packets but there are still more acks to be sent ? each one acks a whole run of them
+	while (HasUnsentAcks())
 	{
-		if (!acked.second)
-			numUnacked++;
-	}
-
-	for(size_t i=0;i<numUnacked;i++)
 		SendSequencedPacket(make_shared<EmptyMsg>());
+		m_ackPacketsSent++;
+	}
 }
 
 
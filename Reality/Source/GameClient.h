@@ -61,6 +61,7 @@ public:
 	uint32 GetWorldCharId() { return m_charWorldId; }
 
 	void HandlePacket(const char *pData, size_t nLength);
+	void PlayerLoaded(QueryResultVector &loadResults);
 	void HandleEncrypted(ByteBuffer &srcData);
 	void HandleOther(ByteBuffer &otherData);
 	void HandleOrdered(ByteBuffer &orderedData);
@@ -75,6 +76,7 @@ public:
 			amIObjectUpdate->setReceiver(this);
 
 		m_queuedStates.push_back(queuedState(realPtr,immediateOnly,callFunc));
+		m_flushNeeded = true;
 	}
 	void QueueCommand(msgBaseClassPtr theCmd,packetAckFunc callFunc=0)
 	{
@@ -85,10 +87,36 @@ public:
 
 		m_queuedCommands.push_back(queuedMsg(m_serverCommandsSent,theCmd,callFunc));
 		m_serverCommandsSent++;
+		m_flushNeeded = true;
 	}
 	void FlushQueue(bool alsoResend=false);
 	void CheckAndResend();
+	// something was queued or needs acking since the last flush, or there's sent data that might need resending
+	bool NeedsFlush() const { return m_flushNeeded || !m_sentCommands.empty() || !m_queuedStates.empty(); }
 	string GetNetStats();
+
+	// the netstat counters, summed up over clients for the metrics endpoint
+	struct NetTotals
+	{
+		NetTotals() { memset(this,0,sizeof(*this)); }
+
+		uint64 guarSent;
+		uint64 guarResent;
+		uint64 guarsInvalid;
+		uint64 guarsSkipped;
+		uint64 unguarSent;
+		uint64 unguarResent;
+		uint64 unguarsInvalid;
+		uint64 duplicateCmdsReceived;
+		uint64 unguarRejected;
+		uint64 morePacketRequests;
+		uint64 rawPacketsResent;
+		uint64 ackPacketsSent;
+	};
+	void AddNetTotals(NetTotals &totals) const;
+	size_t GetQueuedCommandCount() const { return m_queuedCommands.size(); }
+	size_t GetQueuedStateCount() const { return m_queuedStates.size(); }
+	size_t GetUnackedCommandCount() const { return m_sentCommands.size(); }
 private:
 	//RCC Start
 	void ResetRCC();
@@ -125,6 +153,9 @@ private:
 	uint32 m_unguarRejected;
 	uint32 m_morePacketRequests;
 	uint32 m_rawPacketsResent;
+	uint32 m_ackPacketsSent;
+
+	bool m_flushNeeded;
 
 	void AddtoPingHistory(uint32 msTime)
 	{
@@ -241,8 +272,24 @@ private:
 		{
 			if (it->second == false)
 			{
-				it->second=true;
-				return it->first;
+				//the ack bits cover the ones before the sequence we ack, so ack the newest one that still
+				//covers this and every packet in between is acked by the same packet
+				uint16 clientSeq = it->first;
+				for(uint i=MAX_ACKED_PACKETS-1;i>0;i--)
+				{
+					if (uint32(it->first)+i < 4096 && m_recvdPacketSeqs.count(it->first+i) > 0)
+					{
+						clientSeq = it->first+i;
+						break;
+					}
+				}
+				for(uint i=0;i<MAX_ACKED_PACKETS;i++)
+				{
+					recvdPacketSeqsType::iterator covered = m_recvdPacketSeqs.find(clientSeq-i);
+					if (covered != m_recvdPacketSeqs.end())
+						covered->second = true;
+				}
+				return clientSeq;
 			}
 		}
 		
@@ -251,6 +298,15 @@ private:
 
 		return m_lastClientSequence;
 	}
+	bool HasUnsentAcks() const
+	{
+		for(recvdPacketSeqsType::const_iterator it=m_recvdPacketSeqs.begin();it!=m_recvdPacketSeqs.end();++it)
+		{
+			if (it->second == false)
+				return true;
+		}
+		return false;
+	}
 	uint8 GetAckBits(uint16 clientSeq)
 	{
 		uint8 ackBits=0;
@@ -308,7 +364,7 @@ private:
 	uint32 m_lastServerMS;
 
 	uint32 m_playerGoId;
-	class MarginSocket *m_marginConn;
+	bool m_playerLoading;
 	TwofishCryptEngine m_tfEngine;
 };
 
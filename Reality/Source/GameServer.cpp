@@ -31,16 +31,44 @@
 #include "Timer.h"
 #include "Config.h"
 #include "GameSocket.h"
+#include "PlayerObject.h"
+#include "TickProfiler.h"
+#include "NetImpairment.h"
+#include "SessionRegistry.h"
 #include "Database/DatabaseEnv.h"
 #include <Sockets/Ipv4Address.h>
 
 initialiseSingleton( GameServer );
 
+static ConfigValue<string> chatPrefix("GameServer.ChatPrefix", "SOE+MXO");
+
+GameServer::GameServer()
+{
+	m_serverUp=false;
+	m_worldName = sConfig.GetStringDefault("GameServer.WorldName", "Reality");
+	m_configGeneration = 0;
+	m_dbCompletions.reset(new QueryCompletionQueue);
+
+	memset(m_loopPhaseUS,0,sizeof(m_loopPhaseUS));
+	m_loopCount = 0;
+	m_loopStatsSinceMS = m_lastLoopStatsLogMS = getMSTime();
+	m_loopStatsIntervalMS = 0;
+	m_worldTicksRun = m_worldTicksSkipped = 0;
+	m_lastMetricsMS = 0;
+
+	m_worldTickMS = 50;
+	m_nextWorldTickMS = getMSTime();
+	m_worldTick = 0;
+}
+
 bool GameServer::Start()
 {
 	m_simtimeStart = getFloatTime();
 	m_simtimeOffset = 0;
 
+	ApplyConfig();
+	m_worldData.LoadFromDB();
+
 	string Interface = sConfig.GetStringDefault("GameServer.IP", "0.0.0.0");
 	int Port = sConfig.GetIntDefault("GameServer.Port", 10000);
 	INFO_LOG(format("Starting Game server on port %1%") % Port);
@@ -67,7 +95,18 @@ bool GameServer::Start()
 
 void GameServer::Stop()
 {
+	// Players still in world are going offline, store them before the database goes away
+	foreach(uint32 goId, m_objMgr.getAllGOIds())
+	{
+		PlayerObject *thePlayer = m_objMgr.getGOPtr(goId);
+		m_persistMgr.MarkDirty(thePlayer->getCharacterUID(),thePlayer->getPosition(),false);
+	}
+	m_persistMgr.Flush(true);
+
 	m_mainSocket.reset();
+	//anything still loading is for clients that no longer exist
+	m_dbCompletions->Close();
+
 	// Mark server as "down"
 	{
 		sDatabase.WaitExecute(format("UPDATE `worlds` SET `status`='0' WHERE `name`='%1%' LIMIT 1")
@@ -77,14 +116,161 @@ void GameServer::Stop()
 	INFO_LOG("Game Server shutdown");
 }
 
+void GameServer::ApplyConfig()
+{
+	m_configGeneration = sConfig.GetGeneration();
+
+	m_persistMgr.Configure();
+	m_loopStatsIntervalMS = uint32(sConfig.GetIntDefault("GameServer.LoopStatsInterval", 0)) * 1000;
+	int tickRate = sConfig.GetIntDefault("GameServer.TickRate", 20);
+	if (tickRate < 1)
+		tickRate = 1;
+	if (tickRate > 100)
+		tickRate = 100;
+	m_worldTickMS = 1000 / uint32(tickRate);
+	sTickProfiler.Configure();
+	sImpairment.Configure();
+}
+
+//cpu time since the last lap
+static uint64 cpuLap(uint64 &lastCPU)
+{
+	uint64 currCPU = getThreadCPUTimeUS();
+	uint64 lap = currCPU - lastCPU;
+	lastCPU = currCPU;
+	return lap;
+}
+
 void GameServer::Loop(void)
 {
 	if (m_mainSocket == NULL)
 		return;
 
+	if (m_configGeneration != sConfig.GetGeneration())
+		ApplyConfig();
+
+	ProfileProbe tickProbe(TickProfiler::PHASE_TICK);
+	uint64 phaseUS[NUM_LOOP_PHASES];
+	memset(phaseUS,0,sizeof(phaseUS));
+	uint64 lastCPU = getThreadCPUTimeUS();
+
+	DropFailedSessions();
 	m_mainSocket->PruneDeadClients();
-	m_mainSocket->CheckAndResend();
-	m_udpHandler.Select(0,4000); //4ms
+	phaseUS[LOOP_PRUNE] = cpuLap(lastCPU);
+	m_dbCompletions->Drain();
+	phaseUS[LOOP_DB_COMPLETIONS] = cpuLap(lastCPU);
+
+	bool ticked = false;
+	uint32 currTime = getMSTime();
+	if (int32(currTime - m_nextWorldTickMS) >= 0)
+	{
+		WorldTick(phaseUS,lastCPU);
+		ticked = true;
+
+		//ticks happen at fixed times, unless we fell so far behind it's better to start counting again
+		m_nextWorldTickMS += m_worldTickMS;
+		if (int32(currTime - m_nextWorldTickMS) >= int32(m_worldTickMS*4))
+		{
+			uint32 skipped = (currTime - m_nextWorldTickMS) / m_worldTickMS;
+			m_nextWorldTickMS += skipped * m_worldTickMS;
+			m_loopStatsLock.Acquire();
+			m_worldTicksSkipped += skipped;
+			m_loopStatsLock.Release();
+		}
+	}
+
+	//wait for packets until the next tick is due, but not too long so resends and released datagrams go out on time
+	m_mainSocket->ReleaseImpaired();
+	int32 untilTickMS = int32(m_nextWorldTickMS - getMSTime());
+	long waitUS = (untilTickMS <= 0) ? 0 : (untilTickMS >= 4 ? 4000 : untilTickMS*1000);
+	m_udpHandler.Select(0,waitUS);
+	phaseUS[LOOP_NETWORK] = cpuLap(lastCPU);
+
+	m_loopStatsLock.Acquire();
+	for (int i=0;i<NUM_LOOP_PHASES;i++)
+		m_loopPhaseUS[i] += phaseUS[i];
+	m_loopCount++;
+	if (ticked)
+		m_worldTicksRun++;
+	m_loopStatsLock.Release();
+
+	if (m_loopStatsIntervalMS > 0 && getMSTime() - m_lastLoopStatsLogMS >= m_loopStatsIntervalMS)
+	{
+		m_lastLoopStatsLogMS = getMSTime();
+		INFO_LOG(GetLoopStats());
+	}
+
+	tickProbe.Stop();
+	sTickProfiler.Update();
+
+	if (MetricsPublishDue(m_lastMetricsMS))
+		m_mainSocket->PublishMetrics();
+}
+
+void GameServer::DropFailedSessions()
+{
+	vector<uint32> failedSessions;
+	sSessions.TakeFailedSessions(failedSessions);
+	foreach(uint32 sessionId, failedSessions)
+	{
+		GameClient *theClient = m_mainSocket->GetClientWithSessionId(sessionId);
+		if (theClient == NULL)
+			continue;
+
+		ERROR_LOG(format("Margin couldn't set up UDP session for %1%, dropping client") % theClient->Address());
+		theClient->Invalidate();
+	}
+}
+
+void GameServer::WorldTick( uint64 *phaseUS, uint64 &lastCPU )
+{
+	m_worldTick++;
+
+	m_objMgr.Update();
+	phaseUS[LOOP_OBJECTS] = cpuLap(lastCPU);
+	m_eventMgr.Update();
+	phaseUS[LOOP_EVENTS] = cpuLap(lastCPU);
+	m_persistMgr.Update();
+	phaseUS[LOOP_PERSIST] = cpuLap(lastCPU);
+	//sends everything queued since the last tick, together with any resends that are due
+	m_mainSocket->FlushClients();
+	phaseUS[LOOP_FLUSH] = cpuLap(lastCPU);
+}
+
+string GameServer::GetLoopStats( bool reset )
+{
+	const char *phaseNames[NUM_LOOP_PHASES] = {"prune","db completions","objects","events","persist","flush","network"};
+
+	m_loopStatsLock.Acquire();
+	uint32 wallMS = getMSTime() - m_loopStatsSinceMS;
+	uint64 loops = m_loopCount;
+	uint64 ticksRun = m_worldTicksRun, ticksSkipped = m_worldTicksSkipped;
+	uint64 phaseUS[NUM_LOOP_PHASES];
+	memcpy(phaseUS,m_loopPhaseUS,sizeof(phaseUS));
+	if (reset)
+	{
+		memset(m_loopPhaseUS,0,sizeof(m_loopPhaseUS));
+		m_loopCount = 0;
+		m_worldTicksRun = m_worldTicksSkipped = 0;
+		m_loopStatsSinceMS = getMSTime();
+	}
+	m_loopStatsLock.Release();
+
+	uint64 totalUS = 0;
+	for (int i=0;i<NUM_LOOP_PHASES;i++)
+		totalUS += phaseUS[i];
+
+	stringstream out;
+	out << format("Game loop over %.1fs: %u loops, %u world ticks (%u skipped), %.1f%% of a core")
+		% (wallMS/1000.0f) % loops % ticksRun % ticksSkipped % (wallMS ? float(totalUS) / 10.0f / wallMS : 0.0f);
+	for (int i=0;i<NUM_LOOP_PHASES;i++)
+	{
+		out << format(" | %s %.1fms (%.0f%%, %.1fus/loop)")
+			% phaseNames[i] % (phaseUS[i]/1000.0f)
+			% (totalUS ? float(phaseUS[i]) * 100.0f / totalUS : 0.0f)
+			% (loops ? float(phaseUS[i]) / loops : 0.0f);
+	}
+	return out.str();
 }
 
 GameClient* GameServer::GetClientWithSessionId( uint32 sessionId )
@@ -92,6 +278,14 @@ GameClient* GameServer::GetClientWithSessionId( uint32 sessionId )
 	return m_mainSocket->GetClientWithSessionId(sessionId);
 }
 
+GameClient* GameServer::GetClientWithAddress( const string &address )
+{
+	if (m_mainSocket == NULL)
+		return NULL;
+
+	return m_mainSocket->GetClientWithAddress(address);
+}
+
 vector<GameClient*> GameServer::GetClientsWithCharacterId( uint64 charId )
 {
 	return m_mainSocket->GetClientsWithCharacterId(charId);
@@ -123,10 +317,10 @@ void GameServer::AnnounceCommand( GameClient* clFrom,msgBaseClassPtr theCmd )
 
 string GameServer::GetName() const
 {
-	return sConfig.GetStringDefault("GameServer.WorldName", "Reality");
+	return m_worldName;
 }
 
 string GameServer::GetChatPrefix() const
 {
-	return sConfig.GetStringDefault("GameServer.ChatPrefix", "SOE+MXO") + string("+") + GetName();
+	return chatPrefix.Get() + string("+") + GetName();
 }
\ No newline at end of file
@@ -29,20 +29,21 @@
 #include "Common.h"
 #include "ByteBuffer.h"
 #include "Singleton.h"
+#include "EventMgr.h"
 #include "ObjectMgr.h"
+#include "PersistenceMgr.h"
+#include "WorldDataMgr.h"
 #include <Sockets/SocketHandler.h>
 #include "MessageTypes.h"
 #include "Timer.h"
+#include "Threading/NativeMutex.h"
 
 #include <boost/timer.hpp>
 
 class GameServer : public Singleton <GameServer>
 {
 public:
-	GameServer() 
-	{ 
-		m_serverUp=false; 
-	}
+	GameServer();
 	~GameServer() 
 	{ 
 		if (m_serverUp)
@@ -52,7 +53,12 @@ public:
 	void Stop();
 	void Loop();
 	ObjectMgr &getObjMgr() { return m_objMgr; }
+	PersistenceMgr &getPersistMgr() { return m_persistMgr; }
+	EventMgr &getEventMgr() { return m_eventMgr; }
+	WorldDataMgr &getWorldData() { return m_worldData; }
 	class GameClient *GetClientWithSessionId(uint32 sessionId);
+	class GameClient *GetClientWithAddress(const string &address);
+	shared_ptr<class QueryCompletionQueue> getDBCompletions() { return m_dbCompletions; }
 	vector<class GameClient*> GetClientsWithCharacterId(uint64 charId);
 	void Broadcast(const ByteBuffer &message, bool command);
 	void AnnounceStateUpdate(class GameClient* clFrom,msgBaseClassPtr theMsg, bool immediateOnly=false);
@@ -72,20 +78,71 @@ public:
 	}
 	string GetName() const;
 	string GetChatPrefix() const;
-private:	
+	// cpu time the game thread spent in each part of Loop since the last reset, callable from any thread
+	string GetLoopStats(bool reset=true);
+	// world ticks run since startup
+	uint64 GetWorldTick() const { return m_worldTick; }
+private:
+	enum LoopPhase
+	{
+		LOOP_PRUNE,
+		LOOP_DB_COMPLETIONS,
+		LOOP_OBJECTS,		// objects, events, persist and flush only run on world ticks
+		LOOP_EVENTS,
+		LOOP_PERSIST,
+		LOOP_FLUSH,
+		LOOP_NETWORK,		// receiving, decrypting and the handlers happen in Select
+		NUM_LOOP_PHASES
+	};
+
+	// the fixed rate part of the loop: everything that isn't reacting to a packet, then sending
+	// whatever that and the packets since the last tick queued up for the clients
+	void WorldTick(uint64 *phaseUS, uint64 &lastCPU);
+	// invalidates the clients whose margin couldn't do what they asked for
+	void DropFailedSessions();
+
+	// (re)reads the settings the game thread caches, at startup and after a config reload
+	void ApplyConfig();
+
+	//declared first so they outlive the player objects that flush into them and cancel their events
+	EventMgr m_eventMgr;
+	PersistenceMgr m_persistMgr;
 	ObjectMgr m_objMgr;
+	WorldDataMgr m_worldData;
 	SocketHandler m_udpHandler;
 	shared_ptr<class GameSocket> m_mainSocket;
+	shared_ptr<class QueryCompletionQueue> m_dbCompletions;
 	uint32 m_serverStartMS;
 	bool m_serverUp;
+	// the worlds table is keyed by it, so it stays what it was at startup
+	string m_worldName;
+	uint32 m_configGeneration;
 
 	float m_simtimeStart;
 	float m_simtimeOffset;
+
+	NativeMutex m_loopStatsLock;
+	uint64 m_loopPhaseUS[NUM_LOOP_PHASES];
+	uint64 m_loopCount;
+	uint32 m_loopStatsSinceMS;
+	uint32 m_loopStatsIntervalMS;
+	uint32 m_lastLoopStatsLogMS;
+	uint64 m_worldTicksRun;		// since the loop stats were reset
+	uint64 m_worldTicksSkipped;
+
+	uint32 m_worldTickMS;
+	uint32 m_nextWorldTickMS;
+	uint64 m_worldTick;
+
+	uint32 m_lastMetricsMS;
 };
 
 
 #define sGame GameServer::getSingleton()
 #define sObjMgr GameServer::getSingleton().getObjMgr()
+#define sPersistMgr GameServer::getSingleton().getPersistMgr()
+#define sEventMgr GameServer::getSingleton().getEventMgr()
+#define sWorldData GameServer::getSingleton().getWorldData()
 
 #endif
 
@@ -30,11 +30,14 @@
 #include "Timer.h"
 #include "Database/DatabaseEnv.h"
 #include "GameServer.h"
+#include "TickProfiler.h"
+#include "NetImpairment.h"
 #include <Sockets/Ipv4Address.h>
 
 GameSocket::GameSocket( ISocketHandler& theHandler ) : UdpSocket(theHandler)
 {
 	m_lastCleanupTime = getTime();
+	m_clientsFlushed = m_clientsSkipped = 0;
 	// set player count to 0
 	{
 		sDatabase.Execute(format("UPDATE `worlds` SET `numPlayers`='0' WHERE `name`='%1%' LIMIT 1")
@@ -51,6 +54,9 @@ GameSocket::~GameSocket()
 
 void GameSocket::OnRawData( const char *pData,size_t len,struct sockaddr *sa_from,socklen_t sa_len )
 {
+	ProfileProbe receiveProbe(TickProfiler::PHASE_RECEIVE);
+	m_traffic.CountIn(len);
+
 	struct sockaddr_in inc_addr;
 	memcpy(&inc_addr,sa_from,sa_len);
 	Ipv4Address theAddr(inc_addr);
@@ -59,6 +65,20 @@ void GameSocket::OnRawData( const char *pData,size_t len,struct sockaddr *sa_fro
 		return;
 
 	string IPStr = theAddr.Convert(true);
+	if (sImpairment.IsEnabled())
+	{
+		uint32 copies = sImpairment.Impair(NetImpairment::INBOUND, IPStr, inc_addr, pData, len);
+		for (uint32 i=0;i<copies;i++)
+			DeliverInbound(IPStr, inc_addr, pData, len);
+	}
+	else
+	{
+		DeliverInbound(IPStr, inc_addr, pData, len);
+	}
+}
+
+void GameSocket::DeliverInbound( const string &IPStr, const sockaddr_in &inc_addr, const char *pData, size_t len )
+{
 	GClientList::iterator it = m_clients.find(IPStr);
 	if (it != m_clients.end())
 	{
@@ -67,7 +87,7 @@ void GameSocket::OnRawData( const char *pData,size_t len,struct sockaddr *sa_fro
 		{
 			DEBUG_LOG( format("Removing dead client [%1%]") % IPStr );
 			m_clients.erase(it);
-			delete Client;
+			RetireClient(Client);
 		}
 		else
 		{
@@ -100,7 +120,7 @@ void GameSocket::PruneDeadClients()
 				DEBUG_LOG( format("Removing client due to time-out [%1%]") % Client->Address() );
 
 			m_clients.erase(it++);
-			delete Client;
+			RetireClient(Client);
 		}
 		else
 		{
@@ -133,9 +153,95 @@ void GameSocket::RemoveCharacter(string IPAddr)
 		GameClient *Client = it->second;
 		DEBUG_LOG( format("Removing XXX dead client [%1%]") % IPAddr );
 		m_clients.erase(it);
-		delete Client;		
+		RetireClient(Client);
+	}
+
+}
+
+void GameSocket::RetireClient( GameClient *Client )
+{
+	Client->AddNetTotals(m_retiredTotals);
+	sImpairment.ForgetClient(Client->Address());
+	delete Client;
+}
+
+void GameSocket::SendToClient( SocketAddress &clientAddr, const char *data, size_t len )
+{
+	if (sImpairment.IsEnabled())
+	{
+		sockaddr_in theAddr;
+		memcpy(&theAddr,(struct sockaddr *)clientAddr,sizeof(theAddr));
+		uint32 copies = sImpairment.Impair(NetImpairment::OUTBOUND, clientAddr.Convert(true), theAddr, data, len);
+		for (uint32 i=0;i<copies;i++)
+		{
+			m_traffic.CountOut(len);
+			SendToBuf(clientAddr, data, int(len), 0);
+		}
+		return;
 	}
 
+	m_traffic.CountOut(len);
+	SendToBuf(clientAddr, data, int(len), 0);
+}
+
+void GameSocket::ReleaseImpaired()
+{
+	sImpairment.Update();
+
+	vector<NetImpairment::Datagram> due;
+	sImpairment.TakeDue(due);
+	foreach(const NetImpairment::Datagram &theDatagram, due)
+	{
+		if (theDatagram.direction == NetImpairment::INBOUND)
+		{
+			DeliverInbound(theDatagram.address, theDatagram.addr, theDatagram.data.data(), theDatagram.data.size());
+		}
+		else
+		{
+			sockaddr_in addrCopy = theDatagram.addr;
+			Ipv4Address theAddr(addrCopy);
+			m_traffic.CountOut(theDatagram.data.size());
+			SendToBuf(theAddr, theDatagram.data.data(), int(theDatagram.data.size()), 0);
+		}
+	}
+}
+
+void GameSocket::PublishMetrics()
+{
+	GameClient::NetTotals totals = m_retiredTotals;
+	size_t queuedCommands = 0, queuedStates = 0, unackedCommands = 0;
+	for (GClientList::iterator it=m_clients.begin();it!=m_clients.end();++it)
+	{
+		it->second->AddNetTotals(totals);
+		queuedCommands += it->second->GetQueuedCommandCount();
+		queuedStates += it->second->GetQueuedStateCount();
+		unackedCommands += it->second->GetUnackedCommandCount();
+	}
+
+	const string labels = "server=\"game\"";
+	PublishThreadMetrics(labels,&m_traffic);
+	sMetrics.SetGauge("reality_clients","Clients connected to the server.",double(m_clients.size()),labels);
+
+	sMetrics.SetGauge("reality_game_queued_commands","Reliable messages queued up for clients and not sent yet.",double(queuedCommands));
+	sMetrics.SetGauge("reality_game_queued_states","Unreliable state updates held for clients, sent or not.",double(queuedStates));
+	sMetrics.SetGauge("reality_game_unacked_command_blocks","Reliable message blocks sent to clients and not acknowledged yet.",double(unackedCommands));
+
+	sMetrics.SetCounter("reality_game_reliable_blocks_sent_total","Reliable message blocks sent to clients.",double(totals.guarSent));
+	sMetrics.SetCounter("reality_game_reliable_blocks_resent_total","Reliable message blocks resent to clients.",double(totals.guarResent));
+	sMetrics.SetCounter("reality_game_reliable_invalid_total","Reliable messages that were no longer valid when it was time to send them.",double(totals.guarsInvalid));
+	sMetrics.SetCounter("reality_game_reliable_skipped_total","Times reliable message ids weren't continuous.",double(totals.guarsSkipped));
+	sMetrics.SetCounter("reality_game_unreliable_sent_total","State updates sent to clients.",double(totals.unguarSent));
+	sMetrics.SetCounter("reality_game_unreliable_resent_total","State updates resent to clients.",double(totals.unguarResent));
+	sMetrics.SetCounter("reality_game_unreliable_invalid_total","State updates that were no longer valid when it was time to send them.",double(totals.unguarsInvalid));
+	sMetrics.SetCounter("reality_game_unreliable_rejected_total","State updates given up on after too many resends.",double(totals.unguarRejected));
+	sMetrics.SetCounter("reality_game_duplicate_commands_total","Client commands received more than once.",double(totals.duplicateCmdsReceived));
+	sMetrics.SetCounter("reality_game_more_packet_requests_total","Client packets asking for more packets.",double(totals.morePacketRequests));
+	sMetrics.SetCounter("reality_game_raw_packets_resent_total","Whole packets resent to clients.",double(totals.rawPacketsResent));
+	sMetrics.SetCounter("reality_game_ack_packets_sent_total","Packets sent to clients only to acknowledge theirs.",double(totals.ackPacketsSent));
+	sMetrics.SetCounter("reality_game_client_flushes_total","Client queue flushes run on world ticks.",double(m_clientsFlushed));
+	sMetrics.SetCounter("reality_game_client_flushes_skipped_total","Client queue flushes skipped on world ticks because there was nothing to send.",double(m_clientsSkipped));
+
+	sImpairment.PublishMetrics();
 }
 
 GameClient * GameSocket::GetClientWithSessionId( uint32 sessionId )
@@ -150,6 +256,15 @@ GameClient * GameSocket::GetClientWithSessionId( uint32 sessionId )
 	return NULL;
 }
 
+GameClient * GameSocket::GetClientWithAddress( const string &address )
+{
+	GClientList::iterator it = m_clients.find(address);
+	if (it == m_clients.end())
+		return NULL;
+
+	return it->second;
+}
+
 vector<GameClient*> GameSocket::GetClientsWithCharacterId( uint64 charId )
 {
 	vector<GameClient*> returns;
@@ -163,11 +278,19 @@ vector<GameClient*> GameSocket::GetClientsWithCharacterId( uint64 charId )
 	return returns;
 }
 
-void GameSocket::CheckAndResend()
+void GameSocket::FlushClients()
 {
 	for (GClientList::iterator it=m_clients.begin();it!=m_clients.end();++it)
 	{
-		it->second->CheckAndResend();
+		if (it->second->NeedsFlush())
+		{
+			it->second->CheckAndResend();
+			m_clientsFlushed++;
+		}
+		else
+		{
+			m_clientsSkipped++;
+		}
 	}
 }
 
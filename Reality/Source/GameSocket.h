@@ -30,6 +30,7 @@
 #include "ByteBuffer.h"
 #include "MessageTypes.h"
 #include "GameClient.h"
+#include "Metrics.h"
 #include <Sockets/UdpSocket.h>
 #include <Sockets/ISocketHandler.h>
 #include <Sockets/SocketAddress.h>
@@ -41,15 +42,33 @@ public:
 	~GameSocket();
 	void OnRawData( const char *pData,size_t len,struct sockaddr *sa_from,socklen_t sa_len );
 	void PruneDeadClients();
-	void CheckAndResend();
+	// sends what each client has queued, and any resends that are due, in as few packets as it fits in.
+	// Called once a world tick, clients with nothing queued, to ack or waiting on acks are skipped
+	void FlushClients();
 	size_t Clients_Connected(void) { return m_clients.size(); }
 	GameClient *GetClientWithSessionId(uint32 sessionId);
+	GameClient *GetClientWithAddress(const string &address);
 	vector<GameClient*> GetClientsWithCharacterId( uint64 charId );
 	void Broadcast(const ByteBuffer &message, bool command);
 	void AnnounceStateUpdate(GameClient* clFrom,msgBaseClassPtr theMsg, bool immediateOnly=false, GameClient::packetAckFunc callFunc=0);
 	void AnnounceCommand(GameClient* clFrom,msgBaseClassPtr theCmd, GameClient::packetAckFunc callFunc=0);
 	void RemoveCharacter(string IPAddr);
+	// every datagram to a client goes through here so it gets counted (and impaired)
+	void SendToClient(SocketAddress &clientAddr, const char *data, size_t len);
+	// datagrams the impairment layer held back that are due now, both ways
+	void ReleaseImpaired();
+	// copies client counts, traffic and the netstat totals into the metrics registry
+	void PublishMetrics();
 private:
+	void DeliverInbound(const string &IPStr, const sockaddr_in &inc_addr, const char *pData, size_t len);
+	// folds the client's netstat counters into the totals before deleting it
+	void RetireClient(GameClient *Client);
+
+	TrafficCounters m_traffic;
+	GameClient::NetTotals m_retiredTotals;
+	uint64 m_clientsFlushed;
+	uint64 m_clientsSkipped;
+
 	// Client List
 	typedef map<string, GameClient*> GClientList;
 	GClientList m_clients;
@@ -0,0 +1,124 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_LISTENERSHARDS_H
+#define MXOEMU_LISTENERSHARDS_H
+
+#include "Common.h"
+#include "Util.h"
+#include "Threading/ThreadStarter.h"
+#include <Sockets/ListenSocket.h>
+#include <Sockets/UdpSocket.h>
+
+// With SO_REUSEPORT any number of sockets can listen on the same port, and the kernel spreads
+// incoming connections between them. The auth and margin servers use that to run several shards,
+// each a socket handler with a listener of its own, serviced by its own thread.
+template <class X>
+class ReusePortListenSocket : public ListenSocket<X>
+{
+public:
+	ReusePortListenSocket(ISocketHandler &h) : ListenSocket<X>(h) {}
+
+	void OnOptions(int family,int type,int protocol,SOCKET s)
+	{
+		ListenSocket<X>::OnOptions(family,type,protocol,s);
+#ifdef SO_REUSEPORT
+		int optval = 1;
+		setsockopt(s, SOL_SOCKET, SO_REUSEPORT, (char *)&optval, sizeof(optval));
+#endif
+	}
+};
+
+// without SO_REUSEPORT only one listener gets the port
+inline uint32 ListenerShardLimit(uint32 wanted)
+{
+	if (wanted < 1)
+		return 1;
+#ifdef SO_REUSEPORT
+	return wanted;
+#else
+	return 1;
+#endif
+}
+
+// Lets other threads cut a shard's Select short: Wake() sends a datagram to this socket, which
+// is registered with the shard's handler. The socket library's own EnableRelease/Release does
+// the same but binds to port 0 without finding out which port it got, so it never arrives.
+class ShardWakeupSocket : public UdpSocket
+{
+public:
+	ShardWakeupSocket(ISocketHandler &h) : UdpSocket(h,16)
+	{
+		port_t port = 0;
+		Bind("127.0.0.1",port);
+
+		memset(&m_selfAddr,0,sizeof(m_selfAddr));
+		m_selfAddr.sin_family = AF_INET;
+		m_selfAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		m_selfAddr.sin_port = htons(GetSockPort());
+	}
+
+	// callable from any thread, as long as the handler is alive
+	void Wake()
+	{
+		sendto(GetSocket(),"\n",1,0,(struct sockaddr *)&m_selfAddr,sizeof(m_selfAddr));
+	}
+
+	//the datagram only had to make Select return
+	void OnRawData(const char *buf,size_t len,struct sockaddr *sa,socklen_t sa_len) {}
+private:
+	struct sockaddr_in m_selfAddr;
+};
+
+// Runs a shard's loop on a thread of its own until terminated.
+// run() returns false so the thread pool leaves it alone, whoever started it waits for
+// IsFinished() and deletes it.
+class ListenerShardThread : public ThreadContext
+{
+public:
+	typedef boost::function<void ()> LoopFunc;
+
+	ListenerShardThread(const string &threadName, LoopFunc loopFunc)
+		: ThreadContext(), m_threadName(threadName), m_loopFunc(loopFunc), m_finished(false) {}
+
+	bool run()
+	{
+		SetThreadName(m_threadName.c_str());
+		while (m_threadRunning)
+		{
+			m_loopFunc();
+		}
+		m_finished = true;
+		return false;
+	}
+
+	bool IsFinished() { return m_finished; }
+private:
+	string m_threadName;
+	LoopFunc m_loopFunc;
+	volatile bool m_finished;
+};
+
+#endif
@@ -30,7 +30,7 @@
 
 createFileSingleton( Log );
 
-Log::Log()
+Log::Log() : consoleLogLevel("Log.ConsoleLogLevel",LOGLEVEL_INFO), fileLogLevel("Log.FileLogLevel",LOGLEVEL_WARNING)
 {
 	OpenLogFile("Reality.log");
 }
@@ -124,14 +124,29 @@ string Log::ProcessString( LogLevel level,const string &str,bool forFile)
 	return returnings.str();
 }
 
-void Log::OutputConsole( LogLevel level,const string &str )
+int Log::ConsoleLogLevel()
 {
-	int ConsoleLogLevel = sConfig.GetIntDefault("Log.ConsoleLogLevel",LOGLEVEL_INFO);
-	if (ConsoleLogLevel < LOGLEVEL_CRITICAL || ConsoleLogLevel > LOGLEVEL_DEBUG)
+	int theLevel = consoleLogLevel.Get();
+	if (theLevel < LOGLEVEL_CRITICAL || theLevel > LOGLEVEL_DEBUG)
 	{
-		ConsoleLogLevel = LOGLEVEL_INFO;
+		theLevel = LOGLEVEL_INFO;
 	}
-	if (ConsoleLogLevel >= level)
+	return theLevel;
+}
+
+int Log::FileLogLevel()
+{
+	int theLevel = fileLogLevel.Get();
+	if (theLevel < LOGLEVEL_CRITICAL || theLevel > LOGLEVEL_DEBUG)
+	{
+		theLevel = LOGLEVEL_WARNING;
+	}
+	return theLevel;
+}
+
+void Log::OutputConsole( LogLevel level,const string &str )
+{
+	if (ConsoleLogLevel() >= level)
 	{
 		string outputMe = ProcessString(level,str,false);
 		printMutex.Acquire();
@@ -142,12 +157,7 @@ void Log::OutputConsole( LogLevel level,const string &str )
 
 void Log::OutputFile( LogLevel level,const string &str )
 {
-	int FileLogLevel = sConfig.GetIntDefault("Log.FileLogLevel",LOGLEVEL_WARNING);
-	if (FileLogLevel < LOGLEVEL_CRITICAL || FileLogLevel > LOGLEVEL_DEBUG)
-	{
-		FileLogLevel = LOGLEVEL_WARNING;
-	}
-	if (FileLogLevel >= level)
+	if (FileLogLevel() >= level)
 	{
 		string outputMe = ProcessString(level,str,true);
 		if (LogFile.is_open() == true)
@@ -167,10 +177,7 @@ void Log::Output( LogLevel level,const string &str )
 
 void Log::Critical( boost::format &fmt )
 {
-	int ConsoleLogLevel = sConfig.GetIntDefault("Log.ConsoleLogLevel",LOGLEVEL_INFO);
-	int FileLogLevel = sConfig.GetIntDefault("Log.FileLogLevel",LOGLEVEL_WARNING);
-
-	if (ConsoleLogLevel >= LOGLEVEL_CRITICAL || FileLogLevel >= LOGLEVEL_CRITICAL)
+	if (ConsoleLogLevel() >= LOGLEVEL_CRITICAL || FileLogLevel() >= LOGLEVEL_CRITICAL)
 	{
 		Critical(fmt.str());
 	}
@@ -183,10 +190,7 @@ void Log::Critical( string fmt )
 
 void Log::Error( boost::format &fmt )
 {
-	int ConsoleLogLevel = sConfig.GetIntDefault("Log.ConsoleLogLevel",LOGLEVEL_INFO);
-	int FileLogLevel = sConfig.GetIntDefault("Log.FileLogLevel",LOGLEVEL_WARNING);
-
-	if (ConsoleLogLevel >= LOGLEVEL_ERROR || FileLogLevel >= LOGLEVEL_ERROR)
+	if (ConsoleLogLevel() >= LOGLEVEL_ERROR || FileLogLevel() >= LOGLEVEL_ERROR)
 	{
 		Error(fmt.str());
 	}
@@ -199,10 +203,7 @@ void Log::Error( string fmt )
 
 void Log::Warning( boost::format &fmt )
 {
-	int ConsoleLogLevel = sConfig.GetIntDefault("Log.ConsoleLogLevel",LOGLEVEL_INFO);
-	int FileLogLevel = sConfig.GetIntDefault("Log.FileLogLevel",LOGLEVEL_WARNING);
-
-	if (ConsoleLogLevel >= LOGLEVEL_WARNING || FileLogLevel >= LOGLEVEL_WARNING)
+	if (ConsoleLogLevel() >= LOGLEVEL_WARNING || FileLogLevel() >= LOGLEVEL_WARNING)
 	{
 		Warning(fmt.str());
 	}
@@ -215,10 +216,7 @@ void Log::Warning( string fmt )
 
 void Log::Info( boost::format &fmt )
 {
-	int ConsoleLogLevel = sConfig.GetIntDefault("Log.ConsoleLogLevel",LOGLEVEL_INFO);
-	int FileLogLevel = sConfig.GetIntDefault("Log.FileLogLevel",LOGLEVEL_WARNING);
-
-	if (ConsoleLogLevel >= LOGLEVEL_INFO || FileLogLevel >= LOGLEVEL_INFO)
+	if (ConsoleLogLevel() >= LOGLEVEL_INFO || FileLogLevel() >= LOGLEVEL_INFO)
 	{
 		Info(fmt.str());
 	}
@@ -231,10 +229,7 @@ void Log::Info( string fmt )
 
 void Log::Debug( boost::format &fmt )
 {
-	int ConsoleLogLevel = sConfig.GetIntDefault("Log.ConsoleLogLevel",LOGLEVEL_INFO);
-	int FileLogLevel = sConfig.GetIntDefault("Log.FileLogLevel",LOGLEVEL_WARNING);
-
-	if (ConsoleLogLevel >= LOGLEVEL_DEBUG || FileLogLevel >= LOGLEVEL_DEBUG)
+	if (ConsoleLogLevel() >= LOGLEVEL_DEBUG || FileLogLevel() >= LOGLEVEL_DEBUG)
 	{
 		Debug(fmt.str());
 	}
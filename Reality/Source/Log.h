@@ -28,6 +28,7 @@
 
 #include "Singleton.h"
 #include "Threading/NativeMutex.h"
+#include "Config.h"
 
 class Log : public Singleton< Log >
 {
@@ -60,7 +61,12 @@ private:
 	void OutputConsole(LogLevel level,const string &str);
 	void OutputFile(LogLevel level,const string &str);
 	void Output(LogLevel level,const string &str);
+	// configured levels, checked on every log call so they're cached
+	int ConsoleLogLevel();
+	int FileLogLevel();
 
+	ConfigValue<int> consoleLogLevel;
+	ConfigValue<int> fileLogLevel;
 	NativeMutex printMutex;
 	NativeMutex fileMutex;
 	ofstream LogFile;
@@ -0,0 +1,142 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_MPSCQUEUETEST_H
+#define MXOEMU_MPSCQUEUETEST_H
+
+#define UNITTEST
+
+#include "Common.h"
+#include "Util.h"
+#include "Threading/Threading.h"
+#include "Threading/Queue.h"
+#include "Threading/MPSCQueue.h"
+
+// Throughput and latency of FQueue against MPSCQueue, with one producer per server
+// thread that queues database work (auth, margin, game, console) and a single consumer,
+// the way the database executors are fed.
+
+#if PLATFORM != PLATFORM_WIN32
+#include <sys/time.h>
+#endif
+
+static const uint32 BENCH_ITEMS_PER_PRODUCER = 250000;
+static const char *BENCH_PRODUCER_NAMES[] = { "auth", "margin", "game", "console" };
+static const uint32 BENCH_PRODUCERS = sizeof(BENCH_PRODUCER_NAMES)/sizeof(BENCH_PRODUCER_NAMES[0]);
+
+inline uint64 benchNowUS()
+{
+#if PLATFORM == PLATFORM_WIN32
+	LARGE_INTEGER freq, counter;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&counter);
+	return uint64(counter.QuadPart) * 1000000 / uint64(freq.QuadPart);
+#else
+	timeval theTime;
+	gettimeofday(&theTime, NULL);
+	return uint64(theTime.tv_sec) * 1000000 + theTime.tv_usec;
+#endif
+}
+
+struct BenchItem
+{
+	uint64 pushedAt;
+};
+
+template<class Q>
+class BenchProducer : public ThreadContext
+{
+public:
+	BenchProducer(Q &queue, BenchItem *items, const char *name, volatile uint32 *finished)
+		: m_queue(queue), m_items(items), m_name(name), m_finished(finished) {}
+
+	bool run()
+	{
+		SetThreadName(m_name);
+		for (uint32 i=0; i<BENCH_ITEMS_PER_PRODUCER; i++)
+		{
+			m_items[i].pushedAt = benchNowUS();
+			m_queue.push(&m_items[i]);
+		}
+		AtomicIncrement(m_finished);
+		return true;
+	}
+private:
+	Q &m_queue;
+	BenchItem *m_items;
+	const char *m_name;
+	volatile uint32 *m_finished;
+};
+
+template<class Q>
+void runQueueBench(const char *label)
+{
+	Q *theQueue = new Q();
+	const uint32 totalItems = BENCH_ITEMS_PER_PRODUCER * BENCH_PRODUCERS;
+	BenchItem *items = new BenchItem[totalItems];
+	vector<uint32> latencies;
+	latencies.reserve(totalItems);
+	volatile uint32 finished = 0;
+
+	uint64 startTime = benchNowUS();
+	for (uint32 i=0; i<BENCH_PRODUCERS; i++)
+		ThreadPool.ExecuteTask(new BenchProducer<Q>(*theQueue, &items[i*BENCH_ITEMS_PER_PRODUCER], BENCH_PRODUCER_NAMES[i], &finished));
+
+	while (latencies.size() < totalItems)
+	{
+		BenchItem *theItem = theQueue->pop();
+		if (theItem == NULL)
+			continue;
+
+		latencies.push_back(uint32(benchNowUS() - theItem->pushedAt));
+	}
+	uint64 elapsed = benchNowUS() - startTime;
+	if (elapsed == 0)
+		elapsed = 1;
+
+	while (AtomicLoad(&finished) < BENCH_PRODUCERS)
+		Sleep(1);
+
+	sort(latencies.begin(), latencies.end());
+	cout << format("%1%: %2% items from %3% producers in %4% ms, %5% items/s, latency us p50 %6% p99 %7% p99.9 %8% max %9%")
+		% label % totalItems % BENCH_PRODUCERS % (elapsed/1000) % (uint64(totalItems) * 1000000 / elapsed)
+		% latencies[latencies.size()/2] % latencies[latencies.size()*99/100] % latencies[latencies.size()*999/1000] % latencies.back() << std::endl;
+
+	delete[] items;
+	delete theQueue;
+}
+
+void runTest()
+{
+	ThreadPool.Startup();
+
+	for (int round=0; round<3; round++)
+	{
+		runQueueBench< FQueue<BenchItem*> >("FQueue");
+		runQueueBench< MPSCQueue<BenchItem*> >("MPSCQueue");
+	}
+}
+
+#endif
@@ -26,6 +26,10 @@
 //include a unit test at the very top if you want to run it
 //#include "SubPacketsTest.h"
 //#include "seqchecktest.h"
+//#include "MPSCQueueTest.h"
+//#include "CryptoWorkerPoolTest.h"
+//#include "SymmetricCryptoTest.h"
+//#include "PacketPipelineTest.h"
 
 #ifndef UNITTEST
 #include "Common.h"
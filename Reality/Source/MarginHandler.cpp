@@ -26,56 +26,118 @@
 #include "MarginHandler.h"
 #include "Common.h"
 #include "MarginSocket.h"
+#include "Log.h"
+#include "Database/DatabaseEnv.h"
+#include "SessionRegistry.h"
+#include "ListenerShards.h"
 
-MarginHandler::MarginHandler()
-:SocketHandler()
+MarginHandler::MarginHandler(uint32 shardIndex)
+:SocketHandler(), m_shardIndex(shardIndex), m_lastMetricsMS(0)
 {
+	m_dbCompletions.reset(new QueryCompletionQueue);
+	m_cryptoCompletions.reset(new CryptoCompletionQueue);
+
+	//db threads, crypto workers and the game thread poke this so Select returns as soon as there's work waiting
+	m_wakeup = new ShardWakeupSocket(*this);
+	m_wakeup->SetDeleteByHandler();
+	Add(m_wakeup);
+	m_dbCompletions->SetWakeup(boost::bind(&ShardWakeupSocket::Wake,m_wakeup));
+	m_cryptoCompletions->SetWakeup(boost::bind(&ShardWakeupSocket::Wake,m_wakeup));
+	sSessions.SetMarginWakeup(m_shardIndex,boost::bind(&ShardWakeupSocket::Wake,m_wakeup));
 }
 
 
 MarginHandler::~MarginHandler()
 {
+	sSessions.SetMarginWakeup(m_shardIndex,SessionRegistry::Wakeup());
+	m_dbCompletions->Close();
+	m_cryptoCompletions->Close();
 }
 
-vector<MarginSocket*> MarginHandler::FindByCharacterUID( uint64 charUID )
+void MarginHandler::Loop()
 {
-	vector<MarginSocket*> tempVect;
-	for (socket_m::iterator it = m_sockets.begin(); it != m_sockets.end(); it++)
+	m_dbCompletions->Drain();
+	m_cryptoCompletions->Drain();
+	RunSessionActions();
+	Select(0, 100000);                      // 100 ms
+
+	if (MetricsPublishDue(m_lastMetricsMS))
+		PublishMetrics();
+}
+
+void MarginHandler::PublishMetrics()
+{
+	string labels = (format("server=\"margin\",shard=\"%1%\"") % m_shardIndex).str();
+	PublishThreadMetrics(labels,&m_traffic);
+
+	//the listener and the wakeup socket are two of the sockets
+	size_t sockets = GetCount();
+	sMetrics.SetGauge("reality_clients","Clients connected to the server.",double(sockets > 2 ? sockets-2 : 0),labels);
+}
+
+void MarginHandler::RunSessionActions()
+{
+	vector<SessionRegistry::MarginAction> actions;
+	sSessions.TakeMarginActions(m_shardIndex,actions);
+	foreach(const SessionRegistry::MarginAction &theAction, actions)
 	{
-		Socket *p = it->second;
-		if (p == NULL)
-			continue;
-		TcpSocket *tcpSock = dynamic_cast<TcpSocket *>(p);
-		if (tcpSock == NULL)
-			continue;
-		MarginSocket *margSock = dynamic_cast<MarginSocket *>(tcpSock);
-		if (margSock == NULL)
+		MarginSocket *theSocket = FindByUniqueId(theAction.marginSocket);
+		if (theSocket == NULL)
+		{
+			//margin went away in the meantime, the game side can't carry on without it
+			if (theAction.type == SessionRegistry::MarginAction::ACTION_UDP_READY)
+			{
+				ERROR_LOG(format("Margin for session %1% gone before UDP connection was ready") % theAction.sessionId);
+				sSessions.ReportActionFailed(theAction.sessionId);
+			}
 			continue;
+		}
 
-		if (margSock->GetCharUID() == charUID)
+		switch (theAction.type)
 		{
-			tempVect.push_back(margSock);
+		case SessionRegistry::MarginAction::ACTION_UDP_READY:
+			if (theSocket->UdpReady() == false)
+			{
+				ERROR_LOG("Margin not ready for UDP connection");
+				theSocket->ForceDisconnect();
+				sSessions.ReportActionFailed(theAction.sessionId);
+			}
+			break;
+		case SessionRegistry::MarginAction::ACTION_DISCONNECT:
+			theSocket->ForceDisconnect();
+			break;
 		}
 	}
-	return tempVect;
 }
 
-class MarginSocket *MarginHandler::FindBySessionId( uint32 sessionId )
+void MarginHandler::OnCharacterLoaded( QueryResultVector &results, socketuid_t sockId, ByteBuffer packetData )
+{
+	//socket might have disconnected while the query was running
+	MarginSocket *theSocket = FindByUniqueId(sockId);
+	if (theSocket == NULL || results.size() < 1)
+		return;
+
+	theSocket->HandleCharacterLoaded(results[0].result,packetData);
+}
+
+void MarginHandler::OnCertVerified( socketuid_t sockId, CryptoJob &verifyJob )
+{
+	MarginSocket *theSocket = FindByUniqueId(sockId);
+	if (theSocket == NULL)
+		return;
+
+	theSocket->HandleCertVerified(verifyJob);
+}
+
+class MarginSocket *MarginHandler::FindByUniqueId( socketuid_t uid )
 {
 	for (socket_m::iterator it = m_sockets.begin(); it != m_sockets.end(); it++)
 	{
 		Socket *p = it->second;
-		if (p == NULL)
-			continue;
-		TcpSocket *tcpSock = dynamic_cast<TcpSocket *>(p);
-		if (tcpSock == NULL)
-			continue;
-		MarginSocket *margSock = dynamic_cast<MarginSocket *>(tcpSock);
-		if (margSock == NULL)
+		if (p == NULL || p->UniqueIdentifier() != uid)
 			continue;
 
-		if (margSock->GetSessionId() == sessionId)
-			return margSock;
+		return dynamic_cast<MarginSocket *>(p);
 	}
 	return NULL;
 }
\ No newline at end of file
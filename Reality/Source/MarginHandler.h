@@ -28,15 +28,40 @@
 
 #include <Sockets/SocketHandler.h>
 #include "Common.h"
+#include "ByteBuffer.h"
+#include "CallBack.h"
+#include "CryptoWorkerPool.h"
+#include "Metrics.h"
 
+// One margin server shard: its sockets, and the db/crypto results coming back for them
 class MarginHandler : public SocketHandler
 {
 public:
-	MarginHandler();
+	MarginHandler(uint32 shardIndex);
 	~MarginHandler();
 
-	vector<class MarginSocket*> FindByCharacterUID(uint64 charUID);
-	class MarginSocket *FindBySessionId(uint32 sessionId);
+	uint32 GetShardIndex() { return m_shardIndex; }
+	void Loop();
+	TrafficCounters &GetTraffic() { return m_traffic; }
+	class MarginSocket *FindByUniqueId(socketuid_t uid);
+
+	shared_ptr<class QueryCompletionQueue> GetDBCompletions() { return m_dbCompletions; }
+	void OnCharacterLoaded(QueryResultVector &results, socketuid_t sockId, ByteBuffer packetData);
+
+	shared_ptr<CryptoCompletionQueue> GetCryptoCompletions() { return m_cryptoCompletions; }
+	void OnCertVerified(socketuid_t sockId, CryptoJob &verifyJob);
+private:
+	//things the game thread asked for through the session registry
+	void RunSessionActions();
+
+	void PublishMetrics();
+
+	uint32 m_shardIndex;
+	TrafficCounters m_traffic;
+	uint32 m_lastMetricsMS;
+	shared_ptr<class QueryCompletionQueue> m_dbCompletions;
+	shared_ptr<CryptoCompletionQueue> m_cryptoCompletions;
+	class ShardWakeupSocket *m_wakeup;
 };
 
 #endif // _MARGINHANDLER_H
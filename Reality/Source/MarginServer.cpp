@@ -28,73 +28,98 @@
 #include "MarginSocket.h"
 #include "Log.h"
 #include "Config.h"
+#include "AuthTicketCache.h"
+#include "Threading/Threading.h"
 
 initialiseSingleton( MarginServer );
 
 MarginServer::MarginServer()
 {
-	listenSocketInst = NULL;
 }
 
 MarginServer::~MarginServer()
 {
-	if (listenSocketInst != NULL)
-	{
-		delete listenSocketInst;
-	}
 }
 
 void MarginServer::Start()
 {
 	string Interface = sConfig.GetStringDefault("MarginServer.IP","0.0.0.0");
-    int Port = sConfig.GetIntDefault("MarginServer.Port",10000);
-	INFO_LOG(format("Starting Margin server on port %1%") % Port);	
+	int Port = sConfig.GetIntDefault("MarginServer.Port",10000);
+	uint32 numShards = ListenerShardLimit(sConfig.GetIntDefault("MarginServer.ThreadCount",1));
+	INFO_LOG(format("Starting Margin server on port %1% with %2% threads") % Port % numShards);	
 
-	if (listenSocketInst != NULL)
-	{
-		delete listenSocketInst;
-	}
-	listenSocketInst = new MarginListenSocket(marginSocketHandler);
+	sTickets.SetCapacity(sConfig.GetIntDefault("MarginServer.TicketCacheSize",1024));
 
-	bool bindFailed=false;
-	try
+	for (uint32 i=0;i<numShards;i++)
 	{
-		if (listenSocketInst->Bind(Port)!=0)
+		MarginHandler *theHandler = new MarginHandler(i);
+		MarginListenSocket *theListener = new MarginListenSocket(*theHandler);
+		bool bindFailed=false;
+		try
+		{
+			if (theListener->Bind(Port)!=0)
+				bindFailed=true;
+		}
+		catch (Exception)
+		{
 			bindFailed=true;
+		}
+		if (bindFailed)
+		{
+			ERROR_LOG(format("Error binding MarginServer thread %1% to port %2%") % i % Port);
+			delete theListener;
+			//the first one sticks around so Loop has something to run
+			if (i == 0)
+				m_handlers.push_back(theHandler);
+			else
+				delete theHandler;
+
+			break;
+		}
+		theHandler->Add(theListener);
+		m_handlers.push_back(theHandler);
+		m_listenSockets.push_back(theListener);
 	}
-	catch (Exception)
-	{
-		bindFailed=true;
-	}
-	if (bindFailed)
+
+	//the first shard runs on the margin thread itself
+	for (uint32 i=1;i<m_handlers.size();i++)
 	{
-		ERROR_LOG(format("Error binding MarginServer to port %1%") % Port);
-		return;
+		ListenerShardThread *theThread = new ListenerShardThread((format("Margin Server Thread %1%") % i).str(),
+			boost::bind(&MarginHandler::Loop,m_handlers[i]));
+		m_shardThreads.push_back(theThread);
+		ThreadPool.ExecuteTask(theThread);
 	}
-	marginSocketHandler.Add(listenSocketInst);
 }
 
 void MarginServer::Stop()
 {
 	INFO_LOG("Margin Server shutdown");
-	if (listenSocketInst != NULL)
+	for (uint32 i=0;i<m_shardThreads.size();i++)
+		m_shardThreads[i]->Terminate();
+	for (uint32 i=0;i<m_shardThreads.size();i++)
 	{
-		delete listenSocketInst;
-		listenSocketInst = NULL;
+		while (!m_shardThreads[i]->IsFinished())
+			Sleep(10);
+
+		delete m_shardThreads[i];
 	}
-}
+	m_shardThreads.clear();
 
-void MarginServer::Loop(void)
-{
-	marginSocketHandler.Select(0, 100000);// 100 ms
+	for (uint32 i=0;i<m_listenSockets.size();i++)
+		delete m_listenSockets[i];
+	m_listenSockets.clear();
+	for (uint32 i=0;i<m_handlers.size();i++)
+		delete m_handlers[i];
+	m_handlers.clear();
 }
 
-vector<MarginSocket*> MarginServer::GetSocketsForCharacterUID( uint64 charUID )
+void MarginServer::Loop(void)
 {
-	return marginSocketHandler.FindByCharacterUID(charUID);
-}
+	if (m_handlers.empty())
+	{
+		Sleep(100);
+		return;
+	}
 
-MarginSocket *MarginServer::GetSocketBySessionId( uint32 sessionId )
-{
-	return marginSocketHandler.FindBySessionId(sessionId);
+	m_handlers[0]->Loop();
 }
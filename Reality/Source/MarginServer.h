@@ -29,7 +29,7 @@
 #include "Singleton.h"
 #include "MarginHandler.h"
 #include "MarginSocket.h"
-#include <Sockets/ListenSocket.h>
+#include "ListenerShards.h"
 
 class MarginServer : public Singleton <MarginServer>
 {
@@ -38,14 +38,14 @@ public:
 	~MarginServer();;
 	void Start();
 	void Stop();
+	// services the first shard, the rest run on threads of their own
 	void Loop();
-
-	vector<class MarginSocket*> GetSocketsForCharacterUID(uint64 charUID);
-	class MarginSocket *GetSocketBySessionId(uint32 sessionId);
 private:
-	MarginHandler marginSocketHandler;
-	typedef ListenSocket<MarginSocket> MarginListenSocket;
-	MarginListenSocket *listenSocketInst;
+	//one handler, listener and thread per shard, they share the port through SO_REUSEPORT
+	typedef ReusePortListenSocket<MarginSocket> MarginListenSocket;
+	vector<MarginHandler*> m_handlers;
+	vector<MarginListenSocket*> m_listenSockets;
+	vector<ListenerShardThread*> m_shardThreads;
 };
 
 
@@ -32,6 +32,8 @@
 #include "Crypto.h"
 #include "SymmetricCrypto.h"
 #include "EncryptedPacket.h"
+#include "SignedDataStruct.h"
+#include "CryptoWorkerPool.h"
 
 class MarginSocket : public TCPVarLenSocket
 {
@@ -44,26 +46,25 @@ public:
 	uint32 GetSessionId() {return sessionId;}
 	uint64 GetCharUID() {return charId;};
 	uint32 GetWorldCharId() {return worldCharId;}
-	vector<byte> GetTwofishKey() 
-	{
-		vector<byte> tempVect(sizeof(twofishKey));
-		memcpy(&tempVect[0],&twofishKey[0],tempVect.size());
-		return tempVect;
-	}
 	void ForceDisconnect() 
 	{
 		this->SetCloseAndDelete(true);
 	}
-	bool UdpReady(class GameClient *theClient);
+	bool UdpReady();
+	void HandleCertVerified(CryptoJob &verifyJob);
+	void HandleCharacterLoaded(class QueryResult *result, ByteBuffer &packetData);
 private:
+	//the shard this socket belongs to
+	class MarginHandler &GetMarginHandler() { return (class MarginHandler&)Handler(); }
+	TrafficCounters *GetTrafficCounters();
+
 	void ProcessData(const byte *buf,size_t len);
+	void PublishSession();
+	//signature on the auth ticket checks out, carry on with CERT_ConnectRequest
+	void SendCertChallenge();
 	void SendCrypted(TwofishEncryptedPacket &cryptedPacket);
 
-	void NewCharacterReply()
-	{
-		numCharacterReplies=0;
-	}
-	void SendCharacterReply(uint16 shortAfterId,bool lastPacket,uint8 opcode,ByteBuffer theData);
+	void SendCharacterReplies();
 
 	uint32 m_userId;
 	string m_username;
@@ -77,10 +78,12 @@ private:
 	uint32 sessionId;
 	uint64 charId;
 
+	//only ever holds a ticket whose signature has been checked
+	signedDataStruct m_signedData;
+	bool m_certVerifyPending;
 	byte challenge[16];
 	byte weirdSequenceOfBytes[16];
 	string soeChatString;
-	uint8 numCharacterReplies;
 
 	uint32 worldCharId;
 
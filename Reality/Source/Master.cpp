@@ -35,11 +35,13 @@
 #include "AuthRunnable.h"
 #include "MarginRunnable.h"
 #include "GameRunnable.h"
+#include "MetricsRunnable.h"
 #include "ConsoleThread.h"
 
 createFileSingleton( Master );
 
 volatile bool Master::m_stopEvent = false;
+volatile bool Master::m_reloadConfigEvent = false;
 
 void Master::_OnSignal(int s)
 {
@@ -58,6 +60,10 @@ void Master::_OnSignal(int s)
         case SIGBREAK:
             Master::m_stopEvent = true;
             break;
+#else
+        case SIGHUP:
+            Master::m_reloadConfigEvent = true;
+            break;
 #endif
     }
 
@@ -110,6 +116,8 @@ bool Master::Run()
 	ThreadPool.ExecuteTask(marginRun);
 	GameRunnable *gameRun = new GameRunnable();
 	ThreadPool.ExecuteTask(gameRun);
+	MetricsRunnable *metricsRun = new MetricsRunnable();
+	ThreadPool.ExecuteTask(metricsRun);
 
 	//spawn console thread
 	ConsoleThread *consoleRun = new ConsoleThread();
@@ -117,12 +125,25 @@ bool Master::Run()
 
 	while (!Master::m_stopEvent)
 	{
+		//not safe to do from the signal handler itself
+		if (Master::m_reloadConfigEvent)
+		{
+			Master::m_reloadConfigEvent = false;
+			sConfig.Reload();
+		}
 		Sleep(100);
 	}
 
 	authRun->Terminate();
 	marginRun->Terminate();
 	gameRun->Terminate();
+	metricsRun->Terminate();
+
+	//game server flushes character data on the way out, let it finish before the db goes
+	while (GameServer::getSingletonPtr() != NULL)
+	{
+		Sleep(100);
+	}
 
 	consoleRun->Terminate();
 	
@@ -158,9 +179,10 @@ bool Master::_StartDB()
 	}
 
 	// Initialize it
+	sDatabase.SetPingIdleTime(sConfig.GetIntDefault("Database.PingIdleTime", 30) * 1000);
 	if(!sDatabase.Initialize(hostname.c_str(), (unsigned int)port, username.c_str(),
 		password.c_str(), database.c_str(), sConfig.GetIntDefault("Database.ConnectionCount", 5),
-		16384))
+		16384, sConfig.GetIntDefault("Database.AsyncThreadCount", 2), sConfig.GetIntDefault("Database.ExecutorThreadCount", 2)))
 	{
 		CRITICAL_LOG("sql: Main database initialization failed. Exiting.");
 		return false;
@@ -183,6 +205,8 @@ void Master::_HookSignals()
     signal(SIGABRT, _OnSignal);
 #if PLATFORM == PLATFORM_WIN32
     signal(SIGBREAK, _OnSignal);
+#else
+    signal(SIGHUP, _OnSignal);
 #endif
 }
 
@@ -194,6 +218,8 @@ void Master::_UnhookSignals()
     signal(SIGABRT, 0);
 #if PLATFORM == PLATFORM_WIN32
     signal(SIGBREAK, 0);
+#else
+    signal(SIGHUP, 0);
 #endif
 
 }
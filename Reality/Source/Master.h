@@ -36,6 +36,7 @@ class Master : public Singleton<Master>
         bool Run();
 
         static volatile bool m_stopEvent;
+        static volatile bool m_reloadConfigEvent;
     private:
 		bool _StartDB();
 		void _StopDB();
@@ -0,0 +1,89 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#include "Metrics.h"
+
+createFileSingleton( MetricsRegistry );
+
+MetricsRegistry::MetricsRegistry()
+{
+}
+
+void MetricsRegistry::SetCounter( const char *name, const char *help, double value, const string &labels )
+{
+	Set(name,"counter",help,value,labels);
+}
+
+void MetricsRegistry::SetGauge( const char *name, const char *help, double value, const string &labels )
+{
+	Set(name,"gauge",help,value,labels);
+}
+
+void MetricsRegistry::Set( const char *name, const char *type, const char *help, double value, const string &labels )
+{
+	m_lock.Acquire();
+	metric &theMetric = m_metrics[name];
+	if (theMetric.type.empty())
+	{
+		theMetric.type = type;
+		theMetric.help = help;
+	}
+	theMetric.values[labels] = value;
+	m_lock.Release();
+}
+
+string MetricsRegistry::Render()
+{
+	stringstream out;
+
+	m_lock.Acquire();
+	for (map<string,metric>::iterator it=m_metrics.begin();it!=m_metrics.end();++it)
+	{
+		out << "# HELP " << it->first << " " << it->second.help << "\n";
+		out << "# TYPE " << it->first << " " << it->second.type << "\n";
+		for (map<string,double>::iterator val=it->second.values.begin();val!=it->second.values.end();++val)
+		{
+			out << it->first;
+			if (!val->first.empty())
+				out << "{" << val->first << "}";
+			out << format(" %.15g\n") % val->second;
+		}
+	}
+	m_lock.Release();
+
+	return out.str();
+}
+
+void PublishThreadMetrics( const string &labels, const TrafficCounters *traffic )
+{
+	sMetrics.SetCounter("reality_thread_cpu_seconds_total","CPU time used by the thread.",getThreadCPUTimeUS() / 1000000.0,labels);
+	if (traffic == NULL)
+		return;
+
+	sMetrics.SetCounter("reality_packets_received_total","Packets (frames on TCP, datagrams on UDP) received.",double(traffic->packetsIn),labels);
+	sMetrics.SetCounter("reality_bytes_received_total","Bytes received.",double(traffic->bytesIn),labels);
+	sMetrics.SetCounter("reality_packets_sent_total","Packets (frames on TCP, datagrams on UDP) sent.",double(traffic->packetsOut),labels);
+	sMetrics.SetCounter("reality_bytes_sent_total","Bytes sent.",double(traffic->bytesOut),labels);
+}
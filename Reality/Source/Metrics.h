@@ -0,0 +1,95 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_METRICS_H
+#define MXOEMU_METRICS_H
+
+#include "Common.h"
+#include "Singleton.h"
+#include "Timer.h"
+#include "Threading/NativeMutex.h"
+
+// Packets and bytes through one thread's sockets, only ever touched by that thread
+struct TrafficCounters
+{
+	TrafficCounters() : packetsIn(0), bytesIn(0), packetsOut(0), bytesOut(0) {}
+
+	void CountIn(size_t bytes) { packetsIn++; bytesIn += bytes; }
+	void CountOut(size_t bytes) { packetsOut++; bytesOut += bytes; }
+
+	uint64 packetsIn;
+	uint64 bytesIn;
+	uint64 packetsOut;
+	uint64 bytesOut;
+};
+
+// Latest value of every counter and gauge the metrics endpoint serves.
+// Each thread keeps its own numbers in plain members and copies them in here about once a
+// second (see MetricsPublishDue), so the endpoint only ever reads this copy, never the
+// structures the numbers came from. One lock covers everything, it's taken a few dozen times a second.
+class MetricsRegistry : public Singleton<MetricsRegistry>
+{
+public:
+	MetricsRegistry();
+
+	// labels go in as prometheus writes them, e.g. server="margin",shard="1"
+	void SetCounter(const char *name, const char *help, double value, const string &labels="");
+	void SetGauge(const char *name, const char *help, double value, const string &labels="");
+
+	// everything in the prometheus text exposition format
+	string Render();
+private:
+	void Set(const char *name, const char *type, const char *help, double value, const string &labels);
+
+	struct metric
+	{
+		string type;
+		string help;
+		map<string,double> values; //by labels
+	};
+
+	NativeMutex m_lock;
+	map<string,metric> m_metrics;
+};
+
+#define sMetrics MetricsRegistry::getSingleton()
+
+static const uint32 METRICS_PUBLISH_INTERVAL_MS = 1000;
+
+// true about once a second, for threads to check every loop before publishing
+inline bool MetricsPublishDue(uint32 &lastPublishMS)
+{
+	uint32 now = getMSTime();
+	if (now - lastPublishMS < METRICS_PUBLISH_INTERVAL_MS)
+		return false;
+
+	lastPublishMS = now;
+	return true;
+}
+
+// the calling thread's traffic and cpu time under the given labels
+void PublishThreadMetrics(const string &labels, const TrafficCounters *traffic=NULL);
+
+#endif
@@ -0,0 +1,131 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#include "Common.h"
+#include "MetricsServer.h"
+#include "Metrics.h"
+#include "Log.h"
+#include "Config.h"
+#include "Database/DatabaseEnv.h"
+
+initialiseSingleton( MetricsServer );
+
+void MetricsSocket::Exec()
+{
+	if (GetUri() != "/metrics")
+	{
+		Respond("404","Not Found","text/plain","Try /metrics\n");
+		return;
+	}
+
+	sMetricsServer.Publish();
+	Respond("200","OK","text/plain; version=0.0.4",sMetrics.Render());
+}
+
+void MetricsSocket::Respond( const string &status, const string &statusText, const string &contentType, const string &body )
+{
+	SetStatus(status);
+	SetStatusText(statusText);
+	AddResponseHeader("Content-Type",contentType);
+	AddResponseHeader("Content-Length",(format("%1%") % body.size()).str());
+	AddResponseHeader("Connection","close");
+	SendResponse();
+	SendBuf(body.data(),body.size());
+	SetCloseAndDelete();
+}
+
+MetricsServer::MetricsServer()
+{
+	m_handler = NULL;
+	m_listenSocket = NULL;
+	m_lastPublishMS = 0;
+}
+
+MetricsServer::~MetricsServer()
+{
+}
+
+void MetricsServer::Start()
+{
+	string Interface = sConfig.GetStringDefault("Metrics.IP","127.0.0.1");
+	int Port = sConfig.GetIntDefault("Metrics.Port",0);
+	if (Port <= 0)
+		return;
+
+	INFO_LOG(format("Starting Metrics endpoint on http://%1%:%2%/metrics") % Interface % Port);
+
+	m_handler = new SocketHandler();
+	m_listenSocket = new ListenSocket<MetricsSocket>(*m_handler);
+	bool bindFailed=false;
+	try
+	{
+		if (m_listenSocket->Bind(Interface,Port)!=0)
+			bindFailed=true;
+	}
+	catch (Exception)
+	{
+		bindFailed=true;
+	}
+	if (bindFailed)
+	{
+		ERROR_LOG(format("Error binding Metrics endpoint to %1%:%2%") % Interface % Port);
+		delete m_listenSocket;
+		m_listenSocket = NULL;
+		delete m_handler;
+		m_handler = NULL;
+		return;
+	}
+	m_handler->Add(m_listenSocket);
+}
+
+void MetricsServer::Stop()
+{
+	delete m_listenSocket;
+	m_listenSocket = NULL;
+	delete m_handler;
+	m_handler = NULL;
+}
+
+void MetricsServer::Loop()
+{
+	if (m_handler == NULL)
+	{
+		Sleep(100);
+		return;
+	}
+
+	Publish();
+	m_handler->Select(0, 100000);                      // 100 ms
+}
+
+void MetricsServer::Publish()
+{
+	if (!MetricsPublishDue(m_lastPublishMS))
+		return;
+
+	PublishThreadMetrics("server=\"metrics\"");
+	//the database keeps its numbers under locks of its own, so they're pulled from here
+	sDatabase.PublishMetrics();
+}
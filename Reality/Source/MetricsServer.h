@@ -0,0 +1,67 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_METRICSSERVER_H
+#define MXOEMU_METRICSSERVER_H
+
+#include "Common.h"
+#include "Singleton.h"
+#include <Sockets/SocketHandler.h>
+#include <Sockets/ListenSocket.h>
+#include <Sockets/HttpdSocket.h>
+
+// Answers GET /metrics with the registry in prometheus text format, 404 for anything else
+class MetricsSocket : public HttpdSocket
+{
+public:
+	MetricsSocket(ISocketHandler &h) : HttpdSocket(h) {}
+
+	void Exec();
+private:
+	void Respond(const string &status, const string &statusText, const string &contentType, const string &body);
+};
+
+// Serves the metrics endpoint on a thread of its own, off unless Metrics.Port is set.
+// Binds to localhost by default, there's no authentication on it.
+class MetricsServer : public Singleton<MetricsServer>
+{
+public:
+	MetricsServer();
+	~MetricsServer();
+
+	void Start();
+	void Stop();
+	void Loop();
+	// also done before every scrape, so what gets served is never more than a second old
+	void Publish();
+private:
+	SocketHandler *m_handler;
+	ListenSocket<MetricsSocket> *m_listenSocket;
+	uint32 m_lastPublishMS;
+};
+
+#define sMetricsServer MetricsServer::getSingleton()
+
+#endif
@@ -0,0 +1,428 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#include "NetImpairment.h"
+#include "Config.h"
+#include "Log.h"
+#include "Timer.h"
+#include "Metrics.h"
+
+createFileSingleton( NetImpairment );
+
+ImpairmentProfile::ImpairmentProfile()
+{
+	latencyMS = 0;
+	jitterMS = 0;
+	lossPercent = 0;
+	burstEnterPercent = 0;
+	burstExitPercent = 0;
+	burstLossPercent = 100;
+	duplicatePercent = 0;
+	reorderPercent = 0;
+	reorderDelayMS = 0;
+}
+
+bool ImpairmentProfile::IsActive() const
+{
+	return latencyMS > 0 || jitterMS > 0 || lossPercent > 0 || burstEnterPercent > 0 ||
+		duplicatePercent > 0 || (reorderPercent > 0 && reorderDelayMS > 0);
+}
+
+bool ImpairmentProfile::Set( const string &key, const string &value )
+{
+	try
+	{
+		if (key == "latency")
+			latencyMS = lexical_cast<uint32>(value);
+		else if (key == "jitter")
+			jitterMS = lexical_cast<uint32>(value);
+		else if (key == "loss")
+			lossPercent = lexical_cast<float>(value);
+		else if (key == "burstEnter")
+			burstEnterPercent = lexical_cast<float>(value);
+		else if (key == "burstExit")
+			burstExitPercent = lexical_cast<float>(value);
+		else if (key == "burstLoss")
+			burstLossPercent = lexical_cast<float>(value);
+		else if (key == "duplicate")
+			duplicatePercent = lexical_cast<float>(value);
+		else if (key == "reorder")
+			reorderPercent = lexical_cast<float>(value);
+		else if (key == "reorderDelay")
+			reorderDelayMS = lexical_cast<uint32>(value);
+		else
+			return false;
+	}
+	catch (boost::bad_lexical_cast &)
+	{
+		return false;
+	}
+	return true;
+}
+
+string ImpairmentProfile::ToString() const
+{
+	if (!IsActive())
+		return "off";
+
+	return (format("latency=%1% jitter=%2% loss=%3% burstEnter=%4% burstExit=%5% burstLoss=%6% duplicate=%7% reorder=%8% reorderDelay=%9%")
+		% latencyMS % jitterMS % lossPercent % burstEnterPercent % burstExitPercent % burstLossPercent
+		% duplicatePercent % reorderPercent % reorderDelayMS).str();
+}
+
+NetImpairment::NetImpairment()
+{
+	m_enabled = false;
+	m_seed = 1;
+	m_lastStatusMS = 0;
+	m_status = "Network impairment is off";
+}
+
+void NetImpairment::Configure()
+{
+	m_seed = uint64(sConfig.GetIntDefault("Impairment.Seed", 1));
+
+	ImpairmentProfile theProfile;
+	if (sConfig.GetBoolDefault("Impairment.Enabled", false))
+	{
+		theProfile.latencyMS = sConfig.GetIntDefault("Impairment.LatencyMS", 0);
+		theProfile.jitterMS = sConfig.GetIntDefault("Impairment.JitterMS", 0);
+		theProfile.lossPercent = sConfig.GetFloatDefault("Impairment.LossPercent", 0);
+		theProfile.burstEnterPercent = sConfig.GetFloatDefault("Impairment.BurstEnterPercent", 0);
+		theProfile.burstExitPercent = sConfig.GetFloatDefault("Impairment.BurstExitPercent", 0);
+		theProfile.burstLossPercent = sConfig.GetFloatDefault("Impairment.BurstLossPercent", 100);
+		theProfile.duplicatePercent = sConfig.GetFloatDefault("Impairment.DuplicatePercent", 0);
+		theProfile.reorderPercent = sConfig.GetFloatDefault("Impairment.ReorderPercent", 0);
+		theProfile.reorderDelayMS = sConfig.GetIntDefault("Impairment.ReorderDelayMS", 0);
+	}
+	m_globalProfile = theProfile;
+
+	m_globalClients.clear();
+	stringstream clientList(sConfig.GetStringDefault("Impairment.Clients", ""));
+	string theClient;
+	while (clientList >> theClient)
+		m_globalClients.push_back(theClient);
+
+	UpdateEnabled();
+	if (m_globalProfile.IsActive())
+	{
+		INFO_LOG(format("Network impairment on for %1%: %2%")
+			% (m_globalClients.empty() ? string("all clients") : sConfig.GetStringDefault("Impairment.Clients", ""))
+			% m_globalProfile.ToString());
+	}
+	RefreshStatus();
+}
+
+void NetImpairment::SetProfile( const string &address, const ImpairmentProfile &profile )
+{
+	m_lock.Acquire();
+	m_pendingProfiles.push_back(std::make_pair(address,profile));
+	m_lock.Release();
+}
+
+void NetImpairment::ClearProfile( const string &address )
+{
+	m_lock.Acquire();
+	m_pendingClears.push_back(address);
+	m_lock.Release();
+}
+
+string NetImpairment::GetStatus()
+{
+	m_lock.Acquire();
+	string theStatus = m_status;
+	m_lock.Release();
+	return theStatus;
+}
+
+void NetImpairment::Update()
+{
+	ApplyPending();
+
+	if (getMSTime() - m_lastStatusMS >= 1000)
+		RefreshStatus();
+}
+
+void NetImpairment::ApplyPending()
+{
+	vector< std::pair<string,ImpairmentProfile> > profiles;
+	vector<string> clears;
+	m_lock.Acquire();
+	profiles.swap(m_pendingProfiles);
+	clears.swap(m_pendingClears);
+	m_lock.Release();
+
+	if (profiles.empty() && clears.empty())
+		return;
+
+	for (size_t i=0;i<profiles.size();i++)
+	{
+		if (profiles[i].first == "all")
+		{
+			m_globalProfile = profiles[i].second;
+			m_globalClients.clear();
+		}
+		else
+		{
+			m_ownProfiles[profiles[i].first] = profiles[i].second;
+		}
+	}
+	foreach(const string &theAddress, clears)
+	{
+		if (theAddress == "all")
+		{
+			m_globalProfile = ImpairmentProfile();
+			m_ownProfiles.clear();
+		}
+		else
+		{
+			m_ownProfiles.erase(theAddress);
+		}
+	}
+
+	UpdateEnabled();
+	//whatever is held back still goes out, just without adding more to it
+	RefreshStatus();
+}
+
+void NetImpairment::UpdateEnabled()
+{
+	m_enabled = m_globalProfile.IsActive();
+	for (map<string,ImpairmentProfile>::const_iterator it=m_ownProfiles.begin();it!=m_ownProfiles.end();++it)
+	{
+		if (it->second.IsActive())
+			m_enabled = true;
+	}
+}
+
+static string addressIP( const string &address )
+{
+	return address.substr(0,address.find(':'));
+}
+
+const ImpairmentProfile & NetImpairment::ProfileFor( const string &address ) const
+{
+	map<string,ImpairmentProfile>::const_iterator it = m_ownProfiles.find(address);
+	if (it == m_ownProfiles.end())
+		it = m_ownProfiles.find(addressIP(address));
+	if (it != m_ownProfiles.end())
+		return it->second;
+
+	if (m_globalClients.empty())
+		return m_globalProfile;
+
+	foreach(const string &theClient, m_globalClients)
+	{
+		if (theClient == address || theClient == addressIP(address))
+			return m_globalProfile;
+	}
+
+	static const ImpairmentProfile noImpairment;
+	return noImpairment;
+}
+
+//splitmix64, spreads out seeds that only differ a little
+static uint64 mixSeed( uint64 seed )
+{
+	seed += 0x9E3779B97F4A7C15ULL;
+	seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+	return seed ^ (seed >> 31);
+}
+
+NetImpairment::clientState & NetImpairment::GetClient( const string &address )
+{
+	map<string,clientState>::iterator it = m_clients.find(address);
+	if (it != m_clients.end())
+		return it->second;
+
+	//FNV-1a of the address
+	uint64 addressHash = 14695981039346656037ULL;
+	for (size_t i=0;i<address.size();i++)
+	{
+		addressHash ^= uint8(address[i]);
+		addressHash *= 1099511628211ULL;
+	}
+
+	clientState &theClient = m_clients[address];
+	for (int i=0;i<NUM_DIRECTIONS;i++)
+	{
+		theClient.generator[i] = Generator(mixSeed(m_seed ^ addressHash ^ (uint64(i+1) << 56)));
+		theClient.inBurst[i] = false;
+	}
+	return theClient;
+}
+
+void NetImpairment::ForgetClient( const string &address )
+{
+	m_clients.erase(address);
+}
+
+uint32 NetImpairment::Impair( Direction direction, const string &address, const sockaddr_in &addr, const char *data, size_t len )
+{
+	const ImpairmentProfile &theProfile = ProfileFor(address);
+	if (!theProfile.IsActive())
+		return 1;
+
+	clientState &theClient = GetClient(address);
+	Generator &theGenerator = theClient.generator[direction];
+	impairmentStats &theStats = m_stats[direction];
+
+	//Gilbert-Elliott, only when bursts are configured so plain loss stays Bernoulli
+	bool &inBurst = theClient.inBurst[direction];
+	if (theProfile.burstEnterPercent > 0)
+	{
+		if (inBurst)
+		{
+			if (theGenerator.Chance(theProfile.burstExitPercent))
+				inBurst = false;
+		}
+		else if (theGenerator.Chance(theProfile.burstEnterPercent))
+		{
+			inBurst = true;
+		}
+	}
+	else
+	{
+		inBurst = false;
+	}
+
+	if (theGenerator.Chance(inBurst ? theProfile.burstLossPercent : theProfile.lossPercent))
+	{
+		theStats.dropped++;
+		if (inBurst)
+			theStats.burstDropped++;
+		return 0;
+	}
+	theStats.passed++;
+
+	uint32 copies = 1;
+	if (theGenerator.Chance(theProfile.duplicatePercent))
+	{
+		theStats.duplicated++;
+		copies++;
+	}
+
+	uint32 immediate = 0;
+	uint32 currTime = getMSTime();
+	for (uint32 i=0;i<copies;i++)
+	{
+		int32 delayMS = int32(theProfile.latencyMS) + theGenerator.Spread(theProfile.jitterMS);
+		if (delayMS < 0)
+			delayMS = 0;
+		if (theProfile.reorderDelayMS > 0 && theGenerator.Chance(theProfile.reorderPercent))
+		{
+			theStats.reordered++;
+			delayMS += theProfile.reorderDelayMS;
+		}
+
+		if (delayMS == 0)
+		{
+			immediate++;
+			continue;
+		}
+
+		Datagram theDatagram;
+		theDatagram.direction = direction;
+		theDatagram.address = address;
+		theDatagram.addr = addr;
+		theDatagram.data.assign(data,len);
+		m_held.insert(heldType::value_type(currTime+delayMS,theDatagram));
+		theStats.delayed++;
+	}
+	return immediate;
+}
+
+void NetImpairment::TakeDue( vector<Datagram> &due )
+{
+	if (m_held.empty())
+		return;
+
+	uint32 currTime = getMSTime();
+	heldType::iterator it = m_held.begin();
+	while (it != m_held.end() && it->first <= currTime)
+	{
+		due.push_back(it->second);
+		m_held.erase(it++);
+	}
+}
+
+void NetImpairment::RefreshStatus()
+{
+	const char *directionNames[NUM_DIRECTIONS] = {"in","out"};
+
+	stringstream out;
+	if (!m_enabled)
+	{
+		out << "Network impairment is off" << std::endl;
+	}
+	else
+	{
+		out << format("Network impairment with seed %1%, %2% datagrams held back") % m_seed % m_held.size() << std::endl;
+		out << "  all";
+		if (!m_globalClients.empty())
+		{
+			out << " of";
+			foreach(const string &theClient, m_globalClients)
+				out << " " << theClient;
+		}
+		out << ": " << m_globalProfile.ToString() << std::endl;
+		for (map<string,ImpairmentProfile>::const_iterator it=m_ownProfiles.begin();it!=m_ownProfiles.end();++it)
+			out << "  " << it->first << ": " << it->second.ToString() << std::endl;
+	}
+	for (int i=0;i<NUM_DIRECTIONS;i++)
+	{
+		const impairmentStats &theStats = m_stats[i];
+		if (theStats.passed == 0 && theStats.dropped == 0)
+			continue;
+
+		out << format("  %1%: %2% passed, %3% dropped (%4% in bursts), %5% duplicated, %6% delayed, %7% reordered")
+			% directionNames[i] % theStats.passed % theStats.dropped % theStats.burstDropped
+			% theStats.duplicated % theStats.delayed % theStats.reordered << std::endl;
+	}
+
+	m_lock.Acquire();
+	m_status = out.str();
+	m_lock.Release();
+	m_lastStatusMS = getMSTime();
+}
+
+void NetImpairment::PublishMetrics()
+{
+	const char *directionNames[NUM_DIRECTIONS] = {"in","out"};
+
+	sMetrics.SetGauge("reality_impairment_held_datagrams","Datagrams the network impairment layer is holding back.",double(m_held.size()));
+	for (int i=0;i<NUM_DIRECTIONS;i++)
+	{
+		const impairmentStats &theStats = m_stats[i];
+		string labels = (format("direction=\"%1%\"") % directionNames[i]).str();
+		sMetrics.SetCounter("reality_impairment_passed_total","Datagrams the network impairment layer let through.",double(theStats.passed),labels);
+		sMetrics.SetCounter("reality_impairment_dropped_total","Datagrams the network impairment layer dropped.",double(theStats.dropped),labels);
+		sMetrics.SetCounter("reality_impairment_burst_dropped_total","Datagrams the network impairment layer dropped during loss bursts.",double(theStats.burstDropped),labels);
+		sMetrics.SetCounter("reality_impairment_duplicated_total","Datagrams the network impairment layer duplicated.",double(theStats.duplicated),labels);
+		sMetrics.SetCounter("reality_impairment_delayed_total","Datagram copies the network impairment layer held back.",double(theStats.delayed),labels);
+		sMetrics.SetCounter("reality_impairment_reordered_total","Datagrams the network impairment layer held back extra to reorder them.",double(theStats.reordered),labels);
+	}
+}
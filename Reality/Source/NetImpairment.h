@@ -0,0 +1,166 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_NETIMPAIRMENT_H
+#define MXOEMU_NETIMPAIRMENT_H
+
+#include "Common.h"
+#include "Singleton.h"
+#include "Threading/NativeMutex.h"
+#include <Sockets/socket_include.h>
+
+// What the impairment layer does to one client's datagrams, the same in both directions
+struct ImpairmentProfile
+{
+	ImpairmentProfile();
+
+	bool IsActive() const;
+	// one key=value setting as the console takes them, false if it isn't one
+	bool Set(const string &key, const string &value);
+	string ToString() const;
+
+	uint32 latencyMS;
+	uint32 jitterMS;			// latency varies by up to this much either way
+	float lossPercent;			// independent loss, and the loss while not in a burst
+	float burstEnterPercent;	// Gilbert-Elliott: chance per datagram a loss burst starts
+	float burstExitPercent;		// and that one ends
+	float burstLossPercent;		// loss while in a burst
+	float duplicatePercent;
+	float reorderPercent;		// chance a datagram is held back an extra reorderDelayMS
+	uint32 reorderDelayMS;
+};
+
+// Optional layer on the game server's UDP traffic for tuning the RCC (resend times, ping multipliers),
+// drops, delays, duplicates and reorders datagrams in both directions. Everything it decides comes out
+// of a per client, per direction generator seeded from Impairment.Seed and the client's address, so the
+// same traffic gets impaired the same way every run.
+// Settings come from the Impairment.* config keys and can be changed per client (or for everyone)
+// with the impair console command. Held back datagrams go out from the game loop, so delays are only
+// as fine grained as the loop (a few ms).
+class NetImpairment : public Singleton<NetImpairment>
+{
+public:
+	enum Direction
+	{
+		INBOUND,
+		OUTBOUND,
+		NUM_DIRECTIONS
+	};
+
+	struct Datagram
+	{
+		Direction direction;
+		string address;
+		sockaddr_in addr;
+		string data;
+	};
+
+	NetImpairment();
+
+	// game thread, again after a config reload. Profiles set per client from the console stay
+	void Configure();
+
+	// any thread, takes effect on the game thread's next Update. "all" is the profile for clients without one of their own
+	void SetProfile(const string &address, const ImpairmentProfile &profile);
+	void ClearProfile(const string &address);
+	string GetStatus();
+
+	// everything below is game thread only
+	bool IsEnabled() const { return m_enabled; }
+	void Update();
+	// returns how many copies of the datagram to pass on right away, the ones for later are kept
+	uint32 Impair(Direction direction, const string &address, const sockaddr_in &addr, const char *data, size_t len);
+	// datagrams that were held back and are due now, in the order they're due
+	void TakeDue(vector<Datagram> &due);
+	// client went away, a new one from the same address starts over from the seed
+	void ForgetClient(const string &address);
+	void PublishMetrics();
+private:
+	// xorshift64*, small and the same everywhere
+	class Generator
+	{
+	public:
+		Generator(uint64 seed=1) : m_state(seed ? seed : 1) {}
+		uint64 Next()
+		{
+			m_state ^= m_state >> 12;
+			m_state ^= m_state << 25;
+			m_state ^= m_state >> 27;
+			return m_state * 2685821657736338717ULL;
+		}
+		// true percent% of the time
+		bool Chance(float percent) { return percent > 0 && (Next() >> 11) * (100.0 / 9007199254740992.0) < percent; }
+		// -range..range
+		int32 Spread(uint32 range) { return range ? int32(Next() % (2*range+1)) - int32(range) : 0; }
+	private:
+		uint64 m_state;
+	};
+
+	struct clientState
+	{
+		Generator generator[NUM_DIRECTIONS];
+		bool inBurst[NUM_DIRECTIONS];
+	};
+	clientState &GetClient(const string &address);
+	const ImpairmentProfile &ProfileFor(const string &address) const;
+	void ApplyPending();
+	void UpdateEnabled();
+	void RefreshStatus();
+
+	struct impairmentStats
+	{
+		impairmentStats() : passed(0), dropped(0), burstDropped(0), duplicated(0), delayed(0), reordered(0) {}
+
+		uint64 passed;
+		uint64 dropped;
+		uint64 burstDropped;
+		uint64 duplicated;
+		uint64 delayed;
+		uint64 reordered;
+	};
+
+	bool m_enabled;
+	uint64 m_seed;
+	ImpairmentProfile m_globalProfile;
+	vector<string> m_globalClients;			// who the global profile is for, everyone if empty
+	map<string,ImpairmentProfile> m_ownProfiles;
+	map<string,clientState> m_clients;
+
+	// held back datagrams by when they're due, ones due at the same time stay in order
+	typedef std::multimap<uint32,Datagram> heldType;
+	heldType m_held;
+	impairmentStats m_stats[NUM_DIRECTIONS];
+
+	// changes from other threads, and a status snapshot for them
+	NativeMutex m_lock;
+	vector< std::pair<string,ImpairmentProfile> > m_pendingProfiles;
+	vector<string> m_pendingClears;
+	string m_status;
+	uint32 m_lastStatusMS;
+};
+
+#define sImpairment NetImpairment::getSingleton()
+
+#endif
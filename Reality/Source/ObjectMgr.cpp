@@ -26,9 +26,53 @@
 #include "ObjectMgr.h"
 #include "PlayerObject.h"
 #include "GameClient.h"
+#include "GameServer.h"
 #include "Database/DatabaseEnv.h"
 
-uint32 ObjectMgr::constructPlayer( GameClient* requester, uint64 charUID )
+//doors that were opened count as closed again after this long
+const uint32 DOOR_AUTOCLOSE_MS = 30000;
+
+ObjectMgr::~ObjectMgr()
+{
+	//close events are bound to this
+	sEventMgr.CancelEvents(this);
+}
+
+void ObjectMgr::loadPlayer( GameClient* requester, uint64 charUID )
+{
+	if (requester == NULL)
+		throw ClientNotAvailable();
+
+	//client is looked up again by address when the results come back, it might be gone by then
+	AsyncQuery *loadQuery = new AsyncQuery(
+		new SQLClassCallbackP2<ObjectMgr,string,uint64>(this,&ObjectMgr::playerLoaded,requester->Address(),charUID),
+		sGame.getDBCompletions());
+	PlayerObject::AddLoadQueries(loadQuery,charUID);
+	sDatabase.QueueAsyncQuery(loadQuery);
+}
+
+void ObjectMgr::playerLoaded( QueryResultVector &results, string clientAddress, uint64 charUID )
+{
+	GameClient *requester = sGame.GetClientWithAddress(clientAddress);
+	if (requester == NULL || requester->GetCharacterId() != charUID)
+	{
+		DEBUG_LOG(format("playerLoaded(%1%): Client went away while character %2% was loading") % clientAddress % charUID );
+		return;
+	}
+
+	requester->PlayerLoaded(results);
+}
+
+void ObjectMgr::playerReloaded( QueryResultVector &results, uint32 goId )
+{
+	objectsMap::iterator it=m_objects.find(goId);
+	if (it==m_objects.end() || it->second == NULL)
+		return;
+
+	it->second->ReloadFromResults(results);
+}
+
+uint32 ObjectMgr::constructPlayer( GameClient* requester, uint64 charUID, QueryResultVector &loadResults )
 {
 	if (requester == NULL)
 		throw ClientNotAvailable();
@@ -36,7 +80,7 @@ uint32 ObjectMgr::constructPlayer( GameClient* requester, uint64 charUID )
 	PlayerObject *newPlayerObj = NULL;
 	try
 	{
-		newPlayerObj = new PlayerObject(*requester,charUID);
+		newPlayerObj = new PlayerObject(*requester,charUID,loadResults);
 	}
 	catch (PlayerObject::CharacterNotFound)
 	{
@@ -49,6 +93,15 @@ uint32 ObjectMgr::constructPlayer( GameClient* requester, uint64 charUID )
 	return theNewObjectId;
 }
 
+void ObjectMgr::Update()
+{
+	for (objectsMap::iterator it=m_objects.begin();it!=m_objects.end();++it)
+	{
+		if (it->second != NULL)
+			it->second->Update();
+	}
+}
+
 void ObjectMgr::destroyObject( uint32 goId )
 {
 	//erase from valid objects
@@ -176,8 +229,7 @@ void ObjectMgr::OpenDoor( uint32 doorId, GameClient* requester)
 		if (it->second == doorId)
 		{
 			//Didnt work first time, lets change door type
-			format sqlUpdateDoorType = format("UPDATE `doors` SET `DoorType`='0' WHERE `DoorId`='%1%' LIMIT 1") % doorId;
-			if (sDatabase.Execute(sqlUpdateDoorType))
+			if (sWorldData.SetDoorType(doorId,0))
 			{
 				format msg1 = format("{c:0FFFF0}Door:0x%08x Set to Indoors since u tried to open it but I think it is open, try again.{/c}") % (int)doorId;
 				
@@ -186,7 +238,7 @@ void ObjectMgr::OpenDoor( uint32 doorId, GameClient* requester)
 
 				requester->QueueCommand(make_shared<SystemChatMsg>(msg1.str()));
 			}
-			m_openDoors.erase(it);
+			forgetOpenDoor(it);
 			return;
 		}
 		
@@ -197,7 +249,7 @@ void ObjectMgr::OpenDoor( uint32 doorId, GameClient* requester)
 
 	if (m_openDoors.size() > 37000) //if lots of doors, then we want to close one
 	{
-		m_openDoors.erase(m_openDoors.begin());
+		forgetOpenDoor(m_openDoors.begin());
 		//Close Doors not working
 		//sGame.AnnounceStateUpdate(NULL,make_shared<CloseDoorMsg>(it->first));						
 	}
@@ -205,30 +257,43 @@ void ObjectMgr::OpenDoor( uint32 doorId, GameClient* requester)
 	uint16 viewId = allocateViewId(requester);
 	viewIdsMap &viewsOfClient = m_views[requester];
 	viewsOfClient[viewId]=doorId;
+	map<uint16,uint32>::iterator sameView = m_openDoors.find(viewId);
+	if (sameView != m_openDoors.end())
+		forgetOpenDoor(sameView);
 	m_openDoors[viewId]=doorId;	
+	m_doorCloseEvents[viewId] = sEventMgr.AddEvent(this,EVENT_DOOR_CLOSE,boost::bind(&ObjectMgr::closeDoorEvent,this,viewId),DOOR_AUTOCLOSE_MS);
 
 	format s = format("Door Opened With ViewId: %1%") % int(viewId);
 	sGame.AnnounceCommand(NULL,make_shared<SystemChatMsg>(s.str()));
 
 	//sGame.AnnounceStateUpdate(NULL,make_shared<DeleteDoorMsg>(doorId));	
-	format sqlDoor = format("SELECT `X`, `Y`, `Z`, `ROT`, `DoorType` FROM `doors` WHERE `DoorId`='%1%' LIMIT 1") % doorId;
-
-	scoped_ptr<QueryResult> resultDoor(sDatabase.Query(sqlDoor));
-	if (resultDoor != NULL)
+	const WorldDataMgr::DoorData *theDoor = sWorldData.GetDoor(doorId);
+	if (theDoor != NULL)
 	{
-		Field *field = resultDoor->Fetch();
-		double X = field[0].GetDouble();
-		double Y = field[1].GetDouble();
-		double Z = field[2].GetDouble();
-		double O = field[3].GetDouble();
-		int doorType = field[4].GetUInt16();
-		//int doorType = 1;
-
-		sGame.AnnounceStateUpdate(NULL,make_shared<DoorAnimationMsg>(doorId, viewId, X, Y, Z, O, doorType));
+		const LocationVector &doorPos = theDoor->pos;
+		sGame.AnnounceStateUpdate(NULL,make_shared<DoorAnimationMsg>(doorId, viewId, doorPos.x, doorPos.y, doorPos.z, doorPos.rot, theDoor->doorType));
 	}
 
 }
 
+void ObjectMgr::closeDoorEvent( uint16 viewId )
+{
+	m_doorCloseEvents.erase(viewId);
+	//Close Doors not working, so it's only forgotten about, players coming in later won't see it open
+	m_openDoors.erase(viewId);
+}
+
+void ObjectMgr::forgetOpenDoor( map<uint16,uint32>::iterator it )
+{
+	map<uint16,EventMgr::EventId>::iterator eventIt = m_doorCloseEvents.find(it->first);
+	if (eventIt != m_doorCloseEvents.end())
+	{
+		sEventMgr.CancelEvent(eventIt->second);
+		m_doorCloseEvents.erase(eventIt);
+	}
+	m_openDoors.erase(it);
+}
+
 vector<msgBaseClassPtr> ObjectMgr::GetAllOpenDoors( GameClient* requester )
 {
 	vector<msgBaseClassPtr> tempVec;
@@ -242,19 +307,11 @@ vector<msgBaseClassPtr> ObjectMgr::GetAllOpenDoors( GameClient* requester )
 	{
 		viewsOfClient[it->first] = it->second;
 
-		format sqlDoor = format("SELECT `X`, `Y`, `Z`, `ROT`, `DoorType` FROM `doors` WHERE `DoorId`='%1%' LIMIT 1") % it->second;
-		scoped_ptr<QueryResult> resultDoor(sDatabase.Query(sqlDoor));
-		if (resultDoor != NULL)
+		const WorldDataMgr::DoorData *theDoor = sWorldData.GetDoor(it->second);
+		if (theDoor != NULL)
 		{
-			Field *field = resultDoor->Fetch();
-			double X = field[0].GetDouble();
-			double Y = field[1].GetDouble();
-			double Z = field[2].GetDouble();
-			double O = field[3].GetDouble();
-			int doorType = field[4].GetUInt16();
-			//int doorType = 1;
-			
-			tempVec.push_back(make_shared<DoorAnimationMsg>(it->second,it->first, X, Y, Z, O, doorType));
+			const LocationVector &doorPos = theDoor->pos;
+			tempVec.push_back(make_shared<DoorAnimationMsg>(it->second,it->first, doorPos.x, doorPos.y, doorPos.z, doorPos.rot, theDoor->doorType));
 		}
 	}
 	return tempVec;
@@ -28,6 +28,8 @@
 
 #include "Common.h"
 #include "MessageTypes.h"
+#include "CallBack.h"
+#include "EventMgr.h"
 
 const uint32 OBJECTMANAGER_STARTINGOBJECTID = 0x8000; //we have plenty of uint32s
 
@@ -39,10 +41,16 @@ public:
 	class NoMoreFreeViews {};
 
 	ObjectMgr():m_currFreeObjectId(OBJECTMANAGER_STARTINGOBJECTID) {}
-	~ObjectMgr(){}
+	~ObjectMgr();
 
-	uint32 constructPlayer(class GameClient *requester, uint64 charUID );
+	// two phase load, query goes off to the db and playerLoaded finishes the job on the game thread
+	void loadPlayer(class GameClient *requester, uint64 charUID );
+	void playerLoaded(QueryResultVector &results, string clientAddress, uint64 charUID);
+	void playerReloaded(QueryResultVector &results, uint32 goId);
+	uint32 constructPlayer(class GameClient *requester, uint64 charUID, QueryResultVector &loadResults );
 	void destroyObject(uint32 goId);
+	// world tick for every object
+	void Update();
 	class PlayerObject* getGOPtr(uint32 goId);
 	uint32 getGOId(class PlayerObject* forWhichObj);
 	uint16 getViewForGO(class GameClient *requester, uint32 goId);
@@ -79,7 +87,15 @@ private:
 	}
 	uint32 m_currFreeObjectId;
 
+	enum
+	{
+		EVENT_DOOR_CLOSE
+	};
+	void closeDoorEvent(uint16 viewId);
+	void forgetOpenDoor(map<uint16,uint32>::iterator it);
+
 	map<uint16,uint32> m_openDoors;
+	map<uint16,EventMgr::EventId> m_doorCloseEvents;
 };
 
 #endif
\ No newline at end of file
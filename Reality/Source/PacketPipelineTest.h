@@ -0,0 +1,459 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_PACKETPIPELINETEST_H
+#define MXOEMU_PACKETPIPELINETEST_H
+
+#define UNITTEST
+
+#include "Common.h"
+#include "Util.h"
+#include "Timer.h"
+#include "SequencedPacket.h"
+#include "EncryptedPacket.h"
+#include "MessageTypes.h"
+#include "RsiData.h"
+#include "LocationVector.h"
+#include "Database/Database.h"
+#include "GameServer.h"
+#include "GameClient.h"
+#include "PlayerObject.h"
+#include <new>
+
+// ns/op and heap allocations/op for every step a world packet goes through: sequencing,
+// twofish encrypt/decrypt, ordered MsgBlock (de)serialization, RSI encoding and the toBuf
+// of every message type. Each run is written to PacketPipelineLast.txt and compared against
+// PacketPipelineBaseline.txt, which the first run creates. Copy Last over Baseline to accept
+// new numbers.
+
+#if PLATFORM != PLATFORM_WIN32
+#include <sys/time.h>
+#endif
+
+static const char *PIPELINE_BASELINE_FILE = "PacketPipelineBaseline.txt";
+static const char *PIPELINE_LAST_FILE = "PacketPipelineLast.txt";
+static const uint64 PIPELINE_MIN_RUN_US = 50000;
+static const uint32 PIPELINE_RUNS = 3;
+static const double PIPELINE_SLOWER_PERCENT = 10.0;
+static const uint32 PIPELINE_PAYLOAD_SIZE = 300;
+
+//every allocation in the process goes through here while the bench is included
+static uint64 pipelineAllocations = 0;
+
+void* operator new(size_t size) throw(std::bad_alloc)
+{
+	pipelineAllocations++;
+	void *ptr = malloc(size ? size : 1);
+	if (ptr == NULL)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void operator delete(void *ptr) throw()
+{
+	free(ptr);
+}
+
+inline uint64 pipelineNowUS()
+{
+#if PLATFORM == PLATFORM_WIN32
+	LARGE_INTEGER freq, counter;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&counter);
+	return uint64(counter.QuadPart) * 1000000 / uint64(freq.QuadPart);
+#else
+	timeval theTime;
+	gettimeofday(&theTime, NULL);
+	return uint64(theTime.tv_sec) * 1000000 + theTime.tv_usec;
+#endif
+}
+
+//what the benches work on, built once before anything is timed
+struct PipelineFixture
+{
+	ByteBuffer payload;
+	SequencedPacket sequenced;
+	ByteBuffer withHeader;
+	TwofishCryptEngine engine;
+	ByteBuffer cipherText;
+	MsgBlock msgBlock;
+	ByteBuffer msgBlockBuf;
+	OrderedPacket ordered;
+	ByteBuffer orderedBuf;
+	RsiDataMale rsiMale;
+	RsiDataFemale rsiFemale;
+	GameClient *client;
+	uint32 playerGoId;
+};
+static PipelineFixture *pipeFx = NULL;
+static volatile uint32 pipelineSink = 0;
+
+static QueryResult* pipelineQueryResult(const char **values, uint32 numValues)
+{
+	//no mysql result behind it, Field only ever reads the values
+	QueryResult *result = new QueryResult(NULL,numValues,1);
+	for (uint32 i=0; i<numValues; i++)
+		result->Fetch()[i].SetValue(const_cast<char*>(values[i]),strlen(values[i]));
+	return result;
+}
+
+static void pipelineSetUp()
+{
+	pipeFx = new PipelineFixture;
+	PipelineFixture &fx = *pipeFx;
+
+	CryptoPP::AutoSeededRandomPool randPool;
+	vector<byte> randomBytes(PIPELINE_PAYLOAD_SIZE);
+	randPool.GenerateBlock(&randomBytes[0],randomBytes.size());
+	fx.payload.append(randomBytes);
+
+	fx.sequenced = SequencedPacket(100,200,0x7F,fx.payload);
+	fx.withHeader = fx.sequenced.getDataWithHeader();
+
+	byte key[16];
+	randPool.GenerateBlock(key,sizeof(key));
+	fx.engine.Initialize(key,sizeof(key));
+	fx.cipherText = TwofishEncryptedPacket(fx.withHeader).toCipherText(fx.engine);
+
+	//short and long (two byte length) subpackets
+	fx.msgBlock.sequenceId = 5;
+	fx.msgBlock.subPackets.push_back(SystemChatMsg("Character data has been written to the database.").toBuf());
+	fx.msgBlock.subPackets.push_back(PlayerChatMsg("BenchBot","the quick brown fox jumps over the lazy dog").toBuf());
+	fx.msgBlock.subPackets.push_back(SetExperienceCmd(123456).toBuf());
+	fx.msgBlock.subPackets.push_back(fx.payload);
+	fx.msgBlock.ToBuffer(fx.msgBlockBuf);
+
+	for (uint16 i=0; i<3; i++)
+	{
+		MsgBlock theBlock = fx.msgBlock;
+		theBlock.sequenceId = 5+i;
+		fx.ordered.msgBlocks.push_back(theBlock);
+	}
+	fx.orderedBuf = fx.ordered.toBuf();
+
+	const byte rsiValues[] = {0x00,0x0C,0x71,0x48,0x18,0x0C,0xE2,0x00,0x23,0x00,0xB0,0x00,0x40,0x00,0x00};
+	fx.rsiMale.FromBytes(rsiValues,sizeof(rsiValues));
+	fx.rsiFemale.FromBytes(rsiValues,sizeof(rsiValues));
+
+	//a player the object update messages can serialize, loaded from rows the way ObjectMgr would
+	new GameServer();
+	sGame.SetSimTime(0);
+
+	sockaddr_in clientAddr;
+	memset(&clientAddr,0,sizeof(clientAddr));
+	clientAddr.sin_family = AF_INET;
+	clientAddr.sin_port = htons(1234);
+	clientAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	fx.client = new GameClient(clientAddr,NULL);
+
+	const char *charValues[] = {"BenchBot","Bench","Bot","Generated by the packet pipeline bench",
+		"100.5","0","-250.25","1.5","500","500","300","300","50","2","1","0","123456","1000","1","0"};
+	const char *rsiFields[] = {"0","1","3","5","7","9","11","13","15","17","19","1","3","5","7","9","11","13","15","1","2","3"};
+	QueryResultVector loadResults(2);
+	loadResults[0].result = pipelineQueryResult(charValues,sizeof(charValues)/sizeof(charValues[0]));
+	loadResults[0].query = NULL;
+	loadResults[1].result = pipelineQueryResult(rsiFields,sizeof(rsiFields)/sizeof(rsiFields[0]));
+	loadResults[1].query = NULL;
+	fx.playerGoId = sObjMgr.constructPlayer(fx.client,1,loadResults);
+	delete loadResults[0].result;
+	delete loadResults[1].result;
+}
+
+static void pipelineTearDown()
+{
+	delete pipeFx->client;
+	delete GameServer::getSingletonPtr();
+	delete pipeFx;
+	pipeFx = NULL;
+}
+
+//serializing a message for one receiver, the way GameClient::FlushQueue does
+static void pipelineSerialize(MsgBaseClass &theMsg)
+{
+	ObjectUpdateMsg *objectUpdate = dynamic_cast<ObjectUpdateMsg*>(&theMsg);
+	if (objectUpdate != NULL)
+		objectUpdate->setReceiver(pipeFx->client);
+
+	pipelineSink += theMsg.toBuf().size();
+}
+
+static void benchSequencedConstruct()
+{
+	SequencedPacket thePacket(100,200,0x7F,pipeFx->payload);
+	pipelineSink += thePacket.size();
+}
+
+static void benchSequencedGetDataWithHeader()
+{
+	pipelineSink += pipeFx->sequenced.getDataWithHeader().size();
+}
+
+static void benchSequencedParse()
+{
+	SequencedPacket thePacket(pipeFx->withHeader);
+	pipelineSink += thePacket.getLocalSeq();
+}
+
+static void benchTwofishEncrypt()
+{
+	TwofishEncryptedPacket thePacket(pipeFx->withHeader);
+	pipelineSink += thePacket.toCipherText(pipeFx->engine).size();
+}
+
+static void benchTwofishDecrypt()
+{
+	pipeFx->cipherText.rpos(0);
+	TwofishEncryptedPacket thePacket(pipeFx->cipherText,pipeFx->engine);
+	pipelineSink += thePacket.size();
+}
+
+static void benchMsgBlockFromBuffer()
+{
+	pipeFx->msgBlockBuf.rpos(0);
+	MsgBlock theBlock;
+	theBlock.FromBuffer(pipeFx->msgBlockBuf);
+	pipelineSink += theBlock.subPackets.size();
+}
+
+static void benchMsgBlockToBuffer()
+{
+	ByteBuffer destination;
+	pipeFx->msgBlock.ToBuffer(destination);
+	pipelineSink += destination.size();
+}
+
+static void benchOrderedFromBuffer()
+{
+	OrderedPacket thePacket;
+	thePacket.FromBuffer((const byte*)pipeFx->orderedBuf.contents(),pipeFx->orderedBuf.size());
+	pipelineSink += thePacket.msgBlocks.size();
+}
+
+static void benchOrderedToBuf()
+{
+	pipelineSink += pipeFx->ordered.toBuf().size();
+}
+
+static void benchRsiMaleToBytes()
+{
+	byte rsiBytes[32];
+	pipelineSink += pipeFx->rsiMale.ToBytes(rsiBytes,sizeof(rsiBytes));
+}
+
+static void benchRsiFemaleToBytes()
+{
+	byte rsiBytes[32];
+	pipelineSink += pipeFx->rsiFemale.ToBytes(rsiBytes,sizeof(rsiBytes));
+}
+
+static void benchDeletePlayerMsg() { DeletePlayerMsg theMsg(pipeFx->playerGoId); pipelineSerialize(theMsg); }
+static void benchCloseDoorMsg() { CloseDoorMsg theMsg(0x1234); pipelineSerialize(theMsg); }
+static void benchPlayerSpawnMsg() { PlayerSpawnMsg theMsg(pipeFx->playerGoId); pipelineSerialize(theMsg); }
+static void benchPlayerAppearanceMsg() { PlayerAppearanceMsg theMsg(pipeFx->playerGoId); pipelineSerialize(theMsg); }
+static void benchEmoteMsg() { EmoteMsg theMsg(pipeFx->playerGoId,swap32(0xe6020058),1); pipelineSerialize(theMsg); }
+static void benchAnimationStateMsg() { AnimationStateMsg theMsg(pipeFx->playerGoId); pipelineSerialize(theMsg); }
+static void benchPositionStateMsg() { PositionStateMsg theMsg(pipeFx->playerGoId); pipelineSerialize(theMsg); }
+static void benchJackoutEffectMsg() { JackoutEffectMsg theMsg(pipeFx->playerGoId); pipelineSerialize(theMsg); }
+static void benchStateUpdateMsg() { StateUpdateMsg theMsg(pipeFx->playerGoId,pipeFx->payload); pipelineSerialize(theMsg); }
+static void benchEmptyMsg() { EmptyMsg theMsg; pipelineSerialize(theMsg); }
+static void benchDoorAnimationMsg() { DoorAnimationMsg theMsg(0x1234,0x20,100.5,0,-250.25,1.0,0); pipelineSerialize(theMsg); }
+static void benchWhereAmIResponse() { WhereAmIResponse theMsg(LocationVector(100.5,0,-250.25)); pipelineSerialize(theMsg); }
+static void benchWhisperMsg() { WhisperMsg theMsg("BenchBot","the quick brown fox jumps over the lazy dog"); pipelineSerialize(theMsg); }
+static void benchSystemMsg() { SystemChatMsg theMsg("Character data has been written to the database."); pipelineSerialize(theMsg); }
+static void benchPlayerChatMsg() { PlayerChatMsg theMsg("BenchBot","the quick brown fox jumps over the lazy dog"); pipelineSerialize(theMsg); }
+static void benchBackgroundResponseMsg() { BackgroundResponseMsg theMsg("Generated by the packet pipeline bench"); pipelineSerialize(theMsg); }
+static void benchPlayerDetailsMsg() { PlayerDetailsMsg theMsg(sObjMgr.getGOPtr(pipeFx->playerGoId)); pipelineSerialize(theMsg); }
+static void benchPlayerBackgroundMsg() { PlayerBackgroundMsg theMsg("Generated by the packet pipeline bench"); pipelineSerialize(theMsg); }
+static void benchHexGenericMsg() { HexGenericMsg theMsg("80bc1500030000f70300000802000000000000000000"); pipelineSerialize(theMsg); }
+static void benchLoadWorldCmd() { LoadWorldCmd theMsg(LoadWorldCmd::SLUMS,"Massive"); pipelineSerialize(theMsg); }
+static void benchSetOptionCmd() { SetOptionCmd theMsg("ShowChatBubbles",true); pipelineSerialize(theMsg); }
+static void benchSetExperienceCmd() { SetExperienceCmd theMsg(123456); pipelineSerialize(theMsg); }
+static void benchSetInformationCmd() { SetInformationCmd theMsg(1000); pipelineSerialize(theMsg); }
+static void benchEventURLCmd() { EventURLCmd theMsg("http://mxoemu.info/forum/index.php"); pipelineSerialize(theMsg); }
+
+typedef void (*pipelineBenchFunc)();
+struct PipelineBench
+{
+	const char *name;
+	pipelineBenchFunc func;
+};
+
+static const PipelineBench PIPELINE_BENCHES[] =
+{
+	{"SequencedPacket construct", benchSequencedConstruct},
+	{"SequencedPacket getDataWithHeader", benchSequencedGetDataWithHeader},
+	{"SequencedPacket parse", benchSequencedParse},
+	{"TwofishEncryptedPacket encrypt", benchTwofishEncrypt},
+	{"TwofishEncryptedPacket decrypt", benchTwofishDecrypt},
+	{"MsgBlock FromBuffer", benchMsgBlockFromBuffer},
+	{"MsgBlock ToBuffer", benchMsgBlockToBuffer},
+	{"OrderedPacket FromBuffer", benchOrderedFromBuffer},
+	{"OrderedPacket toBuf", benchOrderedToBuf},
+	{"RsiDataMale ToBytes", benchRsiMaleToBytes},
+	{"RsiDataFemale ToBytes", benchRsiFemaleToBytes},
+	{"DeletePlayerMsg", benchDeletePlayerMsg},
+	{"CloseDoorMsg", benchCloseDoorMsg},
+	{"PlayerSpawnMsg", benchPlayerSpawnMsg},
+	{"PlayerAppearanceMsg", benchPlayerAppearanceMsg},
+	{"EmoteMsg", benchEmoteMsg},
+	{"AnimationStateMsg", benchAnimationStateMsg},
+	{"PositionStateMsg", benchPositionStateMsg},
+	{"JackoutEffectMsg", benchJackoutEffectMsg},
+	{"StateUpdateMsg", benchStateUpdateMsg},
+	{"EmptyMsg", benchEmptyMsg},
+	{"DoorAnimationMsg", benchDoorAnimationMsg},
+	{"WhereAmIResponse", benchWhereAmIResponse},
+	{"WhisperMsg", benchWhisperMsg},
+	{"SystemMsg", benchSystemMsg},
+	{"PlayerChatMsg", benchPlayerChatMsg},
+	{"BackgroundResponseMsg", benchBackgroundResponseMsg},
+	{"PlayerDetailsMsg", benchPlayerDetailsMsg},
+	{"PlayerBackgroundMsg", benchPlayerBackgroundMsg},
+	{"HexGenericMsg", benchHexGenericMsg},
+	{"LoadWorldCmd", benchLoadWorldCmd},
+	{"SetOptionCmd", benchSetOptionCmd},
+	{"SetExperienceCmd", benchSetExperienceCmd},
+	{"SetInformationCmd", benchSetInformationCmd},
+	{"EventURLCmd", benchEventURLCmd},
+};
+static const uint32 PIPELINE_NUM_BENCHES = sizeof(PIPELINE_BENCHES)/sizeof(PIPELINE_BENCHES[0]);
+
+struct PipelineResult
+{
+	PipelineResult() : nsPerOp(0), allocsPerOp(0) {}
+	PipelineResult(double ns, double allocs) : nsPerOp(ns), allocsPerOp(allocs) {}
+	double nsPerOp;
+	double allocsPerOp;
+};
+typedef map<string,PipelineResult> pipelineResultsMap;
+
+static PipelineResult runPipelineBench(pipelineBenchFunc func)
+{
+	//double the batch until it runs long enough for the timer, that doubles as the warmup
+	uint32 iterations = 1;
+	for (;;)
+	{
+		uint64 startTime = pipelineNowUS();
+		for (uint32 i=0; i<iterations; i++)
+			func();
+
+		if (pipelineNowUS() - startTime >= PIPELINE_MIN_RUN_US)
+			break;
+
+		iterations *= 2;
+	}
+
+	//fastest of a few runs, allocations don't change from run to run
+	PipelineResult best;
+	for (uint32 run=0; run<PIPELINE_RUNS; run++)
+	{
+		uint64 allocsBefore = pipelineAllocations;
+		uint64 startTime = pipelineNowUS();
+		for (uint32 i=0; i<iterations; i++)
+			func();
+		uint64 elapsed = pipelineNowUS() - startTime;
+		uint64 allocs = pipelineAllocations - allocsBefore;
+
+		double nsPerOp = double(elapsed) * 1000.0 / iterations;
+		if (run == 0 || nsPerOp < best.nsPerOp)
+			best = PipelineResult(nsPerOp,double(allocs) / iterations);
+	}
+	return best;
+}
+
+static pipelineResultsMap loadPipelineResults(const char *fileName)
+{
+	pipelineResultsMap results;
+	ifstream inFile(fileName);
+	string line;
+	while (getline(inFile,line))
+	{
+		//name<TAB>ns/op<TAB>allocs/op
+		size_t firstTab = line.find('\t');
+		size_t secondTab = line.find('\t',firstTab+1);
+		if (firstTab == string::npos || secondTab == string::npos)
+			continue;
+
+		results[line.substr(0,firstTab)] = PipelineResult(
+			atof(line.substr(firstTab+1,secondTab-firstTab-1).c_str()),
+			atof(line.substr(secondTab+1).c_str()));
+	}
+	return results;
+}
+
+static void savePipelineResults(const char *fileName, const vector< std::pair<string,PipelineResult> > &results)
+{
+	ofstream outFile(fileName,ios::out | ios::trunc);
+	for (size_t i=0; i<results.size(); i++)
+		outFile << format("%s\t%.1f\t%.2f") % results[i].first % results[i].second.nsPerOp % results[i].second.allocsPerOp << std::endl;
+}
+
+void runTest()
+{
+	pipelineSetUp();
+
+	pipelineResultsMap baseline = loadPipelineResults(PIPELINE_BASELINE_FILE);
+	if (baseline.empty())
+		cout << format("no %1%, this run becomes the baseline") % PIPELINE_BASELINE_FILE << std::endl;
+
+	cout << format("%-36s %12s %10s %12s %10s %8s") % "" % "ns/op" % "allocs/op" % "base ns/op" % "allocs/op" % "delta" << std::endl;
+
+	vector< std::pair<string,PipelineResult> > results;
+	uint32 regressions = 0;
+	for (uint32 i=0; i<PIPELINE_NUM_BENCHES; i++)
+	{
+		PipelineResult current = runPipelineBench(PIPELINE_BENCHES[i].func);
+		results.push_back(std::make_pair(string(PIPELINE_BENCHES[i].name),current));
+
+		pipelineResultsMap::iterator it = baseline.find(PIPELINE_BENCHES[i].name);
+		if (it == baseline.end())
+		{
+			cout << format("%-36s %12.1f %10.2f") % PIPELINE_BENCHES[i].name % current.nsPerOp % current.allocsPerOp << std::endl;
+			continue;
+		}
+
+		const PipelineResult &base = it->second;
+		double deltaPercent = base.nsPerOp > 0 ? (current.nsPerOp - base.nsPerOp) * 100.0 / base.nsPerOp : 0;
+		bool slower = deltaPercent > PIPELINE_SLOWER_PERCENT;
+		bool moreAllocs = current.allocsPerOp > base.allocsPerOp + 0.005;
+		if (slower || moreAllocs)
+			regressions++;
+
+		cout << format("%-36s %12.1f %10.2f %12.1f %10.2f %+7.1f%%%s%s")
+			% PIPELINE_BENCHES[i].name % current.nsPerOp % current.allocsPerOp
+			% base.nsPerOp % base.allocsPerOp % deltaPercent
+			% (slower ? " SLOWER" : "") % (moreAllocs ? " ALLOCS" : "") << std::endl;
+	}
+
+	savePipelineResults(PIPELINE_LAST_FILE,results);
+	if (baseline.empty())
+		savePipelineResults(PIPELINE_BASELINE_FILE,results);
+	else
+		cout << format("%1% regressions against %2% (more than %3%%% slower or more allocations)") % regressions % PIPELINE_BASELINE_FILE % PIPELINE_SLOWER_PERCENT << std::endl;
+
+	pipelineTearDown();
+}
+
+#endif
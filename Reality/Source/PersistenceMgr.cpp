@@ -0,0 +1,161 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#include "PersistenceMgr.h"
+#include "Config.h"
+#include "Log.h"
+#include "Timer.h"
+#include "Database/DatabaseEnv.h"
+
+PersistenceMgr::PersistenceMgr()
+{
+	m_flushIntervalMS = 10000;
+	m_batchSize = 100;
+	m_lastFlushMS = getMSTime();
+	m_rowsWritten = 0;
+	m_statementsSent = 0;
+}
+
+PersistenceMgr::~PersistenceMgr()
+{
+	if (m_dirty.size() > 0)
+		WARNING_LOG(format("PersistenceMgr destroyed with %1% unsaved characters") % m_dirty.size());
+}
+
+void PersistenceMgr::Configure()
+{
+	int interval = sConfig.GetIntDefault("GameServer.PersistInterval", 10);
+	if (interval < 1)
+		interval = 1;
+	m_flushIntervalMS = uint32(interval) * 1000;
+
+	int batchSize = sConfig.GetIntDefault("GameServer.PersistBatchSize", 100);
+	if (batchSize < 1)
+		batchSize = 1;
+	m_batchSize = uint32(batchSize);
+
+	m_lastFlushMS = getMSTime();
+}
+
+void PersistenceMgr::MarkDirty( uint64 charUID, const LocationVector &pos, bool isOnline )
+{
+	characterState &theState = m_dirty[charUID];
+	theState.pos = pos;
+	theState.isOnline = isOnline;
+}
+
+void PersistenceMgr::Update()
+{
+	if (getMSTime() - m_lastFlushMS < m_flushIntervalMS)
+		return;
+
+	Flush();
+}
+
+size_t PersistenceMgr::Flush( bool waitForCompletion )
+{
+	m_lastFlushMS = getMSTime();
+
+	size_t charsStored = 0;
+	dirtyMap::iterator it = m_dirty.begin();
+	while (it != m_dirty.end())
+	{
+		dirtyMap::iterator batchStart = it;
+		uint32 batchCount = 0;
+		for (;it != m_dirty.end() && batchCount < m_batchSize; ++it, ++batchCount);
+
+		if (!StoreBatch(batchStart,it,waitForCompletion))
+		{
+			//keep them dirty, next flush will retry
+			WARNING_LOG(format("PersistenceMgr failed to store %1% characters") % batchCount);
+			continue;
+		}
+
+		m_dirty.erase(batchStart,it);
+		m_rowsWritten += batchCount;
+		charsStored += batchCount;
+	}
+
+	if (charsStored > 0)
+		DEBUG_LOG(format("PersistenceMgr stored %1% characters") % charsStored);
+
+	return charsStored;
+}
+
+bool PersistenceMgr::FlushOne( uint64 charUID, bool waitForCompletion )
+{
+	dirtyMap::iterator it = m_dirty.find(charUID);
+	if (it == m_dirty.end())
+		return true;
+
+	dirtyMap::iterator next = it;
+	++next;
+	if (!StoreBatch(it,next,waitForCompletion))
+	{
+		//stays dirty, the next interval flush will retry it
+		WARNING_LOG(format("PersistenceMgr failed to store character %1%") % charUID);
+		return false;
+	}
+
+	m_dirty.erase(it);
+	m_rowsWritten++;
+	return true;
+}
+
+bool PersistenceMgr::StoreBatch( dirtyMap::const_iterator first, dirtyMap::const_iterator last, bool waitForCompletion )
+{
+	//not every row in characters has defaults, so INSERT ... ON DUPLICATE KEY is out, use CASE instead
+	string xCase, yCase, zCase, rotCase, onlineCase, idList;
+	for (dirtyMap::const_iterator it = first; it != last; ++it)
+	{
+		const uint64 &charUID = it->first;
+		const characterState &theState = it->second;
+
+		xCase += (format(" WHEN '%1%' THEN '%2%'") % charUID % theState.pos.x).str();
+		yCase += (format(" WHEN '%1%' THEN '%2%'") % charUID % theState.pos.y).str();
+		zCase += (format(" WHEN '%1%' THEN '%2%'") % charUID % theState.pos.z).str();
+		rotCase += (format(" WHEN '%1%' THEN '%2%'") % charUID % theState.pos.rot).str();
+		onlineCase += (format(" WHEN '%1%' THEN '%2%'") % charUID % int(theState.isOnline)).str();
+
+		if (it != first)
+			idList += ",";
+		idList += (format("'%1%'") % charUID).str();
+	}
+
+	string sql = (format("UPDATE `characters` SET \
+`x` = CASE `charId`%1% END, \
+`y` = CASE `charId`%2% END, \
+`z` = CASE `charId`%3% END, \
+`rot` = CASE `charId`%4% END, \
+`isOnline` = CASE `charId`%5% END, \
+`lastOnline` = NOW() WHERE `charId` IN (%6%)")
+		% xCase % yCase % zCase % rotCase % onlineCase % idList).str();
+
+	m_statementsSent++;
+	if (waitForCompletion)
+		return sDatabase.WaitExecute(sql);
+	else
+		return sDatabase.Execute(sql);
+}
@@ -0,0 +1,76 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_PERSISTENCEMGR_H
+#define MXOEMU_PERSISTENCEMGR_H
+
+#include "Common.h"
+#include "LocationVector.h"
+
+// Write-behind store for character state that changes often (position, online flag).
+// Players mark themselves dirty as often as they like, repeated changes to the same
+// character are coalesced, and everything pending is written out in batched
+// UPDATE statements every GameServer.PersistInterval seconds.
+// Only used from the game server thread.
+class PersistenceMgr
+{
+public:
+	PersistenceMgr();
+	~PersistenceMgr();
+
+	void Configure();
+
+	void MarkDirty(uint64 charUID, const LocationVector &pos, bool isOnline);
+	size_t GetPendingCount() const { return m_dirty.size(); }
+
+	// flushes if the interval has elapsed, call every loop
+	void Update();
+	// writes out everything pending, returns number of characters stored
+	size_t Flush(bool waitForCompletion=false);
+	// writes out just this character if it has anything pending, leaves the interval alone
+	bool FlushOne(uint64 charUID, bool waitForCompletion=false);
+
+	uint64 GetRowsWritten() const { return m_rowsWritten; }
+	uint64 GetStatementsSent() const { return m_statementsSent; }
+private:
+	struct characterState
+	{
+		LocationVector pos;
+		bool isOnline;
+	};
+	typedef map<uint64,characterState> dirtyMap;
+	dirtyMap m_dirty;
+
+	bool StoreBatch(dirtyMap::const_iterator first, dirtyMap::const_iterator last, bool waitForCompletion);
+
+	uint32 m_flushIntervalMS;
+	uint32 m_batchSize;
+	uint32 m_lastFlushMS;
+
+	uint64 m_rowsWritten;
+	uint64 m_statementsSent;
+};
+
+#endif
@@ -32,11 +32,15 @@
 #include "Log.h"
 #include "GameClient.h"
 #include "Timer.h"
+#include "TickProfiler.h"
 #include <boost/algorithm/string.hpp>
 
-PlayerObject::PlayerObject( GameClient &parent,uint64 charUID ) :m_parent(parent),m_characterUID(charUID),m_spawnedInWorld(false),m_worldPopulated(false)
+PlayerObject::PlayerObject( GameClient &parent,uint64 charUID,QueryResultVector &loadResults ) :m_parent(parent),m_characterUID(charUID),m_spawnedInWorld(false),m_worldPopulated(false)
 {
-	loadFromDB(true);
+	if (loadResults.size() < 2)
+		throw CharacterNotFound();
+
+	loadFromResults(loadResults[0].result,loadResults[1].result,true);
 
 	m_goId=0;
 	INFO_LOG(format("Player object for %1% constructed") % m_handle);
@@ -50,17 +54,44 @@ PlayerObject::PlayerObject( GameClient &parent,uint64 charUID ) :m_parent(parent
 	setOnlineStatus(true);
 }
 
-void PlayerObject::loadFromDB( bool updatePos )
+void PlayerObject::AddLoadQueries( AsyncQuery *query, uint64 charUID )
 {
-	//grab data from characters table
-	{
-		format sql = format("SELECT `handle`, `firstName`, `lastName`, `background`,\
+	//order matters, loadFromResults expects characters first, then rsi
+	query->AddQuery(format("SELECT `handle`, `firstName`, `lastName`, `background`,\
 							`x`, `y`, `z`, `rot`, \
 							`healthC`, `healthM`, `innerStrC`, `innerStrM`,\
 							`level`, `profession`, `alignment`, `pvpflag`, `exp`, `cash`, `district`, `adminFlags`\
-							FROM `characters` WHERE `charId` = '%1%' LIMIT 1") % m_characterUID;
+							FROM `characters` WHERE `charId` = '%1%' LIMIT 1") % charUID);
+	query->AddQuery(format("SELECT `sex`, `body`, `hat`, `face`, `shirt`,\
+							`coat`, `pants`, `shoes`, `gloves`, `glasses`,\
+							`hair`, `facialdetail`, `shirtcolor`, `pantscolor`,\
+							`coatcolor`, `shoecolor`, `glassescolor`, `haircolor`,\
+							`skintone`, `tattoo`, `facialdetailcolor`, `leggings` FROM `rsivalues` WHERE `charId` = '%1%' LIMIT 1") % charUID);
+}
 
-		scoped_ptr<QueryResult> result(sDatabase.Query(sql));
+void PlayerObject::ReloadFromResults( QueryResultVector &loadResults )
+{
+	if (loadResults.size() < 2)
+		return;
+
+	try
+	{
+		loadFromResults(loadResults[0].result,loadResults[1].result,false);
+	}
+	catch (CharacterNotFound)
+	{
+		WARNING_LOG(format("%1%:%2% reload failed, character no longer in database") % m_handle % m_goId );
+		return;
+	}
+
+	sGame.AnnounceStateUpdate(NULL,make_shared<PlayerAppearanceMsg>(m_goId));
+}
+
+void PlayerObject::loadFromResults( QueryResult *charResult, QueryResult *rsiResult, bool updatePos )
+{
+	//grab data from characters table
+	{
+		QueryResult *result = charResult;
 
 		if (!result)
 			throw CharacterNotFound();
@@ -110,11 +141,7 @@ void PlayerObject::loadFromDB( bool updatePos )
 	}
 	//grab data from rsi table
 	{
-		scoped_ptr<QueryResult> result(sDatabase.Query(format("SELECT `sex`, `body`, `hat`, `face`, `shirt`,\
-															  `coat`, `pants`, `shoes`, `gloves`, `glasses`,\
-															  `hair`, `facialdetail`, `shirtcolor`, `pantscolor`,\
-															  `coatcolor`, `shoecolor`, `glassescolor`, `haircolor`,\
-															  `skintone`, `tattoo`, `facialdetailcolor`, `leggings` FROM `rsivalues` WHERE `charId` = '%1%' LIMIT 1") % m_characterUID) );
+		QueryResult *result = rsiResult;
 		if (result == NULL)
 		{
 			INFO_LOG(format("SpawnRSI(%1%): Character's RSI doesn't exist") % m_handle );
@@ -176,11 +203,14 @@ void PlayerObject::initGoId(uint32 theGoId)
 
 PlayerObject::~PlayerObject()
 {
+	//the events are bound to this object
+	sEventMgr.CancelEvents(this);
+
 	if (m_spawnedInWorld == true)
 	{
-		//commit position changes
-		saveDataToDB();
+		//commit position changes, and make sure ours hit the db now rather than next interval
 		setOnlineStatus(false);
+		sPersistMgr.FlushOne(m_characterUID);
 
 		INFO_LOG(format("Player object for %1%:%2% deconstructing") % m_handle % m_goId);
 		sGame.AnnounceStateUpdate(&m_parent,make_shared<DeletePlayerMsg>(m_goId));
@@ -209,35 +239,21 @@ void PlayerObject::checkAndStore()
 
 void PlayerObject::saveDataToDB()
 {
-	if (m_savedPos == m_pos)
-		return setOnlineStatus(true);
-
-	bool storeSuccess = sDatabase.Execute(format("UPDATE `characters` SET `x` = '%1%', `y` = '%2%', `z` = '%3%', `rot` = '%4%', `lastOnline` = NOW() WHERE `charId` = '%5%'")
-		% m_pos.x
-		% m_pos.y
-		% m_pos.z
-		% m_pos.rot
-		% m_characterUID );
+	//position and lastOnline are written behind by the persistence manager, in batches
+	setOnlineStatus(true);
 
-	if (!storeSuccess)
-		WARNING_LOG(format("%1%:%2% failed to save data to database") % m_handle % m_goId );
-	else
+	m_savedPos = m_pos;
+	if (m_storeCntr >= 10)
 	{
-		m_savedPos = m_pos;
-		if (m_storeCntr >= 10)
-		{
-			m_parent.QueueCommand(make_shared<SystemChatMsg>( (format("Character data for %1% has been written to the database.") % m_handle).str() ));
-			m_storeCntr=0;
-		}
-		m_storeCntr++;
+		m_parent.QueueCommand(make_shared<SystemChatMsg>( (format("Character data for %1% has been queued for saving to the database.") % m_handle).str() ));
+		m_storeCntr=0;
 	}
+	m_storeCntr++;
 }
 
 void PlayerObject::setOnlineStatus( bool isOnline )
 {
-	sDatabase.Execute(format("UPDATE `characters` SET `lastOnline` = NOW(), `isOnline` = '%1%' WHERE `charId` = '%2%'")
-		% int(isOnline)
-		% m_characterUID );
+	sPersistMgr.MarkDirty(m_characterUID,m_pos,isOnline);
 }
 
 void PlayerObject::InitializeWorld()
@@ -269,8 +285,12 @@ void PlayerObject::InitializeWorld()
 
 void PlayerObject::UpdateAppearance()
 {
-	loadFromDB(false);
-	sGame.AnnounceStateUpdate(NULL,make_shared<PlayerAppearanceMsg>(m_goId));
+	//results come back through ObjectMgr on the game thread, by then we might be gone
+	AsyncQuery *reloadQuery = new AsyncQuery(
+		new SQLClassCallbackP1<ObjectMgr,uint32>(&sObjMgr,&ObjectMgr::playerReloaded,m_goId),
+		sGame.getDBCompletions());
+	AddLoadQueries(reloadQuery,m_characterUID);
+	sDatabase.QueueAsyncQuery(reloadQuery);
 }
 
 void PlayerObject::SpawnSelf()
@@ -505,12 +525,16 @@ void PlayerObject::HandleCommand( ByteBuffer &srcCmd )
 		m_RPCshort[0x80fe] = &PlayerObject::RPC_HandleJackoutFinished;
 	}
 
+	ProfileProbe dispatchProbe(TickProfiler::PHASE_DISPATCH);
+	dispatchProbe.SetOpcode(TickProfiler::OPCODE_UNHANDLED);
+
 	uint8 firstByte = srcCmd.read<uint8>();
 
 	try
 	{
 		if (m_RPCbyte.count(firstByte))
 		{
+			dispatchProbe.SetOpcode(firstByte);
 			CALL_METHOD_PTR(this,m_RPCbyte[firstByte])(srcCmd);
 			return;
 		}
@@ -522,6 +546,7 @@ void PlayerObject::HandleCommand( ByteBuffer &srcCmd )
 				uint16 shortCommand = (uint16(firstByte) << 8) | (secondByte & 0xFF);
 				if (m_RPCshort.count(shortCommand))
 				{
+					dispatchProbe.SetOpcode(0x10000 | shortCommand);
 					CALL_METHOD_PTR(this,m_RPCshort[shortCommand])(srcCmd);
 					return;
 				}
@@ -543,7 +568,7 @@ bool PlayerObject::setBackground(string newBackground)
 {
 	m_background = newBackground;
 
-	return sDatabase.Execute(format("UPDATE `characters` SET `background` = '%1%' WHERE `charId` = '%2%'")
+	return sDatabase.Execute(m_characterUID,format("UPDATE `characters` SET `background` = '%1%' WHERE `charId` = '%2%'")
 		% sDatabase.EscapeString(this->getBackground())
 		% m_characterUID );
 }
@@ -600,42 +625,15 @@ void PlayerObject::Update()
 		}
 
 		checkAndStore();
-
-		//fire events that occurred
-		for(list<eventStruct>::iterator it=m_events.begin();it!=m_events.end();)
-		{
-			if (getFloatTime() >= it->fireTime)
-			{
-				it->func();
-				it=m_events.erase(it);
-			}
-			else
-			{
-				++it;
-			}
-		}
 	}
 }
 
 void PlayerObject::addEvent( eventType type, eventFunc func, float activationTime )
 {
-	m_events.push_back(eventStruct(type,func,getFloatTime()+activationTime));
+	sEventMgr.AddEvent(this,type,func,uint32(activationTime*1000.0f));
 }
 
 size_t PlayerObject::cancelEvents( eventType type )
 {
-	size_t cancelledEvents=0;
-	for(list<eventStruct>::iterator it=m_events.begin();it!=m_events.end();)
-	{
-		if (it->type == type)
-		{
-			it = m_events.erase(it);
-			cancelledEvents++;
-		}
-		else
-		{
-			++it;
-		}
-	}
-	return cancelledEvents;
+	return sEventMgr.CancelEvents(this,type);
 }
\ No newline at end of file
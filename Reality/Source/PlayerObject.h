@@ -28,15 +28,20 @@
 
 #include "LocationVector.h"
 #include "MessageTypes.h"
+#include "CallBack.h"
 
 class PlayerObject
 {
 public:
 	class CharacterNotFound {};
 
-	PlayerObject(class GameClient &parent,uint64 charUID);
+	// loadResults are the results of the queries AddLoadQueries put in
+	PlayerObject(class GameClient &parent,uint64 charUID,QueryResultVector &loadResults);
 	~PlayerObject();
 
+	static void AddLoadQueries(class AsyncQuery *query, uint64 charUID);
+	void ReloadFromResults(QueryResultVector &loadResults);
+
 	void InitializeWorld();
 	void SpawnSelf();
 	void PopulateWorld();
@@ -45,6 +50,7 @@ public:
 	void HandleStateUpdate(ByteBuffer &srcData);
 	void HandleCommand(ByteBuffer &srcCmd);
 
+	uint64 getCharacterUID() const {return m_characterUID;}
 	string getHandle() const {return m_handle;}
 	string getFirstName() const {return m_firstName;}
 	string getLastName() const {return m_lastName;}
@@ -106,7 +112,7 @@ private:
 	map<uint8,RPCHandler> m_RPCbyte;
 	map<uint16,RPCHandler> m_RPCshort;
 private:
-	void loadFromDB(bool updatePos=false);
+	void loadFromResults(class QueryResult *charResult, class QueryResult *rsiResult, bool updatePos=false);
 	void checkAndStore();
 	void saveDataToDB();
 	void setOnlineStatus( bool isOnline );
@@ -118,19 +124,10 @@ private:
 
 	typedef boost::function < void (void) > eventFunc;
 
+	//scheduled with the world's EventMgr
 	void addEvent(eventType type, eventFunc func, float activationTime);
 	size_t cancelEvents(eventType type);
 
-	struct eventStruct
-	{
-		eventStruct(eventType _type, eventFunc _func, float _fireTime) : type(_type), func(_func), fireTime(_fireTime) {}
-		eventType type;
-		eventFunc func;
-		float fireTime;
-	};
-
-	list<eventStruct> m_events;
-
 	void jackoutEvent();
 
 	void ParseAdminCommand(string theCmd);
@@ -190,32 +190,13 @@ void PlayerObject::ParseAdminCommand( string theCmd )
 			return;
 
 
-		std::string s;
-		std::stringstream out;
-		out << int(m_district);
-		s = out.str();
-
-		double X,Y,Z;
-		X = this->getPosition().x;
-		Y = this->getPosition().y;
-		Z = this->getPosition().z;
-
-		string sql1 = (format("DELETE FROM `locations` Where `District` = '%1%' And `Command` = '%2%'") % s % area ).str();
-		string sql2 = (format("INSERT INTO `locations` SET `District` = '%1%', `Command` = '%2%', X = '%3%', Y = '%4%', Z = '%5%'") % s % area % X % Y % Z ).str();
-		if (sDatabase.Execute(sql1))
+		if (sWorldData.SetLocation(m_district,area,this->getPosition()))
 		{
-			if (sDatabase.Execute(sql2))
-			{
-				m_parent.QueueCommand(make_shared<SystemChatMsg>("{c:FFFF00}New location set, test it out.{/c}"));
-			}
-			else
-			{
-				m_parent.QueueCommand(make_shared<SystemChatMsg>("{c:FF00FF}New location set, FAILED On INSERT.{/c}"));
-			}
+			m_parent.QueueCommand(make_shared<SystemChatMsg>("{c:FFFF00}New location set, test it out.{/c}"));
 		}
 		else
 		{
-			m_parent.QueueCommand(make_shared<SystemChatMsg>("{c:FF00FF}New location set, FAILED On DELETE.{/c}"));
+			m_parent.QueueCommand(make_shared<SystemChatMsg>("{c:FF00FF}New location set, FAILED to store it.{/c}"));
 		}
 
 		return;
@@ -249,34 +230,26 @@ void PlayerObject::ParseAdminCommand( string theCmd )
 		if (cmdStream.fail()) 
 			return;
 
-		std::string s;
-		std::stringstream out;
-		out << int(m_district);
-		s = out.str();
-
-		double X,Y,Z,O;
-		X = this->getPosition().x;
-		Y = this->getPosition().y;
-		Z = this->getPosition().z;
-		O = this->getPosition().rot;
+		uint16 theHardlineId;
+		try
+		{
+			theHardlineId = lexical_cast<uint16>(hardlineId);
+		}
+		catch (boost::bad_lexical_cast)
+		{
+			m_parent.QueueCommand(make_shared<SystemChatMsg>("{c:FF00FF}HardlineId must be a number.{/c}"));
+			return;
+		}
 
-		string sql1 = (format("DELETE FROM `hardlines` WHERE `DistrictId` = '%1%' AND `HardlineId` = '%2%'") % s % hardlineId ).str();
-		string sql2 = (format("INSERT INTO `hardlines` SET `DistrictId` = '%1%', `HardlineId`='%2%',`X`='%3%',`Y`='%4%',`Z`= '%5%',`HardlineName`='%6%',`ROT`='%7%'") % s % hardlineId % X % Y % Z % hardlineName % O).str();
-		if (sDatabase.Execute(sql1))
+		LocationVector loc = this->getPosition();
+		if (sWorldData.SetHardline(m_district,theHardlineId,hardlineName,loc))
 		{
-			if (sDatabase.Execute(sql2))
-			{
-				string msg1 = (format("{c:FFFF00}HardlineId:%1% Set to %2% at X:%3% Y:%4% Z:%5% O:%6%{/c}") % hardlineId % hardlineName % X % Y % Z % O ).str();
-				m_parent.QueueCommand(make_shared<SystemChatMsg>(msg1));
-			}
-			else
-			{
-				m_parent.QueueCommand(make_shared<SystemChatMsg>("{c:FF00FF}New hardline set, FAILED On INSERT.{/c}"));
-			}
+			string msg1 = (format("{c:FFFF00}HardlineId:%1% Set to %2% at X:%3% Y:%4% Z:%5% O:%6%{/c}") % hardlineId % hardlineName % loc.x % loc.y % loc.z % loc.rot ).str();
+			m_parent.QueueCommand(make_shared<SystemChatMsg>(msg1));
 		}
 		else
 		{
-			m_parent.QueueCommand(make_shared<SystemChatMsg>("{c:FF00FF}New hardline set, FAILED On DELETE.{/c}"));
+			m_parent.QueueCommand(make_shared<SystemChatMsg>("{c:FF00FF}New hardline set, FAILED to store it.{/c}"));
 		}
 
 		return;
@@ -473,16 +446,14 @@ void PlayerObject::ParsePlayerCommand( string theCmd )
 		if (cmdStream.fail()) //Get list and whisper it but for now we just fail
 			return;
 
-		format sql = format("SELECT `X`,`Y`,`Z` FROM `locations` Where `District` = '%1%' And `Command` = '%2%' LIMIT 1") % int(getDistrict()) % area ;
-		scoped_ptr<QueryResult> result(sDatabase.Query(sql));
-		if (!result)
+		const WorldDataMgr::LocationData *theLocation = sWorldData.GetLocation(getDistrict(),area);
+		if (theLocation == NULL)
 			return;
 		else
 		{
-			Field *field = result->Fetch();
-			double newX = field[0].GetDouble();
-			double newY = field[1].GetDouble();
-			double newZ = field[2].GetDouble();
+			double newX = theLocation->pos.x;
+			double newY = theLocation->pos.y;
+			double newZ = theLocation->pos.z;
 
 			string message1 = (format("{c:00FF00}Welcome to %1%.{/c}") % area ).str();
 			m_parent.QueueCommand(make_shared<SystemChatMsg>(message1));
@@ -667,18 +638,10 @@ void PlayerObject::RPC_HandleStaticObjInteraction( ByteBuffer &srcCmd )
 	{
 		LocationVector loc = this->getPosition();
 
-		scoped_ptr<QueryResult> resultDoorExists(sDatabase.Query(format("SELECT * FROM `doors` WHERE `DistrictId`='%1%' And `DoorId`='%2%' Limit 1") % (int)getDistrict() % staticObjId));
-		if (resultDoorExists == NULL)
+		if (sWorldData.GetDoor(getDistrict(),staticObjId) == NULL)
 		{
 			m_parent.QueueCommand(make_shared<SystemChatMsg>("{c:FFFF00}You are using a door not in the database yet, lets add it{/c}"));	
-			format sqlDoorInsert = 
-				format("INSERT INTO `doors` SET  `DistrictId` = '%1%', `DoorId` = '%2%', X = '%3%', Y = '%4%', Z = '%5%', ROT = '%6%', FirstUser = '%7%'")
-				% (int)m_district
-				% staticObjId
-				% loc.x	% loc.y	% loc.z	% loc.rot
-				% this->getHandle();
-
-			if (sDatabase.Execute(sqlDoorInsert))
+			if (sWorldData.AddDoor(m_district,staticObjId,loc,this->getHandle()))
 			{
 				format msg1 = 
 					format("{c:00FF00}Door:0x%08x in District %d Set to Location X:%f Y:%f Z:%f O:%f{/c}")
@@ -933,23 +896,12 @@ void PlayerObject::RPC_HandleHardlineTeleport( ByteBuffer &srcCmd )
 	//See if we need to add this HL to the DB
 	LocationVector loc = this->getPosition();
 
-	format sqlHLExists = 
-		format("SELECT * FROM `hardlines` WHERE `DistrictId`='%1%' AND `HardlineId`='%2%' LIMIT 1")
-		% (int)districtYouAreIn 
-		% (int)hardlineYouAreUsing;
-
-	scoped_ptr<QueryResult> resultHLExists(sDatabase.Query(sqlHLExists));
-	if (resultHLExists == NULL)
+	if (sWorldData.GetHardline(districtYouAreIn,hardlineYouAreUsing) == NULL)
 	{
 		m_parent.QueueCommand(make_shared<SystemChatMsg>("{c:FFFF00}You are at a hardline not in the database yet, lets add it so all can use it :){/c}"));	
-		format sqlHLInsert = 
-			format("INSERT INTO `hardlines` SET `DistrictId` = '%1%', `HardlineId` = '%2%', X = '%3%', Y = '%4%', Z = '%5%', ROT = '%6%', HardlineName = 'Tagged By %7%'")
-			% (int)districtYouAreIn 
-			% (int)hardlineYouAreUsing 
-			% loc.x % loc.y % loc.z % loc.rot
-			% this->getHandle();
-
-		if (sDatabase.Execute(sqlHLInsert))
+		string hardlineName = (format("Tagged By %1%") % this->getHandle()).str();
+
+		if (sWorldData.SetHardline(districtYouAreIn,hardlineYouAreUsing,hardlineName,loc))
 		{
 			format msg1 = 
 				format("{c:00FF00}HardlineId:%1% in District %7% Set to Tagged By %2% at X:%3% Y:%4% Z:%5% O:%6%{/c}")
@@ -967,31 +919,17 @@ void PlayerObject::RPC_HandleHardlineTeleport( ByteBuffer &srcCmd )
 
 	}
 
-	format sql = 
-		format("SELECT `X`,`Y`,`Z`, `ROT`, `HardlineName` FROM `hardlines` Where `DistrictId` = '%1%' And `HardlineId` = '%2%' LIMIT 1")
-		% (int)hardlineDistrict 
-		% (int)hardlineLocation;
-
-	scoped_ptr<QueryResult> result(sDatabase.Query(sql));
-	if (result == NULL)
+	const WorldDataMgr::HardlineData *theHardline = sWorldData.GetHardline(hardlineDistrict,hardlineLocation);
+	if (theHardline == NULL)
 	{
 		m_parent.QueueCommand(make_shared<SystemChatMsg>("{c:FF0000}The hardline you selected is not in the database yet, go tag it...{/c}"));	
 	}
 	else
 	{
-		Field *field = result->Fetch();
-		double newX = field[0].GetDouble();
-		double newY = field[1].GetDouble();
-		double newZ = field[2].GetDouble();
-		double newRot = field[3].GetDouble();
-		string newlocationName = field[4].GetString();
-
-		format message1 = format("{c:00FFFF}Welcome to %1%.{/c}") % newlocationName;
+		format message1 = format("{c:00FFFF}Welcome to %1%.{/c}") % theHardline->name;
 		m_parent.QueueCommand(make_shared<SystemChatMsg>(message1.str()));
 
-		LocationVector newLoc(newX, newY, newZ);
-		newLoc.rot = newRot;
-		this->setPosition(newLoc);
+		this->setPosition(theHardline->pos);
 		sGame.AnnounceStateUpdate(NULL,make_shared<PositionStateMsg>(m_goId));
 	}
 }
@@ -1034,7 +972,6 @@ void PlayerObject::RPC_HandleJackoutRequest( ByteBuffer &srcCmd )
 void PlayerObject::jackoutEvent()
 {
 	m_parent.QueueCommand(make_shared<HexGenericMsg>("80fd000000000000"));
-	m_parent.FlushQueue();
 	//hack, should see why client doesnt send jackout complete msg, instead of invalidating here
 	//m_parent.Invalidate();
 }
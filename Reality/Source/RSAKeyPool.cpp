@@ -0,0 +1,174 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#include "Common.h"
+#include "RSAKeyPool.h"
+#include "Threading/Threading.h"
+#include "Log.h"
+#include "Util.h"
+
+RSAKeyPool::RSAKeyPool() : m_cond(&m_lock)
+{
+	m_poolSize = 0;
+	m_generatorRunning = false;
+	m_stopping = false;
+	m_dryTakes = 0;
+}
+
+RSAKeyPool::~RSAKeyPool()
+{
+	Stop();
+}
+
+void RSAKeyPool::Start( uint32 poolSize )
+{
+	if (poolSize < 1)
+		poolSize = 1;
+
+	m_cond.BeginSynchronized();
+	m_poolSize = poolSize;
+	m_stopping = false;
+	bool alreadyRunning = m_generatorRunning;
+	m_generatorRunning = true;
+	m_cond.EndSynchronized();
+
+	if (!alreadyRunning)
+		ThreadPool.ExecuteTask(new RSAKeyPoolThread(this));
+
+	INFO_LOG(format("RSA key pool keeping %1% user keypairs ready") % poolSize);
+}
+
+void RSAKeyPool::Stop()
+{
+	m_cond.BeginSynchronized();
+	m_stopping = true;
+	m_cond.Broadcast();
+	m_cond.EndSynchronized();
+
+	//the generator may be in the middle of a key, wait for it to notice
+	for (;;)
+	{
+		m_cond.BeginSynchronized();
+		bool running = m_generatorRunning;
+		m_cond.EndSynchronized();
+
+		if (!running)
+			break;
+
+		Sleep(10);
+	}
+}
+
+void RSAKeyPool::Take( UserKey &keyOut )
+{
+	m_cond.BeginSynchronized();
+	if (m_ready.empty())
+	{
+		m_dryTakes++;
+		WARNING_LOG(format("RSA key pool ran dry (%1% times so far), consider raising AuthServer.RSAKeyPoolSize") % m_dryTakes);
+	}
+	while (m_ready.empty() && m_generatorRunning && !m_stopping)
+		m_cond.Wait();
+
+	if (m_ready.empty())
+	{
+		//nobody is going to refill it, make one ourselves
+		m_cond.EndSynchronized();
+
+		CryptoPP::AutoSeededRandomPool randPool;
+		Generate(randPool,keyOut);
+		return;
+	}
+
+	keyOut = m_ready.front();
+	m_ready.pop_front();
+	//wake the generator up so it replaces this one
+	m_cond.Broadcast();
+	m_cond.EndSynchronized();
+}
+
+uint32 RSAKeyPool::GetReadyCount()
+{
+	m_cond.BeginSynchronized();
+	uint32 readyCount = uint32(m_ready.size());
+	m_cond.EndSynchronized();
+	return readyCount;
+}
+
+void RSAKeyPool::Generate( CryptoPP::RandomNumberGenerator &rng, UserKey &keyOut )
+{
+	for (;;)
+	{
+		CryptoPP::InvertibleRSAFunction params;
+		params.GenerateRandomWithKeySize( rng, 768 );
+		CryptoPP::RSA::PublicKey userPubKey(params);
+		CryptoPP::RSA::PrivateKey userPrivKey(params);
+		keyOut.publicExponent = uint16(userPubKey.GetPublicExponent().ConvertToLong()); 
+		byte tempBuf[96];
+		userPubKey.GetModulus().Encode(tempBuf,sizeof(tempBuf));
+		keyOut.publicModulus = string((const char*)tempBuf,sizeof(tempBuf));
+		keyOut.privateExponent.clear();
+		CryptoPP::StringSink privateExponentSink(keyOut.privateExponent);
+		userPrivKey.GetPrivateExponent().Encode(privateExponentSink,userPrivKey.GetPrivateExponent().MinEncodedSize());
+
+		if (keyOut.publicExponent == 17 && keyOut.publicModulus.size() == 96 && keyOut.privateExponent.size() == 96)
+		{
+			break;
+		}
+	}
+}
+
+void RSAKeyPool::thread_proc()
+{
+	//one generator for the lifetime of the thread, seeding it is expensive
+	CryptoPP::AutoSeededRandomPool randPool;
+
+	m_cond.BeginSynchronized();
+	while (!m_stopping)
+	{
+		if (m_ready.size() >= m_poolSize)
+		{
+			m_cond.Wait();
+			continue;
+		}
+		m_cond.EndSynchronized();
+
+		UserKey newKey;
+		Generate(randPool,newKey);
+
+		m_cond.BeginSynchronized();
+		m_ready.push_back(newKey);
+		m_cond.Broadcast();
+	}
+	m_generatorRunning = false;
+	m_cond.EndSynchronized();
+}
+
+bool RSAKeyPoolThread::run()
+{
+	SetThreadName("RSA Key Pool");
+	m_pool->thread_proc();
+	return true;
+}
@@ -0,0 +1,84 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_RSAKEYPOOL_H
+#define MXOEMU_RSAKEYPOOL_H
+
+#include "Common.h"
+#include "Crypto.h"
+#include "Threading/ThreadStarter.h"
+#include "Threading/Condition.h"
+
+// Keeps a stock of ready made 768 bit RSA keypairs for user accounts.
+// Generating one takes anywhere from tens to hundreds of milliseconds, which the auth thread
+// can't afford while other clients are waiting on it, so a background thread generates them
+// and tops the pool back up whenever one is taken.
+class RSAKeyPool
+{
+public:
+	struct UserKey
+	{
+		UserKey() : publicExponent(0) {}
+
+		uint16 publicExponent;
+		string publicModulus;
+		string privateExponent;
+	};
+
+	RSAKeyPool();
+	~RSAKeyPool();
+
+	void Start(uint32 poolSize);
+	void Stop();
+
+	// hands out a ready keypair, only has to wait if the pool ran dry
+	void Take(UserKey &keyOut);
+	uint32 GetReadyCount();
+
+	// generates a keypair of the shape the client expects (exponent 17, 96 byte modulus and private exponent)
+	static void Generate(CryptoPP::RandomNumberGenerator &rng, UserKey &keyOut);
+private:
+	friend class RSAKeyPoolThread;
+	void thread_proc();
+
+	NativeMutex m_lock;
+	Condition m_cond;
+	deque<UserKey> m_ready;
+	uint32 m_poolSize;
+	bool m_generatorRunning;
+	bool m_stopping;
+	uint32 m_dryTakes;
+};
+
+class RSAKeyPoolThread : public ThreadContext
+{
+public:
+	RSAKeyPoolThread(RSAKeyPool *pool) : ThreadContext(), m_pool(pool) {}
+	bool run();
+private:
+	RSAKeyPool *m_pool;
+};
+
+#endif
@@ -0,0 +1,182 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#include "SessionRegistry.h"
+
+// lives for the whole process, so neither server has to outlive the other
+createFileSingleton( SessionRegistry );
+
+void SessionRegistry::Publish( const Session &theSession )
+{
+	SessionPtr newSession = make_shared<Session>(theSession);
+
+	m_lock.Acquire();
+	sessionsMap::iterator it = m_sessions.find(theSession.sessionId);
+	if (it != m_sessions.end())
+		UnlinkCharacter(it->second);
+
+	m_sessions[theSession.sessionId] = newSession;
+	if (theSession.charUID != 0)
+		m_sessionsByChar[theSession.charUID].push_back(theSession.sessionId);
+	m_lock.Release();
+}
+
+void SessionRegistry::Remove( uint32 sessionId )
+{
+	m_lock.Acquire();
+	sessionsMap::iterator it = m_sessions.find(sessionId);
+	if (it != m_sessions.end())
+	{
+		UnlinkCharacter(it->second);
+		m_sessions.erase(it);
+	}
+	m_lock.Release();
+}
+
+void SessionRegistry::UnlinkCharacter( const SessionPtr &theSession )
+{
+	if (theSession->charUID == 0)
+		return;
+
+	charSessionsMap::iterator it = m_sessionsByChar.find(theSession->charUID);
+	if (it == m_sessionsByChar.end())
+		return;
+
+	vector<uint32> &charSessions = it->second;
+	charSessions.erase(std::remove(charSessions.begin(),charSessions.end(),theSession->sessionId),charSessions.end());
+	if (charSessions.empty())
+		m_sessionsByChar.erase(it);
+}
+
+SessionRegistry::SessionPtr SessionRegistry::FindBySessionId( uint32 sessionId )
+{
+	SessionPtr theSession;
+
+	m_lock.Acquire();
+	sessionsMap::iterator it = m_sessions.find(sessionId);
+	if (it != m_sessions.end())
+		theSession = it->second;
+	m_lock.Release();
+
+	return theSession;
+}
+
+vector<SessionRegistry::SessionPtr> SessionRegistry::FindByCharacterUID( uint64 charUID )
+{
+	vector<SessionPtr> charSessions;
+
+	m_lock.Acquire();
+	charSessionsMap::iterator it = m_sessionsByChar.find(charUID);
+	if (it != m_sessionsByChar.end())
+	{
+		foreach(uint32 sessionId, it->second)
+		{
+			sessionsMap::iterator sessIt = m_sessions.find(sessionId);
+			if (sessIt != m_sessions.end())
+				charSessions.push_back(sessIt->second);
+		}
+	}
+	m_lock.Release();
+
+	return charSessions;
+}
+
+size_t SessionRegistry::GetCount()
+{
+	m_lock.Acquire();
+	size_t theCount = m_sessions.size();
+	m_lock.Release();
+
+	return theCount;
+}
+
+bool SessionRegistry::RequestUdpReady( uint32 sessionId )
+{
+	return QueueAction(sessionId,MarginAction::ACTION_UDP_READY);
+}
+
+bool SessionRegistry::RequestDisconnect( uint32 sessionId )
+{
+	return QueueAction(sessionId,MarginAction::ACTION_DISCONNECT);
+}
+
+bool SessionRegistry::QueueAction( uint32 sessionId, MarginAction::ActionType type )
+{
+	bool queued = false;
+
+	m_lock.Acquire();
+	sessionsMap::iterator it = m_sessions.find(sessionId);
+	if (it != m_sessions.end())
+	{
+		uint32 marginShard = it->second->marginShard;
+		m_pendingActions.push_back(MarginAction(type,sessionId,it->second->marginSocket,marginShard));
+		queued = true;
+
+		if (marginShard < m_marginWakeups.size() && !m_marginWakeups[marginShard].empty())
+			m_marginWakeups[marginShard]();
+	}
+	m_lock.Release();
+
+	return queued;
+}
+
+void SessionRegistry::TakeMarginActions( uint32 marginShard, vector<MarginAction> &outActions )
+{
+	m_lock.Acquire();
+	vector<MarginAction> otherShards;
+	foreach(const MarginAction &theAction, m_pendingActions)
+	{
+		if (theAction.marginShard == marginShard)
+			outActions.push_back(theAction);
+		else
+			otherShards.push_back(theAction);
+	}
+	m_pendingActions.swap(otherShards);
+	m_lock.Release();
+}
+
+void SessionRegistry::SetMarginWakeup( uint32 marginShard, Wakeup wakeup )
+{
+	m_lock.Acquire();
+	if (marginShard >= m_marginWakeups.size())
+		m_marginWakeups.resize(marginShard+1);
+	m_marginWakeups[marginShard] = wakeup;
+	m_lock.Release();
+}
+
+void SessionRegistry::ReportActionFailed( uint32 sessionId )
+{
+	m_lock.Acquire();
+	m_failedSessions.push_back(sessionId);
+	m_lock.Release();
+}
+
+void SessionRegistry::TakeFailedSessions( vector<uint32> &outSessions )
+{
+	m_lock.Acquire();
+	outSessions.swap(m_failedSessions);
+	m_failedSessions.clear();
+	m_lock.Release();
+}
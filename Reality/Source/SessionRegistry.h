@@ -0,0 +1,117 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_SESSIONREGISTRY_H
+#define MXOEMU_SESSIONREGISTRY_H
+
+#include "Common.h"
+#include "Singleton.h"
+#include "SymmetricCrypto.h"
+#include "Threading/NativeMutex.h"
+#include <Sockets/socket_include.h>
+
+// Margin sessions as the game server sees them. The margin thread publishes a session
+// once it has handed out a session id, and again once a character is picked. The game thread
+// looks sessions up by id or character without touching margin sockets.
+// Published records are never modified, a change publishes a new one, so a SessionPtr
+// held by a reader stays consistent for as long as it's held.
+// The game thread never calls into margin sockets either, it queues an action here instead
+// and the margin thread performs it from its loop.
+class SessionRegistry : public Singleton<SessionRegistry>
+{
+public:
+	struct Session
+	{
+		Session() : sessionId(0), charUID(0), worldCharId(0), userId(0), marginSocket(0), marginShard(0) {}
+
+		uint32 sessionId;
+		uint64 charUID;
+		uint32 worldCharId;
+		uint32 userId;
+		//expanded once by the margin, the game client's engine shares it
+		TwofishKeySchedulePtr twofishSchedule;
+		socketuid_t marginSocket;
+		uint32 marginShard;
+	};
+	typedef shared_ptr<const Session> SessionPtr;
+
+	struct MarginAction
+	{
+		enum ActionType
+		{
+			ACTION_UDP_READY,
+			ACTION_DISCONNECT
+		};
+		MarginAction(ActionType theType, uint32 theSession, socketuid_t theSocket, uint32 theShard) : type(theType), sessionId(theSession), marginSocket(theSocket), marginShard(theShard) {}
+
+		ActionType type;
+		uint32 sessionId;
+		socketuid_t marginSocket;
+		uint32 marginShard;
+	};
+
+	SessionRegistry() {}
+	~SessionRegistry() {}
+
+	// replaces whatever was published under the same session id
+	void Publish(const Session &theSession);
+	void Remove(uint32 sessionId);
+
+	SessionPtr FindBySessionId(uint32 sessionId);
+	vector<SessionPtr> FindByCharacterUID(uint64 charUID);
+	size_t GetCount();
+
+	// called from the game thread, false if the session is already gone
+	bool RequestUdpReady(uint32 sessionId);
+	bool RequestDisconnect(uint32 sessionId);
+	// called from each margin thread, only hands out the actions for its own shard
+	void TakeMarginActions(uint32 marginShard, vector<MarginAction> &outActions);
+	// called whenever an action is queued for the shard, so its thread doesn't sleep on it
+	typedef boost::function<void ()> Wakeup;
+	void SetMarginWakeup(uint32 marginShard, Wakeup wakeup);
+
+	// called from a margin thread when an action it was asked for couldn't be done,
+	// the game thread takes these every loop and drops the clients on those sessions
+	void ReportActionFailed(uint32 sessionId);
+	void TakeFailedSessions(vector<uint32> &outSessions);
+private:
+	bool QueueAction(uint32 sessionId, MarginAction::ActionType type);
+	void UnlinkCharacter(const SessionPtr &theSession);
+
+	NativeMutex m_lock;
+
+	typedef unordered_map<uint32,SessionPtr> sessionsMap;
+	sessionsMap m_sessions;
+	typedef unordered_map<uint64,vector<uint32> > charSessionsMap;
+	charSessionsMap m_sessionsByChar;
+
+	vector<MarginAction> m_pendingActions;
+	vector<Wakeup> m_marginWakeups;
+	vector<uint32> m_failedSessions;
+};
+
+#define sSessions SessionRegistry::getSingleton()
+
+#endif
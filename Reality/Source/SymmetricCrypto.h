@@ -30,159 +30,202 @@
 #include "ByteBuffer.h"
 #include "Util.h"
 
+// Expanded key for one session. It's built once when the key is agreed on and never
+// changes afterwards, so every engine using that key (on any thread) can share it.
+template <class CRYPTENGINE>
+class SymmetricKeySchedule
+{
+public:
+	SymmetricKeySchedule(const byte key[], size_t keySize)
+		: m_encrypt(key,keySize), m_decrypt(key,keySize)
+	{
+	}
+
+	const typename CRYPTENGINE::Encryption &GetEncryption() const { return m_encrypt; }
+	const typename CRYPTENGINE::Decryption &GetDecryption() const { return m_decrypt; }
+private:
+	typename CRYPTENGINE::Encryption m_encrypt;
+	typename CRYPTENGINE::Decryption m_decrypt;
+};
+
+// CBC over a shared key schedule. All the engine owns is the two chaining vectors,
+// so setting an IV per packet is just a copy.
 template <class CRYPTENGINE>
 class SymmetricCryptEngine
 {
 public:
-	SymmetricCryptEngine():valid(false)
+	typedef SymmetricKeySchedule<CRYPTENGINE> KeySchedule;
+	typedef shared_ptr<const KeySchedule> KeySchedulePtr;
+
+	SymmetricCryptEngine()
 	{
+		Invalidate();
 	}
 	~SymmetricCryptEngine()
 	{
 		Invalidate();
 	}
 
-	bool IsValid() { return valid; }
+	static KeySchedulePtr ExpandKey(const byte key[], size_t keySize)
+	{
+		if (keySize < CRYPTENGINE::BLOCKSIZE || keySize > CRYPTENGINE::MAX_KEYLENGTH)
+		{
+			return KeySchedulePtr();
+		}
+
+		try
+		{
+			return KeySchedulePtr(new KeySchedule(key,keySize));
+		}
+		catch (...)
+		{
+			return KeySchedulePtr();
+		}
+	}
+
+	bool IsValid() { return m_schedule != NULL; }
 	void Invalidate()
 	{
-		valid=false;
-		m_encrypt.reset();
-		m_decrypt.reset();
+		m_schedule.reset();
+		memset(m_encryptIV,0,sizeof(m_encryptIV));
+		memset(m_decryptIV,0,sizeof(m_decryptIV));
 	}
 	bool Initialize(const byte key[], size_t keySize)
 	{
-		if (keySize < CRYPTENGINE::BLOCKSIZE || keySize > CRYPTENGINE::MAX_KEYLENGTH)
+		return Initialize(ExpandKey(key,keySize));
+	}
+	bool Initialize(KeySchedulePtr schedule)
+	{
+		Invalidate();
+		if (schedule == NULL)
 		{
-			Invalidate();
 			return false;
 		}
-		byte blankIV[CRYPTENGINE::BLOCKSIZE];
-		memset(blankIV,0,sizeof(blankIV));
-
-		Invalidate();
-		m_decrypt.reset(new Decryptor(key,keySize,blankIV));
-		m_encrypt.reset(new Encryptor(key,keySize,blankIV));
 
-		valid = true;
+		m_schedule = schedule;
 		return true;
 	}
+	KeySchedulePtr GetKeySchedule() { return m_schedule; }
+
 	bool SetEncryptionIV(const byte iv[], size_t ivSize)
 	{
-		if (ivSize != CRYPTENGINE::BLOCKSIZE || valid==false || m_encrypt == NULL)
+		if (ivSize != CRYPTENGINE::BLOCKSIZE || m_schedule == NULL)
 		{
 			return false;
 		}
-		m_encrypt->Resynchronize(iv,(int)ivSize);
+		memcpy(m_encryptIV,iv,ivSize);
 		return true;
 	}
 	bool SetEncryptionIV()
 	{
-		if (valid == false || m_encrypt == NULL)
+		if (m_schedule == NULL)
 		{
 			return false;
 		}
-
-		byte blankIV[CRYPTENGINE::BLOCKSIZE];
-		memset(blankIV,0,sizeof(blankIV));
-		m_encrypt->Resynchronize(blankIV,sizeof(blankIV));
+		memset(m_encryptIV,0,sizeof(m_encryptIV));
 		return true;
 	}
 	bool SetDecryptionIV(const byte iv[],size_t ivSize)
 	{
-		if (ivSize != CRYPTENGINE::BLOCKSIZE || valid==false || m_decrypt == NULL)
+		if (ivSize != CRYPTENGINE::BLOCKSIZE || m_schedule == NULL)
 		{
 			return false;
 		}
-
-		m_decrypt->Resynchronize(iv,(int)ivSize);
+		memcpy(m_decryptIV,iv,ivSize);
 		return true;
 	}
 	bool SetDecryptionIV()
 	{
-		if (valid == false || m_decrypt == NULL)
+		if (m_schedule == NULL)
 		{
 			return false;
 		}
-
-		byte blankIV[CRYPTENGINE::BLOCKSIZE];
-		memset(blankIV,0,sizeof(blankIV));
-		m_decrypt->Resynchronize(blankIV,sizeof(blankIV));
+		memset(m_decryptIV,0,sizeof(m_decryptIV));
 		return true;
 	}
+	// padding is PKCS #7, same as CryptoPP's DEFAULT_PADDING for CBC
 	ByteBuffer Encrypt(const byte *data, size_t dataSize,bool padding=true)
 	{
-		if (dataSize < 1 || valid==false)
+		if (dataSize < 1 || m_schedule == NULL)
 		{
 			return ByteBuffer();
 		}
 
-		string inputStr((const char*)data,dataSize);
-		string outputStr;
-
-		try
+		const size_t blockSize = CRYPTENGINE::BLOCKSIZE;
+		size_t outSize = dataSize;
+		if (padding == true)
 		{
-			CryptoPP::BlockPaddingSchemeDef::BlockPaddingScheme paddingScheme = CryptoPP::BlockPaddingSchemeDef::NO_PADDING;
-			if (padding == true)
-			{
-				paddingScheme = CryptoPP::BlockPaddingSchemeDef::DEFAULT_PADDING;
-			}
-
-			CryptoPP::StringSource(inputStr, true, 
-				new CryptoPP::StreamTransformationFilter(
-				*m_encrypt, new CryptoPP::StringSink(outputStr),
-				paddingScheme));
+			outSize = (dataSize/blockSize + 1) * blockSize;
 		}
-		catch (...)
+		else if (dataSize % blockSize != 0)
 		{
 			return ByteBuffer();
 		}
 
-		return ByteBuffer(outputStr);
+		ByteBuffer output;
+		output.resize(outSize);
+		byte *outPtr = (byte*)output.contents();
+
+		const typename CRYPTENGINE::Encryption &cipher = m_schedule->GetEncryption();
+		byte block[CRYPTENGINE::BLOCKSIZE];
+		for (size_t pos=0; pos<outSize; pos+=blockSize)
+		{
+			for (size_t i=0; i<blockSize; i++)
+			{
+				byte plain = (pos+i < dataSize) ? data[pos+i] : byte(outSize-dataSize);
+				block[i] = plain ^ m_encryptIV[i];
+			}
+			cipher.ProcessBlock(block,&outPtr[pos]);
+			memcpy(m_encryptIV,&outPtr[pos],blockSize);
+		}
+
+		return output;
 	}
 	ByteBuffer Decrypt(const byte* data, size_t dataSize,bool padding=true)
 	{
-		if (dataSize < 1 || valid==false)
+		const size_t blockSize = CRYPTENGINE::BLOCKSIZE;
+		if (dataSize < 1 || m_schedule == NULL || dataSize % blockSize != 0)
 		{
 			return ByteBuffer();
 		}
 
-		string inputStr((const char*)data,dataSize);
-		string outputStr;
+		ByteBuffer output;
+		output.resize(dataSize);
+		byte *outPtr = (byte*)output.contents();
 
-		try
+		const typename CRYPTENGINE::Decryption &cipher = m_schedule->GetDecryption();
+		for (size_t pos=0; pos<dataSize; pos+=blockSize)
 		{
-			CryptoPP::BlockPaddingSchemeDef::BlockPaddingScheme paddingScheme = CryptoPP::BlockPaddingSchemeDef::NO_PADDING;
-			if (padding == true)
-			{
-				paddingScheme = CryptoPP::BlockPaddingSchemeDef::DEFAULT_PADDING;
-			}
-
-			CryptoPP::StringSource(inputStr, true, 
-				new CryptoPP::StreamTransformationFilter(
-				*m_decrypt, new CryptoPP::StringSink(outputStr),
-				paddingScheme));
+			cipher.ProcessAndXorBlock(&data[pos],m_decryptIV,&outPtr[pos]);
+			memcpy(m_decryptIV,&data[pos],blockSize);
 		}
-		catch (...)
+
+		if (padding == true)
 		{
-			return ByteBuffer();
+			size_t padLen = outPtr[dataSize-1];
+			if (padLen < 1 || padLen > blockSize)
+			{
+				return ByteBuffer();
+			}
+			for (size_t i=dataSize-padLen; i<dataSize; i++)
+			{
+				if (outPtr[i] != padLen)
+					return ByteBuffer();
+			}
+			output.resize(dataSize-padLen);
 		}
 
-		return ByteBuffer(outputStr);
+		return output;
 	}
 
 private:
-	typedef typename CryptoPP::CBC_Mode<CRYPTENGINE>::Decryption Decryptor;
-	typedef typename CryptoPP::CBC_Mode<CRYPTENGINE>::Encryption Encryptor;
-	typedef shared_ptr<Decryptor> DecryptorPtr;
-	typedef shared_ptr<Encryptor> EncryptorPtr;
-
-	DecryptorPtr m_decrypt;
-	EncryptorPtr m_encrypt;
-
-	bool valid;
+	KeySchedulePtr m_schedule;
+	byte m_encryptIV[CRYPTENGINE::BLOCKSIZE];
+	byte m_decryptIV[CRYPTENGINE::BLOCKSIZE];
 };
 
 typedef CryptoPP::Twofish TwofishCryptMethod;
 typedef SymmetricCryptEngine<TwofishCryptMethod> TwofishCryptEngine;
+typedef TwofishCryptEngine::KeySchedulePtr TwofishKeySchedulePtr;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,150 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_SYMMETRICCRYPTOTEST_H
+#define MXOEMU_SYMMETRICCRYPTOTEST_H
+
+#define UNITTEST
+
+#include "Common.h"
+#include "Util.h"
+#include "Timer.h"
+#include "SymmetricCrypto.h"
+
+// Twofish throughput for 1KB game packets, the way the old engine did it (CryptoPP's CBC mode objects,
+// resynchronized and run through a StreamTransformationFilter per packet) against TwofishCryptEngine.
+// Also checks both produce the same ciphertext, and times setting up a session's engines.
+
+static const uint32 TF_BENCH_PACKETS = 20000;
+static const uint32 TF_BENCH_PACKET_SIZE = 1024;
+static const uint32 TF_BENCH_SESSIONS = 20000;
+
+typedef CryptoPP::CBC_Mode<TwofishCryptMethod>::Encryption LegacyTwofishEncryption;
+typedef CryptoPP::CBC_Mode<TwofishCryptMethod>::Decryption LegacyTwofishDecryption;
+
+string legacyProcess(CryptoPP::StreamTransformation &mode, const byte *data, size_t dataSize)
+{
+	string outputStr;
+	CryptoPP::StringSource(string((const char*)data,dataSize), true, 
+		new CryptoPP::StreamTransformationFilter(mode, new CryptoPP::StringSink(outputStr),
+		CryptoPP::BlockPaddingSchemeDef::DEFAULT_PADDING));
+	return outputStr;
+}
+
+bool checkTwofishEngine(const byte *key, const byte *iv, const byte *packet)
+{
+	LegacyTwofishEncryption legacyEncrypt(key,16,iv);
+	TwofishCryptEngine engine;
+	engine.Initialize(key,16);
+
+	//every length around a block boundary, padding has to come out the same
+	for (size_t len=1; len<=TF_BENCH_PACKET_SIZE; len++)
+	{
+		legacyEncrypt.Resynchronize(iv);
+		string expected = legacyProcess(legacyEncrypt,packet,len);
+
+		engine.SetEncryptionIV(iv,16);
+		ByteBuffer cipherText = engine.Encrypt(packet,len,true);
+		if (cipherText.size() != expected.size() || memcmp(cipherText.contents(),expected.data(),expected.size()))
+			return false;
+
+		engine.SetDecryptionIV(iv,16);
+		ByteBuffer plainText = engine.Decrypt((const byte*)cipherText.contents(),cipherText.size(),true);
+		if (plainText.size() != len || memcmp(plainText.contents(),packet,len))
+			return false;
+	}
+	return true;
+}
+
+void runTest()
+{
+	CryptoPP::AutoSeededRandomPool randPool;
+	byte key[16], iv[16];
+	byte packet[TF_BENCH_PACKET_SIZE];
+	randPool.GenerateBlock(key,sizeof(key));
+	randPool.GenerateBlock(iv,sizeof(iv));
+	randPool.GenerateBlock(packet,sizeof(packet));
+
+	cout << format("engine matches CryptoPP CBC: %1%") % (checkTwofishEngine(key,iv,packet) ? "yes" : "NO") << std::endl;
+
+	//packets, encrypt and decrypt each with its own IV
+	uint32 startTime = getMSTime();
+	{
+		LegacyTwofishEncryption legacyEncrypt(key,sizeof(key),iv);
+		LegacyTwofishDecryption legacyDecrypt(key,sizeof(key),iv);
+		for (uint32 i=0; i<TF_BENCH_PACKETS; i++)
+		{
+			legacyEncrypt.Resynchronize(iv);
+			string cipherText = legacyProcess(legacyEncrypt,packet,sizeof(packet));
+			legacyDecrypt.Resynchronize(iv);
+			legacyProcess(legacyDecrypt,(const byte*)cipherText.data(),cipherText.size());
+		}
+	}
+	uint32 legacyTime = getMSTime() - startTime;
+
+	startTime = getMSTime();
+	{
+		TwofishCryptEngine engine;
+		engine.Initialize(key,sizeof(key));
+		for (uint32 i=0; i<TF_BENCH_PACKETS; i++)
+		{
+			engine.SetEncryptionIV(iv,sizeof(iv));
+			ByteBuffer cipherText = engine.Encrypt(packet,sizeof(packet));
+			engine.SetDecryptionIV(iv,sizeof(iv));
+			engine.Decrypt((const byte*)cipherText.contents(),cipherText.size());
+		}
+	}
+	uint32 engineTime = getMSTime() - startTime;
+
+	uint64 totalKB = uint64(TF_BENCH_PACKETS) * 2 * TF_BENCH_PACKET_SIZE / 1024;
+	cout << format("%1% 1KB packets: legacy %2% ms (%3% KB/s), engine %4% ms (%5% KB/s)")
+		% TF_BENCH_PACKETS
+		% legacyTime % (totalKB * 1000 / (legacyTime ? legacyTime : 1))
+		% engineTime % (totalKB * 1000 / (engineTime ? engineTime : 1)) << std::endl;
+
+	//margin and game client both setting up a session, expanding the key each time vs sharing one schedule
+	startTime = getMSTime();
+	for (uint32 i=0; i<TF_BENCH_SESSIONS; i++)
+	{
+		LegacyTwofishEncryption marginEncrypt(key,sizeof(key),iv);
+		LegacyTwofishDecryption marginDecrypt(key,sizeof(key),iv);
+		LegacyTwofishEncryption gameEncrypt(key,sizeof(key),iv);
+		LegacyTwofishDecryption gameDecrypt(key,sizeof(key),iv);
+	}
+	legacyTime = getMSTime() - startTime;
+
+	startTime = getMSTime();
+	for (uint32 i=0; i<TF_BENCH_SESSIONS; i++)
+	{
+		TwofishCryptEngine marginEngine, gameEngine;
+		marginEngine.Initialize(key,sizeof(key));
+		gameEngine.Initialize(marginEngine.GetKeySchedule());
+	}
+	engineTime = getMSTime() - startTime;
+
+	cout << format("%1% session setups: legacy %2% ms, shared schedule %3% ms") % TF_BENCH_SESSIONS % legacyTime % engineTime << std::endl;
+}
+
+#endif
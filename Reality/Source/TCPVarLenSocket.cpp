@@ -25,64 +25,128 @@
 
 #include "TCPVarLenSocket.h"
 #include "Common.h"
+#include "Config.h"
+#include "Log.h"
 
 TCPVarLenSocket::TCPVarLenSocket(ISocketHandler& h) : TcpSocket(h)
 {
+	// we frame straight out of the read buffer in OnRawData, the circular input buffer would only be an extra copy
+	DisableInputBuffer(true);
+
+	m_maxFrameSize = sConfig.GetIntDefault("Network.MaxFrameSize", 0x7FFF);
+	m_maxPendingOutput = sConfig.GetIntDefault("Network.MaxPendingOutput", 256*1024);
+	// a client that keeps sending while we're holding its frames back gets cut off past this
+	m_maxPendingInput = sConfig.GetIntDefault("Network.MaxPendingInput", 64*1024);
+	if (m_maxPendingInput < m_maxFrameSize + 2)
+		m_maxPendingInput = m_maxFrameSize + 2;
 }
 
 TCPVarLenSocket::~TCPVarLenSocket()
 {
 }
 
+void TCPVarLenSocket::OnRawData( const char *buf,size_t len )
+{
+	if (m_pending.empty())
+	{
+		size_t used = ProcessFrames((const byte*)buf,len);
+		if (used < len)
+			m_pending.assign(buf+used,buf+len);
+	}
+	else
+	{
+		m_pending.insert(m_pending.end(),buf,buf+len);
+		ProcessPending();
+	}
+
+	if (m_pending.size() > m_maxPendingInput)
+	{
+		WARNING_LOG(format("%1% has %2% unprocessed bytes queued up, disconnecting") % GetRemoteAddress() % m_pending.size());
+		m_pending.clear();
+		SetCloseAndDelete(true);
+	}
+}
+
+void TCPVarLenSocket::OnWriteComplete()
+{
+	// output drained, let through whatever we held back
+	if (!m_pending.empty())
+		ProcessPending();
+}
+
+void TCPVarLenSocket::ProcessPending()
+{
+	size_t used = ProcessFrames(&m_pending[0],m_pending.size());
+	m_pending.erase(m_pending.begin(),m_pending.begin()+used);
+}
 
-void TCPVarLenSocket::OnRead()
+size_t TCPVarLenSocket::ProcessFrames( const byte *buf,size_t len )
 {
-	// OnRead of TcpSocket actually reads the data from the socket
-	// and moves it to the input buffer (ibuf)
-	TcpSocket::OnRead();
-	// get number of bytes in input buffer
-	size_t n = ibuf.GetLength();
-	if (n >= 2)
+	size_t pos = 0;
+	while (pos < len && !CloseAndDelete())
 	{
-		byte firstTwoBytes[2];
-		//peek first 2 bytes
-		ibuf.Peek((char*)&firstTwoBytes,2);
+		if (GetOutputLength() > m_maxPendingOutput)
+			break;
 
-		int sizeOfPacketSize = 1;
-		if (firstTwoBytes[0] > 0x7F)
+		size_t sizeOfPacketSize = 1;
+		uint16 packetSize = buf[pos];
+		if (packetSize > 0x7F)
 		{
+			if (len - pos < 2)
+				break;
+
 			sizeOfPacketSize = 2;
-			firstTwoBytes[0] -= 0x80;
+			packetSize = ((packetSize - 0x80) << 8) | buf[pos+1];
 		}
 
-		uint16 packetSize = 0;
-		if (sizeOfPacketSize == 1)
-		{
-			packetSize = firstTwoBytes[0];
-		}
-		else if (sizeOfPacketSize == 2)
+		if (packetSize > m_maxFrameSize)
 		{
-			memcpy(&packetSize,firstTwoBytes,sizeof(packetSize));
-			packetSize = swap16(packetSize);
+			WARNING_LOG(format("%1% sent a %2% byte frame, max is %3%, disconnecting") % GetRemoteAddress() % packetSize % m_maxFrameSize);
+			SetCloseAndDelete(true);
+			return len;
 		}
 
-		n = ibuf.GetLength();
-		size_t requiredLen = sizeOfPacketSize+packetSize;
-		if (n >= requiredLen)
-		{
-			ibuf.Remove(sizeOfPacketSize);
+		if (len - pos < sizeOfPacketSize + packetSize)
+			break;
 
-			vector<byte> tempStorage;
-			tempStorage.resize(packetSize);
-			ibuf.Read((char*)&tempStorage[0],tempStorage.size());
+		TrafficCounters *traffic = GetTrafficCounters();
+		if (traffic != NULL)
+			traffic->CountIn(sizeOfPacketSize + packetSize);
 
-			ProcessData(&tempStorage[0],tempStorage.size());
-		}
+		ProcessData(&buf[pos+sizeOfPacketSize],packetSize);
+		pos += sizeOfPacketSize + packetSize;
 	}
+
+	return pos;
 }
 
 void TCPVarLenSocket::SendPacket( const TCPVariableLengthPacket &varLenPacket )
 {
 	ByteBuffer withHeader = varLenPacket.GetProcessed();
+	TrafficCounters *traffic = GetTrafficCounters();
+	if (traffic != NULL)
+		traffic->CountOut(withHeader.size());
+
 	SendBuf(withHeader.contents(),withHeader.size());
 }
+
+void TCPVarLenSocket::SendPackets( const vector<TCPVariableLengthPacket> &varLenPackets )
+{
+	size_t totalSize = 0;
+	for (size_t i=0;i<varLenPackets.size();i++)
+		totalSize += varLenPackets[i].size()+2;
+
+	TrafficCounters *traffic = GetTrafficCounters();
+	ByteBuffer allFrames;
+	allFrames.reserve(totalSize);
+	for (size_t i=0;i<varLenPackets.size();i++)
+	{
+		size_t framesBefore = allFrames.size();
+		allFrames.append(varLenPackets[i].GetProcessed());
+		if (traffic != NULL)
+			traffic->CountOut(allFrames.size() - framesBefore);
+	}
+
+	if (allFrames.size() > 0)
+		SendBuf(allFrames.contents(),allFrames.size());
+}
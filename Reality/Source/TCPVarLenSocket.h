@@ -32,18 +32,38 @@
 #include <Sockets/TcpSocket.h>
 #include <Sockets/ISocketHandler.h>
 #include "TCPVariableLengthPacket.h"
+#include "Metrics.h"
 
+// Splits the stream into length prefixed frames. Every complete frame that arrived is handed to
+// ProcessData straight out of the read buffer, only a trailing partial frame gets copied aside.
+// While more than MaxPendingOutput bytes are waiting to be sent to the client we stop handing
+// out frames, and carry on once the output drains.
 class TCPVarLenSocket : public TcpSocket
 {
 public:
 	TCPVarLenSocket(ISocketHandler& h);
 	~TCPVarLenSocket();
 
-	void OnRead();
+	void OnRawData(const char *buf,size_t len);
+	void OnWriteComplete();
+
+	// where the frames this socket moves get counted, nowhere unless overridden
+	virtual TrafficCounters *GetTrafficCounters() { return NULL; }
 private:
 	virtual void ProcessData(const byte *buf,size_t len) = 0;
+
+	// returns how many bytes of buf were used up
+	size_t ProcessFrames(const byte *buf,size_t len);
+	void ProcessPending();
+
+	vector<byte> m_pending;
+	size_t m_maxFrameSize;
+	size_t m_maxPendingOutput;
+	size_t m_maxPendingInput;
 protected:
 	void SendPacket(const TCPVariableLengthPacket &varLenPacket);
+	// frames all of them into one buffer, so they leave in a single write
+	void SendPackets(const vector<TCPVariableLengthPacket> &varLenPackets);
 };
 
 #endif
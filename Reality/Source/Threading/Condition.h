@@ -69,74 +69,22 @@ public:
 
 	DWORD Wait(time_t timeout)
 	{
-		DWORD dwMillisecondsTimeout = (DWORD)timeout * 1000;
-		BOOL bAlertable = FALSE;
-		ASSERT(LockHeldByCallingThread());
-
-		// Enter a new event handle into the wait set.
-		HANDLE hWaitEvent = Push();
-		if( NULL == hWaitEvent )
-			return WAIT_FAILED;
-
-		// Store the current lock count for re-acquisition.
-		int nThisThreadsLockCount = m_nLockCount;
-		m_nLockCount = 0;
-
-		// Release the synchronization lock the appropriate number of times.
-		// Win32 allows no error checking here.
-		for( int i=0; i<nThisThreadsLockCount; ++i)
-		{
-			//::LeaveCriticalSection(&m_critsecSynchronized);
-			m_externalMutex->Release();
-		}
-
-		// NOTE: Conceptually, releasing the lock and entering the wait
-		// state is done in one atomic step. Technically, that is not
-		// true here, because we first leave the critical section and
-		// then, in a separate line of code, call WaitForSingleObjectEx.
-		// The reason why this code is correct is that our thread is placed
-		// in the wait set *before* the lock is released. Therefore, if
-		// we get preempted right here and another thread notifies us, then
-		// that notification will *not* be missed: the wait operation below
-		// will find the event signalled.
-
-		// Wait for the event to become signalled.
-		DWORD dwWaitResult = ::WaitForSingleObjectEx(
-			hWaitEvent,
-			dwMillisecondsTimeout,
-			bAlertable
-			);
-
-		// If the wait failed, store the last error because it will get
-		// overwritten when acquiring the lock.
-		DWORD dwLastError = 0;
-		if( WAIT_FAILED == dwWaitResult )
-			dwLastError = ::GetLastError();
-
-		// Acquire the synchronization lock the appropriate number of times.
-		// Win32 allows no error checking here.
-		for( int j=0; j<nThisThreadsLockCount; ++j)
-		{
-			//::EnterCriticalSection(&m_critsecSynchronized);
-			m_externalMutex->Acquire();
-		}
-
-		// Restore lock count.
-		m_nLockCount = nThisThreadsLockCount;
-
-		// Close event handle
-		if( ! CloseHandle(hWaitEvent) )
-			return WAIT_FAILED;
+		return WaitFor((DWORD)timeout * 1000);
+	}
 
-		if( WAIT_FAILED == dwWaitResult )
-			::SetLastError(dwLastError);
+	DWORD Wait()
+	{
+		return WaitFor(INFINITE);
+	}
 
-		return dwWaitResult;
+	// true if we were signalled, false if the timeout ran out first
+	bool WaitMS(uint32 milliseconds)
+	{
+		return (WaitFor(milliseconds) == WAIT_OBJECT_0);
 	}
 
-	DWORD Wait()
+	DWORD WaitFor(DWORD dwMillisecondsTimeout)
 	{
-		DWORD dwMillisecondsTimeout = INFINITE;
 		BOOL bAlertable = FALSE;
 		ASSERT(LockHeldByCallingThread());
 
@@ -191,6 +139,10 @@ public:
 		// Restore lock count.
 		m_nLockCount = nThisThreadsLockCount;
 
+		// A timed out waiter is still in the wait set, take it out so nobody signals a closed handle
+		if( WAIT_OBJECT_0 != dwWaitResult )
+			Remove(hWaitEvent);
+
 		// Close event handle
 		if( ! CloseHandle(hWaitEvent) )
 			return WAIT_FAILED;
@@ -199,7 +151,6 @@ public:
 			::SetLastError(dwLastError);
 
 		return dwWaitResult;
-
 	}
 
 	void Signal()
@@ -272,6 +223,15 @@ private:
 		return hWaitEvent;
 	}
 
+	void Remove(HANDLE hWaitEvent)
+	{
+		::EnterCriticalSection(&m_critsecWaitSetProtection);
+		std::deque<HANDLE>::iterator it = std::find(m_deqWaitSet.begin(), m_deqWaitSet.end(), hWaitEvent);
+		if( it != m_deqWaitSet.end() )
+			m_deqWaitSet.erase(it);
+		::LeaveCriticalSection(&m_critsecWaitSetProtection);
+	}
+
 	BOOL LockHeldByCallingThread()
 	{
 		//BOOL bTryLockResult = ::TryEnterCriticalSection(&m_critsecSynchronized);
@@ -310,6 +270,7 @@ private:
 };
 
 #else
+#include <sys/time.h>
 
 class Condition
 {
@@ -346,6 +307,21 @@ public:
 		else
 			return false;
 	}
+	// true if we were signalled, false if the timeout ran out first
+	inline bool WaitMS(uint32 milliseconds)
+	{
+		timeval now;
+		gettimeofday(&now, NULL);
+
+		uint64 nsec = uint64(now.tv_usec) * 1000 + uint64(milliseconds % 1000) * 1000000;
+		timespec tv;
+		tv.tv_sec = now.tv_sec + (milliseconds / 1000) + time_t(nsec / 1000000000);
+		tv.tv_nsec = long(nsec % 1000000000);
+		if(pthread_cond_timedwait(&cond, &mut->mutex, &tv) == 0)
+			return true;
+		else
+			return false;
+	}
 	inline void BeginSynchronized()
 	{
 		mut->Acquire();
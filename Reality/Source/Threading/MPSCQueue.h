@@ -0,0 +1,304 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOSIM_MPSCQUEUE_H
+#define MXOSIM_MPSCQUEUE_H
+
+#include "../Common.h"
+#include "NativeMutex.h"
+#include "Condition.h"
+
+#if PLATFORM == PLATFORM_UNIX && defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#define MPSC_USE_FUTEX
+#endif
+
+// Interlocked helpers, all of them act as full memory barriers
+#if PLATFORM == PLATFORM_WIN32
+inline uint32 AtomicCompareExchange(volatile uint32 *dest, uint32 exchange, uint32 comparand)
+{
+	return (uint32)InterlockedCompareExchange((volatile LONG*)dest, (LONG)exchange, (LONG)comparand);
+}
+inline uint32 AtomicExchange(volatile uint32 *dest, uint32 value)
+{
+	return (uint32)InterlockedExchange((volatile LONG*)dest, (LONG)value);
+}
+inline uint32 AtomicIncrement(volatile uint32 *dest)
+{
+	return (uint32)InterlockedIncrement((volatile LONG*)dest);
+}
+inline uint32 AtomicLoad(volatile uint32 *src)
+{
+	return (uint32)InterlockedCompareExchange((volatile LONG*)src, 0, 0);
+}
+inline void AtomicStore(volatile uint32 *dest, uint32 value)
+{
+	InterlockedExchange((volatile LONG*)dest, (LONG)value);
+}
+#else
+inline uint32 AtomicCompareExchange(volatile uint32 *dest, uint32 exchange, uint32 comparand)
+{
+	return __sync_val_compare_and_swap(dest, comparand, exchange);
+}
+inline uint32 AtomicExchange(volatile uint32 *dest, uint32 value)
+{
+	// test_and_set is only an acquire barrier
+	__sync_synchronize();
+	return __sync_lock_test_and_set(dest, value);
+}
+inline uint32 AtomicIncrement(volatile uint32 *dest)
+{
+	return __sync_add_and_fetch(dest, 1);
+}
+inline uint32 AtomicLoad(volatile uint32 *src)
+{
+	uint32 value = *src;
+	__sync_synchronize();
+	return value;
+}
+inline void AtomicStore(volatile uint32 *dest, uint32 value)
+{
+	__sync_synchronize();
+	*dest = value;
+	__sync_synchronize();
+}
+#endif
+
+// Auto-reset event the consumer sleeps on, futex on linux, a win32 event on windows
+class WakeupEvent
+{
+public:
+#if PLATFORM == PLATFORM_WIN32
+	WakeupEvent() { m_event = ::CreateEvent(NULL, FALSE, FALSE, NULL); }
+	~WakeupEvent() { ::CloseHandle(m_event); }
+
+	void Wait() { ::WaitForSingleObject(m_event, INFINITE); }
+	void Signal() { ::SetEvent(m_event); }
+private:
+	HANDLE m_event;
+#elif defined(MPSC_USE_FUTEX)
+	WakeupEvent() : m_state(0) {}
+	~WakeupEvent() {}
+
+	void Wait()
+	{
+		while (AtomicExchange(&m_state, 0) == 0)
+			syscall(SYS_futex, &m_state, FUTEX_WAIT_PRIVATE, 0, NULL, NULL, 0);
+	}
+	void Signal()
+	{
+		if (AtomicExchange(&m_state, 1) == 0)
+			syscall(SYS_futex, &m_state, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+	}
+private:
+	volatile uint32 m_state;
+#else
+	WakeupEvent() : m_cond(&m_lock), m_state(0) {}
+	~WakeupEvent() {}
+
+	void Wait()
+	{
+		m_cond.BeginSynchronized();
+		while (m_state == 0)
+			m_cond.Wait();
+		m_state = 0;
+		m_cond.EndSynchronized();
+	}
+	void Signal()
+	{
+		m_cond.BeginSynchronized();
+		m_state = 1;
+		m_cond.Signal();
+		m_cond.EndSynchronized();
+	}
+private:
+	NativeMutex m_lock;
+	Condition m_cond;
+	uint32 m_state;
+#endif
+};
+
+// Bounded multi-producer/single-consumer queue of pointers, for the places where lots of
+// threads hand work to one worker (database executors, query buffer thread).
+// Slots live in a ring allocated up front and are reused, so push and pop never allocate
+// and never take a lock. The consumer only touches the kernel when it has to sleep.
+// pop() returns NULL only after Wake(), which is how the owner shuts the consumer down.
+template<class T>
+class MPSCQueue
+{
+public:
+	explicit MPSCQueue(uint32 capacity=65536) : m_enqueuePos(0), m_dequeuePos(0), m_sleeping(0), m_interrupted(0), m_fullWaits(0)
+	{
+		m_capacity = 2;
+		while (m_capacity < capacity)
+			m_capacity <<= 1;
+		m_mask = m_capacity - 1;
+
+		m_cells = new cell[m_capacity];
+		for (uint32 i=0; i<m_capacity; i++)
+		{
+			m_cells[i].sequence = i;
+			m_cells[i].value = NULL;
+		}
+	}
+	~MPSCQueue()
+	{
+		delete[] m_cells;
+	}
+
+	// false if the ring is full
+	bool try_push(T item)
+	{
+		cell *theCell;
+		uint32 pos = AtomicLoad(&m_enqueuePos);
+		for (;;)
+		{
+			theCell = &m_cells[pos & m_mask];
+			int32 diff = int32(AtomicLoad(&theCell->sequence)) - int32(pos);
+			if (diff == 0)
+			{
+				// slot is free, try to claim it
+				uint32 prevPos = AtomicCompareExchange(&m_enqueuePos, pos+1, pos);
+				if (prevPos == pos)
+					break;
+
+				pos = prevPos;
+			}
+			else if (diff < 0)
+			{
+				// consumer hasn't freed this slot from the previous lap yet
+				return false;
+			}
+			else
+			{
+				pos = AtomicLoad(&m_enqueuePos);
+			}
+		}
+
+		theCell->value = item;
+		AtomicStore(&theCell->sequence, pos+1);
+
+		if (AtomicLoad(&m_sleeping) != 0)
+			m_wakeup.Signal();
+
+		return true;
+	}
+
+	// backs off until there's room, nothing gets dropped
+	void push(T item)
+	{
+		if (try_push(item))
+			return;
+
+		AtomicIncrement(&m_fullWaits);
+		while (!try_push(item))
+			Sleep(1);
+	}
+
+	// consumer thread only
+	T pop_nowait()
+	{
+		cell *theCell = &m_cells[m_dequeuePos & m_mask];
+		int32 diff = int32(AtomicLoad(&theCell->sequence)) - int32(m_dequeuePos+1);
+		if (diff < 0)
+			return NULL;
+
+		T item = theCell->value;
+		theCell->value = NULL;
+		AtomicStore(&theCell->sequence, m_dequeuePos + m_capacity);
+		AtomicStore(&m_dequeuePos, m_dequeuePos+1);
+		return item;
+	}
+
+	// consumer thread only, sleeps until something arrives or Wake() is called
+	T pop()
+	{
+		for (;;)
+		{
+			T item = pop_nowait();
+			if (item != NULL)
+				return item;
+
+			if (AtomicExchange(&m_interrupted, 0) != 0)
+				return NULL;
+
+			// announce that we're going to sleep, then look again so a push that
+			// didn't see the flag can't be missed
+			AtomicExchange(&m_sleeping, 1);
+			item = pop_nowait();
+			if (item == NULL && AtomicLoad(&m_interrupted) == 0)
+				m_wakeup.Wait();
+
+			AtomicExchange(&m_sleeping, 0);
+			if (item != NULL)
+				return item;
+		}
+	}
+
+	// makes a sleeping (or the next) pop() return NULL if the queue is empty
+	void Wake()
+	{
+		AtomicExchange(&m_interrupted, 1);
+		m_wakeup.Signal();
+	}
+
+	// approximate, producers may be halfway through a push
+	uint32 get_size()
+	{
+		return AtomicLoad(&m_enqueuePos) - AtomicLoad(&m_dequeuePos);
+	}
+	uint32 get_capacity() { return m_capacity; }
+	uint32 get_full_waits() { return AtomicLoad(&m_fullWaits); }
+
+private:
+	struct cell
+	{
+		volatile uint32 sequence;
+		T value;
+	};
+
+	// producers and the consumer hammer different counters, keep them off the same cache line
+	char m_pad0[64];
+	volatile uint32 m_enqueuePos;
+	char m_pad1[64];
+	volatile uint32 m_dequeuePos;
+	char m_pad2[64];
+
+	volatile uint32 m_sleeping;
+	volatile uint32 m_interrupted;
+	volatile uint32 m_fullWaits;
+	WakeupEvent m_wakeup;
+
+	cell *m_cells;
+	uint32 m_capacity;
+	uint32 m_mask;
+
+	// not copyable
+	MPSCQueue(const MPSCQueue&);
+	MPSCQueue& operator=(const MPSCQueue&);
+};
+
+#endif
@@ -0,0 +1,254 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#include "TickProfiler.h"
+#include "Config.h"
+#include "Log.h"
+
+#include <typeinfo>
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+
+createFileSingleton( TickProfiler );
+
+LatencyHistogram::LatencyHistogram()
+{
+	for (uint32 i=0;i<NUM_BUCKETS;i++)
+		m_counts[i] = 0;
+}
+
+void LatencyHistogram::Snapshot( vector<uint32> &counts ) const
+{
+	counts.resize(NUM_BUCKETS);
+	for (uint32 i=0;i<NUM_BUCKETS;i++)
+		counts[i] = m_counts[i];
+}
+
+uint32 LatencyHistogram::BucketFor( uint64 valueNS )
+{
+	if (valueNS < SUB_BUCKETS)
+		return uint32(valueNS);
+
+	//position of the highest set bit
+	uint32 magnitude = 0;
+	for (uint32 shift=32;shift>0;shift/=2)
+	{
+		if (valueNS >> (magnitude+shift))
+			magnitude += shift;
+	}
+	if (magnitude >= MAX_MAGNITUDE)
+		return NUM_BUCKETS-1;
+
+	uint32 subBucket = uint32(valueNS >> (magnitude-SUB_BUCKET_BITS)) - SUB_BUCKETS;
+	return (magnitude-SUB_BUCKET_BITS+1)*SUB_BUCKETS + subBucket;
+}
+
+uint64 LatencyHistogram::BucketLow( uint32 bucket )
+{
+	if (bucket < SUB_BUCKETS)
+		return bucket;
+
+	uint32 magnitude = bucket/SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+	uint32 subBucket = bucket%SUB_BUCKETS;
+	return uint64(SUB_BUCKETS+subBucket) << (magnitude-SUB_BUCKET_BITS);
+}
+
+TickProfiler::TickProfiler()
+{
+	m_enabled = false;
+	m_reportIntervalMS = 0;
+	m_lastReportMS = getMSTime();
+}
+
+void TickProfiler::Configure()
+{
+	m_enabled = sConfig.GetBoolDefault("GameServer.TickProfiler", true);
+	m_reportIntervalMS = uint32(sConfig.GetIntDefault("GameServer.TickProfileInterval", 0)) * 1000;
+	m_reportFile = sConfig.GetStringDefault("GameServer.TickProfileFile", "TickProfile.log");
+	m_lastReportMS = getMSTime();
+	m_fileBaseline = Baseline();
+}
+
+string TickProfiler::OpcodeName( uint32 opcode )
+{
+	if (opcode == OPCODE_STATE_UPDATE)
+		return "state update";
+	else if (opcode == OPCODE_UNHANDLED)
+		return "unhandled";
+	else if (opcode & 0x10000)
+		return (format("rpc %04x") % (opcode & 0xFFFF)).str();
+	else
+		return (format("rpc %02x") % opcode).str();
+}
+
+string TickProfiler::TypeName( const char *typeName )
+{
+#ifdef __GNUC__
+	int status = 0;
+	char *demangled = abi::__cxa_demangle(typeName, NULL, NULL, &status);
+	if (status == 0 && demangled != NULL)
+	{
+		string readable = demangled;
+		free(demangled);
+		return readable;
+	}
+#endif
+	//msvc names are already readable, "class ChatMsg"
+	string readable = typeName;
+	if (readable.compare(0,6,"class ") == 0)
+		readable.erase(0,6);
+	return readable;
+}
+
+string TickProfiler::ReportLine( const string &name, const LatencyHistogram &histogram, Baseline &since, double &totalMS )
+{
+	vector<uint32> counts;
+	histogram.Snapshot(counts);
+
+	vector<uint32> &previous = since.counts[&histogram];
+	previous.resize(counts.size(),0);
+	uint64 total = 0;
+	for (size_t i=0;i<counts.size();i++)
+	{
+		uint32 current = counts[i];
+		counts[i] -= previous[i];
+		previous[i] = current;
+		total += counts[i];
+	}
+	totalMS = 0;
+	if (total == 0)
+		return "";
+
+	const double percentiles[] = {0.5, 0.9, 0.99, 0.999};
+	const size_t numPercentiles = sizeof(percentiles)/sizeof(percentiles[0]);
+	double percentileUS[numPercentiles];
+	size_t nextPercentile = 0;
+
+	uint64 seen = 0;
+	double sumNS = 0;
+	double maxUS = 0;
+	for (uint32 i=0;i<counts.size();i++)
+	{
+		if (counts[i] == 0)
+			continue;
+
+		double middleNS = (LatencyHistogram::BucketLow(i) + LatencyHistogram::BucketHigh(i)) / 2.0;
+		seen += counts[i];
+		sumNS += middleNS * counts[i];
+		maxUS = (LatencyHistogram::BucketHigh(i)-1) / 1000.0;
+		while (nextPercentile < numPercentiles && seen >= uint64(percentiles[nextPercentile] * total + 0.5))
+			percentileUS[nextPercentile++] = middleNS / 1000.0;
+	}
+	while (nextPercentile < numPercentiles)
+		percentileUS[nextPercentile++] = maxUS;
+	totalMS = sumNS / 1000000.0;
+
+	return (format("%-24s %9u %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %11.2f\n")
+		% name % total % percentileUS[0] % percentileUS[1] % percentileUS[2] % percentileUS[3]
+		% maxUS % (sumNS / total / 1000.0) % totalMS).str();
+}
+
+//breakdown lines come out costliest first
+static bool compareByTotal( const std::pair<double,string> &a, const std::pair<double,string> &b )
+{
+	return a.first > b.first;
+}
+
+static void appendSorted( stringstream &out, vector< std::pair<double,string> > &lines )
+{
+	std::sort(lines.begin(),lines.end(),compareByTotal);
+	for (size_t i=0;i<lines.size();i++)
+		out << lines[i].second;
+}
+
+string TickProfiler::Report( Baseline &since ) const
+{
+	const char *phaseNames[NUM_PHASES] = {"tick","receive","decrypt","parse","dispatch","flush","serialize","encrypt","send"};
+
+	stringstream out;
+	out << format("Tick profile over %.1fs%s\n") % ((getMSTime() - since.sinceMS) / 1000.0f) % (m_enabled ? "" : " (disabled)");
+	out << format("%-24s %9s %9s %9s %9s %9s %9s %9s %11s\n")
+		% "(microseconds)" % "count" % "p50" % "p90" % "p99" % "p99.9" % "max" % "mean" % "total ms";
+	since.sinceMS = getMSTime();
+
+	double totalMS;
+	for (int i=0;i<NUM_PHASES;i++)
+		out << ReportLine(phaseNames[i], m_phases[i], since, totalMS);
+
+	vector< std::pair<double,string> > lines;
+	for (uint32 i=0;i<m_opcodes.Size();i++)
+	{
+		string line = ReportLine(OpcodeName(m_opcodes.KeyAt(i)), m_opcodes.At(i), since, totalMS);
+		if (line.length() > 0)
+			lines.push_back(std::make_pair(totalMS,line));
+	}
+	string line = ReportLine("other rpcs", m_opcodes.Overflow(), since, totalMS);
+	if (line.length() > 0)
+		lines.push_back(std::make_pair(totalMS,line));
+	if (lines.size() > 0)
+	{
+		out << "dispatch by command:\n";
+		appendSorted(out,lines);
+	}
+
+	lines.clear();
+	for (uint32 i=0;i<m_messageTypes.Size();i++)
+	{
+		line = ReportLine(TypeName(m_messageTypes.KeyAt(i)), m_messageTypes.At(i), since, totalMS);
+		if (line.length() > 0)
+			lines.push_back(std::make_pair(totalMS,line));
+	}
+	line = ReportLine("other messages", m_messageTypes.Overflow(), since, totalMS);
+	if (line.length() > 0)
+		lines.push_back(std::make_pair(totalMS,line));
+	if (lines.size() > 0)
+	{
+		out << "serialize by message type:\n";
+		appendSorted(out,lines);
+	}
+
+	return out.str();
+}
+
+void TickProfiler::Update()
+{
+	if (!m_enabled || m_reportIntervalMS == 0 || getMSTime() - m_lastReportMS < m_reportIntervalMS)
+		return;
+
+	m_lastReportMS = getMSTime();
+
+	ofstream reportFile(m_reportFile.c_str(), ios::out | ios::app);
+	if (!reportFile.is_open())
+	{
+		WARNING_LOG(format("TickProfiler: Couldn't open %1% for writing") % m_reportFile);
+		return;
+	}
+
+	char timeStamp[32];
+	time_t now = time(NULL);
+	strftime(timeStamp, sizeof(timeStamp), "%Y-%m-%d %H:%M:%S", localtime(&now));
+	reportFile << "[" << timeStamp << "] " << Report(m_fileBaseline) << std::endl;
+}
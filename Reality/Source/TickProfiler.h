@@ -0,0 +1,211 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_TICKPROFILER_H
+#define MXOEMU_TICKPROFILER_H
+
+#include "Common.h"
+#include "Singleton.h"
+#include "Timer.h"
+#include "Threading/MPSCQueue.h"
+
+// Latency histogram in the spirit of HdrHistogram: every power of two gets SUB_BUCKETS linear buckets,
+// so any recorded value is known to within 1/SUB_BUCKETS of itself from 1ns up to ~18 minutes.
+// Only ever recorded into from the game thread, so a sample is a plain increment with no lock;
+// other threads read the counts whenever they like and at worst see a sample or two less than there is.
+class LatencyHistogram
+{
+public:
+	enum
+	{
+		SUB_BUCKET_BITS = 4,
+		SUB_BUCKETS = 1 << SUB_BUCKET_BITS,
+		MAX_MAGNITUDE = 40,
+		NUM_BUCKETS = SUB_BUCKETS * (MAX_MAGNITUDE - SUB_BUCKET_BITS + 1)
+	};
+
+	LatencyHistogram();
+
+	void Record(uint64 valueNS) { m_counts[BucketFor(valueNS)]++; }
+	void Snapshot(vector<uint32> &counts) const;
+
+	static uint32 BucketFor(uint64 valueNS);
+	static uint64 BucketLow(uint32 bucket);
+	static uint64 BucketHigh(uint32 bucket) { return BucketLow(bucket+1); }
+private:
+	volatile uint32 m_counts[NUM_BUCKETS];
+};
+
+// Histograms created on demand for every key seen (opcodes, message types), up to MAX_SLOTS of them.
+// The game thread publishes a new slot only after it's filled in, so readers never see a half made one.
+template <class KEY, uint32 MAX_SLOTS>
+class KeyedHistograms
+{
+public:
+	KeyedHistograms() : m_used(0) {}
+	~KeyedHistograms()
+	{
+		for (uint32 i=0;i<m_used;i++)
+			delete m_slots[i];
+	}
+
+	// game thread only, everything past MAX_SLOTS keys shares the overflow histogram
+	LatencyHistogram& Get(KEY key)
+	{
+		uint32 used = m_used;
+		for (uint32 i=0;i<used;i++)
+		{
+			if (m_keys[i] == key)
+				return *m_slots[i];
+		}
+		if (used >= MAX_SLOTS)
+			return m_overflow;
+
+		m_keys[used] = key;
+		m_slots[used] = new LatencyHistogram();
+		AtomicStore(&m_used, used+1);
+		return *m_slots[used];
+	}
+
+	uint32 Size() const { return AtomicLoad(const_cast<volatile uint32*>(&m_used)); }
+	KEY KeyAt(uint32 slot) const { return m_keys[slot]; }
+	const LatencyHistogram& At(uint32 slot) const { return *m_slots[slot]; }
+	const LatencyHistogram& Overflow() const { return m_overflow; }
+private:
+	KEY m_keys[MAX_SLOTS];
+	LatencyHistogram *m_slots[MAX_SLOTS];
+	volatile uint32 m_used;
+	LatencyHistogram m_overflow;
+};
+
+// Wall clock time spent in each stage of the game server's hot path, plus which client commands
+// and which outgoing message types that time goes to. Stages nest: receive covers the whole handling
+// of one datagram including decrypt, parse and dispatch, and flush covers the serialize, encrypt and
+// send of every packet it puts out. Replies aren't sent from receive, they're queued and go out in
+// the world tick's FlushClients, so their cost shows up under flush.
+// Reports are percentiles since a caller-held baseline, so the console and the periodic file
+// (GameServer.TickProfileInterval) each see their own interval without resetting the other's.
+class TickProfiler : public Singleton<TickProfiler>
+{
+public:
+	enum Phase
+	{
+		PHASE_TICK,
+		PHASE_RECEIVE,
+		PHASE_DECRYPT,
+		PHASE_PARSE,
+		PHASE_DISPATCH,
+		PHASE_FLUSH,
+		PHASE_SERIALIZE,
+		PHASE_ENCRYPT,
+		PHASE_SEND,
+		NUM_PHASES
+	};
+
+	// keys for the command breakdown, real opcodes are the RPC byte or 0x10000 | the RPC short
+	enum
+	{
+		OPCODE_STATE_UPDATE = 0xFFFFFFFE,
+		OPCODE_UNHANDLED = 0xFFFFFFFF
+	};
+
+	struct Baseline
+	{
+		Baseline() { sinceMS = getMSTime(); }
+
+		uint32 sinceMS;
+		map<const LatencyHistogram*,vector<uint32> > counts;
+	};
+
+	TickProfiler();
+
+	void Configure();
+	bool IsEnabled() const { return m_enabled; }
+
+	void RecordPhase(Phase phase, uint64 elapsedNS) { m_phases[phase].Record(elapsedNS); }
+	void RecordOpcode(uint32 opcode, uint64 elapsedNS) { m_opcodes.Get(opcode).Record(elapsedNS); }
+	void RecordMessageType(const char *typeName, uint64 elapsedNS) { m_messageTypes.Get(typeName).Record(elapsedNS); }
+
+	// percentiles of everything recorded since the baseline, which then moves up to now, callable from any thread
+	string Report(Baseline &since) const;
+	// appends a report to GameServer.TickProfileFile once the interval elapses, game thread only
+	void Update();
+private:
+	static string OpcodeName(uint32 opcode);
+	static string TypeName(const char *typeName);
+	// empty if nothing was recorded since the baseline
+	static string ReportLine(const string &name, const LatencyHistogram &histogram, Baseline &since, double &totalMS);
+
+	bool m_enabled;
+
+	LatencyHistogram m_phases[NUM_PHASES];
+	KeyedHistograms<uint32,64> m_opcodes;
+	KeyedHistograms<const char*,64> m_messageTypes; //keyed by typeid name, those stay put for the life of the program
+
+	uint32 m_reportIntervalMS;
+	uint32 m_lastReportMS;
+	string m_reportFile;
+	Baseline m_fileBaseline;
+};
+
+#define sTickProfiler TickProfiler::getSingleton()
+
+// Times the scope it lives in (or up to Stop) into a phase, and into the command or message type
+// breakdown too once told which one it was. Costs a bool check when the profiler is off.
+class ProfileProbe
+{
+public:
+	explicit ProfileProbe(TickProfiler::Phase phase) : m_phase(phase), m_hasOpcode(false), m_typeName(NULL)
+	{
+		m_startNS = sTickProfiler.IsEnabled() ? getPreciseTimeNS() : 0;
+	}
+	~ProfileProbe() { Stop(); }
+
+	void SetOpcode(uint32 opcode) { m_opcode = opcode; m_hasOpcode = true; }
+	void SetMessageType(const char *typeName) { m_typeName = typeName; }
+
+	void Stop()
+	{
+		if (m_startNS == 0)
+			return;
+
+		uint64 elapsedNS = getPreciseTimeNS() - m_startNS;
+		m_startNS = 0;
+
+		sTickProfiler.RecordPhase(m_phase, elapsedNS);
+		if (m_hasOpcode)
+			sTickProfiler.RecordOpcode(m_opcode, elapsedNS);
+		if (m_typeName != NULL)
+			sTickProfiler.RecordMessageType(m_typeName, elapsedNS);
+	}
+private:
+	TickProfiler::Phase m_phase;
+	uint64 m_startNS;
+	bool m_hasOpcode;
+	uint32 m_opcode;
+	const char *m_typeName;
+};
+
+#endif
@@ -51,6 +51,30 @@ uint32 getMSTime()
 {
 	return (timeGetTime() - staticTimeInst.getTimeBase());
 }
+uint64 getThreadCPUTimeUS()
+{
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+	if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+		return 0;
+
+	//100ns units
+	uint64 kernel = (uint64(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+	uint64 user = (uint64(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+	return (kernel + user) / 10;
+}
+uint64 getPreciseTimeNS()
+{
+	static LARGE_INTEGER frequency = {0};
+	if (frequency.QuadPart == 0)
+		QueryPerformanceFrequency(&frequency);
+
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	//split so the multiplication can't overflow
+	uint64 ticks = uint64(counter.QuadPart);
+	uint64 freq = uint64(frequency.QuadPart);
+	return (ticks / freq) * 1000000000 + (ticks % freq) * 1000000000 / freq;
+}
 #else
 #include <sys/time.h>
 #include <unistd.h>
@@ -84,4 +108,20 @@ uint32 getMSTime()
 	gettimeofday(&theTime, NULL);
 	return ((theTime.tv_sec - staticTimeInst.getSeconds()) * 1000) + (theTime.tv_usec / 1000);
 }
+uint64 getThreadCPUTimeUS()
+{
+	timespec theTime;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &theTime) != 0)
+		return 0;
+
+	return uint64(theTime.tv_sec) * 1000000 + theTime.tv_nsec / 1000;
+}
+uint64 getPreciseTimeNS()
+{
+	timespec theTime;
+	if (clock_gettime(CLOCK_MONOTONIC, &theTime) != 0)
+		return 0;
+
+	return uint64(theTime.tv_sec) * 1000000000 + theTime.tv_nsec;
+}
 #endif
\ No newline at end of file
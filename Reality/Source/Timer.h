@@ -94,5 +94,9 @@ inline uint32 getTime()
 
 float getFloatTime();
 uint32 getMSTime();
+// cpu time the calling thread has used, in microseconds (windows only counts it in scheduler ticks)
+uint64 getThreadCPUTimeUS();
+// monotonic clock for timing short stretches of code, in nanoseconds from an arbitrary start
+uint64 getPreciseTimeNS();
 
 #endif
@@ -0,0 +1,216 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#include "WorldDataMgr.h"
+#include "Log.h"
+#include "Database/DatabaseEnv.h"
+#include <boost/algorithm/string.hpp>
+
+bool WorldDataMgr::LoadFromDB()
+{
+	m_doors.clear();
+	m_doorsById.clear();
+	m_hardlines.clear();
+	m_locations.clear();
+
+	// streamed, so only one row at a time is held on our side however big the tables get
+	bool loadedAll = true;
+	if (!sDatabase.StreamQuery("SELECT `DoorId`, `DistrictId`, `X`, `Y`, `Z`, `ROT`, `DoorType` FROM `doors` ORDER BY `id`",
+		boost::bind(&WorldDataMgr::LoadDoorRow,this,_1,_2)))
+		loadedAll = false;
+
+	if (!sDatabase.StreamQuery("SELECT `HardlineId`, `DistrictId`, `HardlineName`, `X`, `Y`, `Z`, `ROT` FROM `hardlines` ORDER BY `Id`",
+		boost::bind(&WorldDataMgr::LoadHardlineRow,this,_1,_2)))
+		loadedAll = false;
+
+	if (!sDatabase.StreamQuery("SELECT `District`, `Command`, `X`, `Y`, `Z` FROM `locations` ORDER BY `Id`",
+		boost::bind(&WorldDataMgr::LoadLocationRow,this,_1,_2)))
+		loadedAll = false;
+
+	INFO_LOG(format("Loaded %1% doors, %2% hardlines and %3% locations") 
+		% m_doors.size() % m_hardlines.size() % m_locations.size() );
+
+	return loadedAll;
+}
+
+bool WorldDataMgr::LoadDoorRow( Field *field, uint32 fieldCount )
+{
+	DoorData theDoor;
+	theDoor.doorId = field[0].GetUInt32();
+	theDoor.districtId = field[1].GetUInt8();
+	theDoor.pos.ChangeCoords(field[2].GetDouble(),field[3].GetDouble(),field[4].GetDouble());
+	theDoor.pos.rot = field[5].GetDouble();
+	theDoor.doorType = field[6].GetUInt8();
+
+	uint64 theKey = MakeKey(theDoor.districtId,theDoor.doorId);
+	if (m_doors.count(theKey) > 0)
+		return true;
+
+	m_doors[theKey] = theDoor;
+	if (m_doorsById.count(theDoor.doorId) == 0)
+		m_doorsById[theDoor.doorId] = theKey;
+
+	return true;
+}
+
+bool WorldDataMgr::LoadHardlineRow( Field *field, uint32 fieldCount )
+{
+	HardlineData theHardline;
+	theHardline.hardlineId = field[0].GetUInt16();
+	theHardline.districtId = field[1].GetUInt16();
+	if (field[2].GetString() != NULL)
+		theHardline.name = field[2].GetString();
+	theHardline.pos.ChangeCoords(field[3].GetDouble(),field[4].GetDouble(),field[5].GetDouble());
+	theHardline.pos.rot = field[6].GetDouble();
+
+	uint64 theKey = MakeKey(theHardline.districtId,theHardline.hardlineId);
+	if (m_hardlines.count(theKey) == 0)
+		m_hardlines[theKey] = theHardline;
+
+	return true;
+}
+
+bool WorldDataMgr::LoadLocationRow( Field *field, uint32 fieldCount )
+{
+	if (field[1].GetString() == NULL)
+		return true;
+
+	LocationData theLocation;
+	theLocation.district = field[0].GetUInt8();
+	theLocation.command = field[1].GetString();
+	theLocation.pos.ChangeCoords(field[2].GetDouble(),field[3].GetDouble(),field[4].GetDouble());
+
+	string theKey = LocationKey(theLocation.district,theLocation.command);
+	if (m_locations.count(theKey) == 0)
+		m_locations[theKey] = theLocation;
+
+	return true;
+}
+
+string WorldDataMgr::LocationKey( uint8 district, const string &command )
+{
+	//mysql compares these case insensitively, so do we
+	return (format("%1%:%2%") % int(district) % boost::algorithm::to_lower_copy(command)).str();
+}
+
+const WorldDataMgr::DoorData* WorldDataMgr::GetDoor( uint8 districtId, uint32 doorId ) const
+{
+	doorsMap::const_iterator it = m_doors.find(MakeKey(districtId,doorId));
+	if (it == m_doors.end())
+		return NULL;
+
+	return &it->second;
+}
+
+const WorldDataMgr::DoorData* WorldDataMgr::GetDoor( uint32 doorId ) const
+{
+	doorIdsMap::const_iterator it = m_doorsById.find(doorId);
+	if (it == m_doorsById.end())
+		return NULL;
+
+	doorsMap::const_iterator it2 = m_doors.find(it->second);
+	if (it2 == m_doors.end())
+		return NULL;
+
+	return &it2->second;
+}
+
+bool WorldDataMgr::AddDoor( uint8 districtId, uint32 doorId, const LocationVector &pos, const string &firstUser )
+{
+	uint64 theKey = MakeKey(districtId,doorId);
+	if (m_doors.count(theKey) > 0)
+		return false;
+
+	DoorData &theDoor = m_doors[theKey];
+	theDoor.doorId = doorId;
+	theDoor.districtId = districtId;
+	theDoor.pos = pos;
+	theDoor.doorType = 1;
+	if (m_doorsById.count(doorId) == 0)
+		m_doorsById[doorId] = theKey;
+
+	return sDatabase.Execute(format("INSERT INTO `doors` SET  `DistrictId` = '%1%', `DoorId` = '%2%', X = '%3%', Y = '%4%', Z = '%5%', ROT = '%6%', FirstUser = '%7%'")
+		% int(districtId)
+		% doorId
+		% pos.x % pos.y % pos.z % pos.rot
+		% sDatabase.EscapeString(firstUser) );
+}
+
+bool WorldDataMgr::SetDoorType( uint32 doorId, uint8 doorType )
+{
+	doorIdsMap::const_iterator it = m_doorsById.find(doorId);
+	if (it != m_doorsById.end())
+		m_doors[it->second].doorType = doorType;
+
+	return sDatabase.Execute(format("UPDATE `doors` SET `DoorType`='%1%' WHERE `DoorId`='%2%' LIMIT 1") % int(doorType) % doorId);
+}
+
+const WorldDataMgr::HardlineData* WorldDataMgr::GetHardline( uint16 districtId, uint16 hardlineId ) const
+{
+	hardlinesMap::const_iterator it = m_hardlines.find(MakeKey(districtId,hardlineId));
+	if (it == m_hardlines.end())
+		return NULL;
+
+	return &it->second;
+}
+
+bool WorldDataMgr::SetHardline( uint16 districtId, uint16 hardlineId, const string &name, const LocationVector &pos )
+{
+	HardlineData &theHardline = m_hardlines[MakeKey(districtId,hardlineId)];
+	theHardline.hardlineId = hardlineId;
+	theHardline.districtId = districtId;
+	theHardline.name = name;
+	theHardline.pos = pos;
+
+	//one statement, the tables are MyISAM so a separate DELETE and INSERT could leave the row missing
+	return sDatabase.Execute(MakeKey(districtId,hardlineId),format("REPLACE INTO `hardlines` SET `DistrictId` = '%1%', `HardlineId`='%2%',`X`='%3%',`Y`='%4%',`Z`= '%5%',`HardlineName`='%6%',`ROT`='%7%'")
+		% districtId
+		% hardlineId
+		% pos.x % pos.y % pos.z
+		% sDatabase.EscapeString(name)
+		% pos.rot );
+}
+
+const WorldDataMgr::LocationData* WorldDataMgr::GetLocation( uint8 district, const string &command ) const
+{
+	locationsMap::const_iterator it = m_locations.find(LocationKey(district,command));
+	if (it == m_locations.end())
+		return NULL;
+
+	return &it->second;
+}
+
+bool WorldDataMgr::SetLocation( uint8 district, const string &command, const LocationVector &pos )
+{
+	LocationData &theLocation = m_locations[LocationKey(district,command)];
+	theLocation.district = district;
+	theLocation.command = command;
+	theLocation.pos = pos;
+
+	return sDatabase.Execute(boost::hash<string>()(LocationKey(district,command)),format("REPLACE INTO `locations` SET `District` = '%1%', `Command` = '%2%', X = '%3%', Y = '%4%', Z = '%5%'")
+		% int(district)
+		% sDatabase.EscapeString(command)
+		% pos.x % pos.y % pos.z );
+}
@@ -0,0 +1,96 @@
+// ***************************************************************************
+//
+// Reality - The Matrix Online Server Emulator
+// Copyright (C) 2006-2010 Rajko Stojadinovic
+// http://mxoemu.info
+//
+// ---------------------------------------------------------------------------
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// ***************************************************************************
+
+#ifndef MXOEMU_WORLDDATAMGR_H
+#define MXOEMU_WORLDDATAMGR_H
+
+#include "Common.h"
+#include "LocationVector.h"
+
+// Static world data (doors, hardlines, teleport locations) kept in memory.
+// Everything is loaded once at startup, lookups never touch the database,
+// and additions are written to the cache first and then queued to the db.
+// Only used from the game server thread.
+class WorldDataMgr
+{
+public:
+	struct DoorData
+	{
+		uint32 doorId;
+		uint8 districtId;
+		LocationVector pos;
+		uint8 doorType;
+	};
+	struct HardlineData
+	{
+		uint16 hardlineId;
+		uint16 districtId;
+		string name;
+		LocationVector pos;
+	};
+	struct LocationData
+	{
+		uint8 district;
+		string command;
+		LocationVector pos;
+	};
+
+	WorldDataMgr() {}
+	~WorldDataMgr() {}
+
+	bool LoadFromDB();
+
+	const DoorData* GetDoor(uint8 districtId, uint32 doorId) const;
+	//first door with this id in any district
+	const DoorData* GetDoor(uint32 doorId) const;
+	bool AddDoor(uint8 districtId, uint32 doorId, const LocationVector &pos, const string &firstUser);
+	bool SetDoorType(uint32 doorId, uint8 doorType);
+
+	const HardlineData* GetHardline(uint16 districtId, uint16 hardlineId) const;
+	bool SetHardline(uint16 districtId, uint16 hardlineId, const string &name, const LocationVector &pos);
+
+	const LocationData* GetLocation(uint8 district, const string &command) const;
+	bool SetLocation(uint8 district, const string &command, const LocationVector &pos);
+private:
+	static uint64 MakeKey(uint32 districtId, uint32 id) { return (uint64(districtId) << 32) | id; }
+	static string LocationKey(uint8 district, const string &command);
+
+	bool LoadDoorRow(class Field *field, uint32 fieldCount);
+	bool LoadHardlineRow(class Field *field, uint32 fieldCount);
+	bool LoadLocationRow(class Field *field, uint32 fieldCount);
+
+	typedef unordered_map<uint64,DoorData> doorsMap;
+	doorsMap m_doors;
+	typedef unordered_map<uint32,uint64> doorIdsMap;
+	doorIdsMap m_doorsById;
+
+	typedef unordered_map<uint64,HardlineData> hardlinesMap;
+	hardlinesMap m_hardlines;
+
+	typedef unordered_map<string,LocationData> locationsMap;
+	locationsMap m_locations;
+};
+
+#endif